@@ -0,0 +1,129 @@
+/* Unicorn Emulator Engine */
+
+/* First-call latency with and without pre-translation.  The guest is an
+   X86-32 function of many small distinct blocks that runs straight through
+   once, so a cold uc_emu_start() spends nearly all its time translating.
+   The warm engine translates the function with uc_translate_range() at
+   load time, and its first call only executes.  Later calls on the same
+   engine reuse the translated code either way.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x1000000
+#define NBLOCKS     5000
+#define BLOCK_SIZE  7       // add eax, imm32; jmp $+2
+#define ROUNDS      10
+#define CALLS       3
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static size_t make_code(uint8_t *code)
+{
+    uint8_t *p = code;
+    int i;
+
+    for (i = 0; i < NBLOCKS; i++) {
+        *p++ = 0x05;    // add eax, i
+        memcpy(p, &i, 4);
+        p += 4;
+        *p++ = 0xeb;    // jmp $+2
+        *p++ = 0x00;
+    }
+
+    return p - code;
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+// seconds spent in each of the first CALLS uc_emu_start() of an engine, and
+// in uc_translate_range() before them
+static void first_calls(const uint8_t *code, size_t len, int warm, double *calls, double *prep)
+{
+    uc_engine *uc;
+    double t0, t1;
+    int i;
+
+    check(uc_open(UC_ARCH_X86, UC_MODE_32, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, (len + 0xfff) & ~0xfff, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, code, len), "uc_mem_write");
+
+    t0 = now();
+    if (warm) {
+        check(uc_translate_range(uc, ADDRESS, ADDRESS + len, ADDRESS + len),
+                "uc_translate_range");
+    }
+    t1 = now();
+    *prep = t1 - t0;
+
+    for (i = 0; i < CALLS; i++) {
+        t0 = now();
+        check(uc_emu_start(uc, ADDRESS, ADDRESS + len, 0, 0), "uc_emu_start");
+        t1 = now();
+        calls[i] = t1 - t0;
+    }
+
+    uc_close(uc);
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    static uint8_t code[NBLOCKS * BLOCK_SIZE];
+    size_t len = make_code(code);
+    double cold[CALLS], warm[CALLS], c[CALLS], w[CALLS], prep = 0, p;
+    int i, j;
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    // best of ROUNDS fresh engines each
+    for (i = 0; i < ROUNDS; i++) {
+        first_calls(code, len, 0, c, &p);
+        first_calls(code, len, 1, w, &p);
+
+        for (j = 0; j < CALLS; j++) {
+            if (i == 0 || c[j] < cold[j])
+                cold[j] = c[j];
+            if (i == 0 || w[j] < warm[j]) {
+                warm[j] = w[j];
+                if (j == 0)
+                    prep = p;
+            }
+        }
+    }
+
+    for (j = 0; j < CALLS; j++) {
+        printf("call %d: cold %10.3f ms, warm %10.3f ms\n",
+                j + 1, cold[j] * 1e3, warm[j] * 1e3);
+    }
+    printf("uc_translate_range() %10.3f ms\n", prep * 1e3);
+    printf("first-call speedup %.2fx\n", cold[0] / warm[0]);
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/* Unicorn Emulator Engine */
+
+/* Cost of parking a guest at an I/O point and continuing it.  An X86-32
+   loop traps with "int 0x80" on every iteration, and its hook gives control
+   back to the host each time: once with uc_emu_pause()/uc_emu_resume(),
+   which keep the translated code, and once with uc_emu_stop() followed by
+   uc_emu_start() from the current EIP, which translates the loop again.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       200000
+
+// L: int 0x80; inc eax; dec ecx; jnz L
+#define X86_CODE32 "\xcd\x80\x40\x49\x75\xfa"
+#define CODE_END   (ADDRESS + sizeof(X86_CODE32) - 1)
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+static void hook_pause(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    check(uc_emu_pause(uc), "uc_emu_pause");
+    *(int *)user_data = 1;
+}
+
+static void hook_stop(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    check(uc_emu_stop(uc), "uc_emu_stop");
+    *(int *)user_data = 1;
+}
+
+static uc_engine *setup(uc_cb_hookintr_t hook, int *parked, uint32_t iters)
+{
+    uc_engine *uc;
+    uc_hook hh;
+
+    check(uc_open(UC_ARCH_X86, UC_MODE_32, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, X86_CODE32, sizeof(X86_CODE32) - 1), "uc_mem_write");
+    check(uc_reg_write(uc, UC_X86_REG_ECX, &iters), "uc_reg_write");
+    check(uc_hook_add(uc, &hh, UC_HOOK_INTR, hook, parked, 1, 0), "uc_hook_add");
+
+    return uc;
+}
+
+// seconds for @iters round trips through the host
+static double run_pause(uint32_t iters)
+{
+    int parked = 0;
+    uc_engine *uc = setup(hook_pause, &parked, iters);
+    double t0, t1;
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, CODE_END, 0, 0), "uc_emu_start");
+    while (parked) {
+        parked = 0;
+        check(uc_emu_resume(uc), "uc_emu_resume");
+    }
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+static double run_restart(uint32_t iters)
+{
+    int parked = 0;
+    uc_engine *uc = setup(hook_stop, &parked, iters);
+    uint32_t eip;
+    double t0, t1;
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, CODE_END, 0, 0), "uc_emu_start");
+    while (parked) {
+        parked = 0;
+        check(uc_reg_read(uc, UC_X86_REG_EIP, &eip), "uc_reg_read");
+        check(uc_emu_start(uc, eip, CODE_END, 0, 0), "uc_emu_start");
+    }
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint32_t iters = ITERS;
+    double pause, restart;
+
+    if (argc > 1) {
+        iters = strtoul(argv[1], NULL, 0);
+    }
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    pause = run_pause(iters);
+    restart = run_restart(iters);
+
+    printf("%-14s %10.1f ns/round trip\n", "pause/resume", pause * 1e9 / iters);
+    printf("%-14s %10.1f ns/round trip\n", "stop/start", restart * 1e9 / iters);
+    printf("speedup %.2fx\n", restart / pause);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/* Unicorn Emulator Engine */
+
+/* Cost of naming translated code for Linux perf.  An X86-32 guest of many
+   blocks that run once is translation-bound, so it shows what writing
+   /tmp/perf-<pid>.map or a jitdump record adds to every translation.  A
+   small loop shows that code already translated runs at the same speed.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       20000000
+#define NBLOCKS     20000   // straight-line guest
+#define BLOCK_SIZE  7       // add eax, imm32; jmp $+2
+
+// L: add eax, ecx; xor eax, 0x55; dec ecx; jnz L
+#define X86_LOOP "\x01\xc8\x83\xf0\x55\x49\x75\xf8"
+
+static const struct {
+    const char *name;
+    uint32_t flags;
+} modes[] = {
+    { "off", 0 },
+    { "perf map", UC_OPT_PERF_MAP },
+    { "jitdump", UC_OPT_JITDUMP },
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+// seconds to run @code from a fresh engine
+static double run(uint32_t flags, const void *code, size_t size, uint32_t counter)
+{
+    uc_open_opts opts = { 0, 0, flags, NULL, 0 };
+    uc_engine *uc;
+    double t0, t1;
+
+    check(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc), "uc_open_with");
+    check(uc_mem_map(uc, ADDRESS, (size + 0xfff) & ~0xfff, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, code, size), "uc_mem_write");
+    check(uc_reg_write(uc, UC_X86_REG_ECX, &counter), "uc_reg_write");
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, ADDRESS + size, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    static uint8_t code[NBLOCKS * BLOCK_SIZE];
+    uint32_t iters = ITERS;
+    char path[64];
+    uint8_t *p = code;
+    size_t i;
+    int n;
+
+    if (argc > 1) {
+        iters = strtoul(argv[1], NULL, 0);
+    }
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    for (n = 0; n < NBLOCKS; n++) {
+        *p++ = 0x05;    // add eax, n
+        memcpy(p, &n, 4);
+        p += 4;
+        *p++ = 0xeb;    // jmp $+2
+        *p++ = 0x00;
+    }
+
+    printf("%-10s %16s %14s\n", "mode", "ns/translation", "loop Mips");
+
+    for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        double cold = run(modes[i].flags, code, sizeof(code), 0);
+        double hot = run(modes[i].flags, X86_LOOP, sizeof(X86_LOOP) - 1, iters);
+
+        printf("%-10s %16.1f %14.1f\n", modes[i].name,
+                cold * 1e9 / NBLOCKS, iters * 4.0 / hot / 1e6);
+    }
+
+    // only the timings were wanted
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+    remove(path);
+    snprintf(path, sizeof(path), "/tmp/jit-%d.dump", (int)getpid());
+    remove(path);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* Unicorn Emulator Engine */
+
+/* Cost of finding hot guest code.  An X86-32 loop runs plain, under the
+   sampling profiler at two rates, with exact per-block counters compiled
+   into the translated code, and with a UC_HOOK_BLOCK callback counting
+   executions per block address, the usual way to profile from a hook.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       50000000
+
+// L: add eax, ecx; jmp M; M: xor eax, 0x55; dec ecx; jnz L
+#define X86_CODE32 "\x01\xc8\xeb\x00\x83\xf0\x55\x49\x75\xf6"
+
+enum { PLAIN, SAMPLE_1MS, SAMPLE_100US, TB_COUNTS, HOOK_BLOCK };
+
+static const char *const names[] = {
+    "plain", "sample 1ms", "sample 100us", "tb counts", "block hook",
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+static void hook_block(uc_engine *uc, uint64_t address, uint32_t size, void *user_data)
+{
+    uint64_t *counts = user_data;
+
+    counts[(address - ADDRESS) & 0xf]++;
+}
+
+// seconds to run the loop for @iters iterations, and the samples or
+// block executions recorded
+static double run(int mode, uint32_t iters, uint64_t *samples)
+{
+    uint64_t counts[16] = { 0 };
+    uc_open_opts opts = { 0, 0, mode == TB_COUNTS ? UC_OPT_TB_COUNTS : 0, NULL, 0 };
+    uc_profile_entry *entries;
+    uc_tb_count *tbs;
+    uc_engine *uc;
+    uc_hook hh;
+    size_t i, n;
+    double t0, t1;
+
+    check(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc), "uc_open_with");
+    check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, X86_CODE32, sizeof(X86_CODE32) - 1), "uc_mem_write");
+    check(uc_reg_write(uc, UC_X86_REG_ECX, &iters), "uc_reg_write");
+    if (mode == SAMPLE_1MS)
+        check(uc_profile_start(uc, 1000), "uc_profile_start");
+    if (mode == SAMPLE_100US)
+        check(uc_profile_start(uc, 100), "uc_profile_start");
+    if (mode == HOOK_BLOCK)
+        check(uc_hook_add(uc, &hh, UC_HOOK_BLOCK, hook_block, counts, 1, 0), "uc_hook_add");
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, ADDRESS + sizeof(X86_CODE32) - 1, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    *samples = 0;
+    if (mode == SAMPLE_1MS || mode == SAMPLE_100US) {
+        check(uc_profile_read(uc, &entries, &n), "uc_profile_read");
+        for (i = 0; i < n; i++)
+            *samples += entries[i].samples + entries[i].helper_samples;
+        uc_free(entries);
+    }
+    if (mode == TB_COUNTS) {
+        check(uc_tb_counts_read(uc, &tbs, &n), "uc_tb_counts_read");
+        for (i = 0; i < n; i++)
+            *samples += tbs[i].count;
+        uc_free(tbs);
+    }
+    if (mode == HOOK_BLOCK) {
+        for (i = 0; i < 16; i++)
+            *samples += counts[i];
+    }
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint32_t iters = ITERS;
+    double plain = 0;
+    int mode;
+
+    if (argc > 1) {
+        iters = strtoul(argv[1], NULL, 0);
+    }
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    printf("%-14s %10s %10s %14s\n", "mode", "Mips", "slowdown", "samples");
+
+    for (mode = PLAIN; mode <= HOOK_BLOCK; mode++) {
+        uint64_t samples;
+        double t = run(mode, iters, &samples);
+
+        if (mode == PLAIN)
+            plain = t;
+        printf("%-14s %10.1f %9.2fx %14" PRIu64 "\n", names[mode],
+                iters * 5.0 / t / 1e6, t / plain, samples);
+    }
+
+    return 0;
+}
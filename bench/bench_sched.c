@@ -0,0 +1,155 @@
+/* Unicorn Emulator Engine */
+
+/* Guest thread context switches.  Several X86-32 threads run the same
+   counted loop with their own registers, switched every QUANTUM
+   instructions: once by uc_sched_start(), which switches inside the engine
+   and keeps the translated code, and once the way a host-side scheduler
+   does it, with uc_context_restore()/uc_context_save() around a
+   uc_emu_start() limited to QUANTUM instructions.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       200000  // loop iterations per thread
+#define NTHREADS    4
+#define QUANTUM     300     // instructions per time slice
+
+// L: inc eax; dec ecx; jnz L
+#define X86_CODE32 "\x40\x49\x75\xfc"
+#define CODE_END   (ADDRESS + sizeof(X86_CODE32) - 1)
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+// an engine with the loop mapped, and the initial context of each thread
+static uc_engine *setup(uc_context **threads, uint32_t iters)
+{
+    uint32_t eax = 0, eip = ADDRESS;
+    uc_engine *uc;
+    int i;
+
+    check(uc_open(UC_ARCH_X86, UC_MODE_32, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, X86_CODE32, sizeof(X86_CODE32) - 1), "uc_mem_write");
+
+    for (i = 0; i < NTHREADS; i++) {
+        check(uc_reg_write(uc, UC_X86_REG_EAX, &eax), "uc_reg_write");
+        check(uc_reg_write(uc, UC_X86_REG_ECX, &iters), "uc_reg_write");
+        check(uc_reg_write(uc, UC_X86_REG_EIP, &eip), "uc_reg_write");
+        check(uc_context_alloc(uc, &threads[i]), "uc_context_alloc");
+        check(uc_context_save(uc, threads[i]), "uc_context_save");
+    }
+
+    return uc;
+}
+
+// seconds to run all threads under uc_sched_start()
+static double run_engine(uint32_t iters)
+{
+    uc_context *threads[NTHREADS];
+    uc_engine *uc = setup(threads, iters);
+    uint32_t id;
+    double t0, t1;
+    int i;
+
+    for (i = 0; i < NTHREADS; i++) {
+        check(uc_thread_add(uc, threads[i], &id), "uc_thread_add");
+        uc_free(threads[i]);
+    }
+
+    t0 = now();
+    check(uc_sched_start(uc, CODE_END, QUANTUM, 0), "uc_sched_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+// seconds to run all threads from a round robin loop on the host
+static double run_host(uint32_t iters)
+{
+    uc_context *threads[NTHREADS];
+    uc_engine *uc = setup(threads, iters);
+    int live = NTHREADS, i;
+    uint32_t eip;
+    double t0, t1;
+
+    t0 = now();
+    while (live) {
+        for (i = 0; i < NTHREADS; i++) {
+            if (!threads[i])
+                continue;
+            check(uc_context_restore(uc, threads[i]), "uc_context_restore");
+            check(uc_reg_read(uc, UC_X86_REG_EIP, &eip), "uc_reg_read");
+            check(uc_emu_start(uc, eip, CODE_END, 0, QUANTUM), "uc_emu_start");
+            check(uc_reg_read(uc, UC_X86_REG_EIP, &eip), "uc_reg_read");
+            if (eip == CODE_END) {
+                uc_free(threads[i]);
+                threads[i] = NULL;
+                live--;
+            } else {
+                check(uc_context_save(uc, threads[i]), "uc_context_save");
+            }
+        }
+    }
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint32_t iters = ITERS;
+    double engine, host, switches;
+
+    if (argc > 1) {
+        iters = strtoul(argv[1], NULL, 0);
+    }
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    // 3 instructions per iteration
+    switches = (double)NTHREADS * iters * 3 / QUANTUM;
+
+    engine = run_engine(iters);
+    host = run_host(iters);
+
+    printf("%d threads, %d instructions per time slice\n", NTHREADS, QUANTUM);
+    printf("%-14s %10.2f M switches/s\n", "uc_sched_start", switches / engine / 1e6);
+    printf("%-14s %10.2f M switches/s\n", "host loop", switches / host / 1e6);
+    printf("speedup %.2fx\n", host / engine);
+
+    return 0;
+}
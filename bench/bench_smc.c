@@ -0,0 +1,106 @@
+/* Unicorn Emulator Engine */
+
+/* Self-modifying code and writes near code, on X86-32.  A counted loop
+   stores into a data slot either on its own code page or on a page of its
+   own; with byte-granular code tracking both should cost about the same.
+   A JIT-style guest patches the immediate of another block on the same page
+   every iteration, which must retranslate only that block.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       2000000
+
+struct guest {
+    const char *name;
+    const char *code;
+    size_t size;
+};
+
+// L: mov [0x10800], ecx; add eax, [0x10800]; dec ecx; jnz L
+#define DATA_SAME_PAGE "\x89\x0d\x00\x08\x01\x00\x03\x05\x00\x08\x01\x00\x49\x75\xf1"
+// L: mov [0x11000], ecx; add eax, [0x11000]; dec ecx; jnz L
+#define DATA_OWN_PAGE "\x89\x0d\x00\x10\x01\x00\x03\x05\x00\x10\x01\x00\x49\x75\xf1"
+// L: mov [P + 1], ecx; jmp P; nop x 8; P: mov eax, 0; add ebx, eax; dec ecx; jnz L
+#define JIT_PATCH "\x89\x0d\x11\x00\x01\x00\xeb\x08\x90\x90\x90\x90\x90\x90\x90\x90" \
+    "\xb8\x00\x00\x00\x00\x01\xc3\x49\x75\xe6"
+
+static const struct guest guests[] = {
+    { "data, own page", DATA_OWN_PAGE, sizeof(DATA_OWN_PAGE) - 1 },
+    { "data, code page", DATA_SAME_PAGE, sizeof(DATA_SAME_PAGE) - 1 },
+    { "jit patching", JIT_PATCH, sizeof(JIT_PATCH) - 1 },
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+// seconds to run @g for @iters loop iterations
+static double run(const struct guest *g, uint32_t iters)
+{
+    uc_engine *uc;
+    double t0, t1;
+
+    check(uc_open(UC_ARCH_X86, UC_MODE_32, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, 0x2000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, g->code, g->size), "uc_mem_write");
+    check(uc_reg_write(uc, UC_X86_REG_ECX, &iters), "uc_reg_write");
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, ADDRESS + g->size, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint32_t iters = ITERS;
+    size_t i;
+
+    if (argc > 1) {
+        iters = strtoul(argv[1], NULL, 0);
+    }
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    printf("%-16s %14s\n", "guest", "ns/iteration");
+
+    for (i = 0; i < sizeof(guests) / sizeof(guests[0]); i++) {
+        double t = run(&guests[i], iters);
+
+        printf("%-16s %14.1f\n", guests[i].name, t * 1e9 / iters);
+    }
+
+    return 0;
+}
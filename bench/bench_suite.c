@@ -0,0 +1,367 @@
+/* Unicorn Emulator Engine */
+
+/* Throughput of every supported guest on a fixed set of workloads, printed
+   as JSON so runs can be compared mechanically.  Each guest runs the same
+   counted loops: plain ALU work, a word-at-a-time copy between two pages,
+   an indirect call and return per iteration, a system call per iteration
+   with a no-op hook, and the ALU loop again under a UC_HOOK_CODE callback.
+   uc_open()/uc_close() churn is timed separately.  Every figure is the
+   best of several runs on a fresh engine.
+
+   usage: bench_suite [scale [repeat]]
+   scale multiplies the iteration counts (0.1 for a quick run).  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x1000      // below 64KB so the 16-bit guest can reach it
+#define DATA        0x4000      // copy source, copy destination, stack
+#define DATA_SIZE   0x3000
+#define REPEAT      3
+
+enum { ALU, COPY, INDIRECT, SYSCALL, HOOK, OPEN_CLOSE, NWORKLOADS };
+
+static const struct {
+    const char *name;
+    uint64_t ops;       // iterations at scale 1
+} workloads[] = {
+    { "alu", 20000000 },
+    { "copy", 10000000 },
+    { "indirect", 2000000 },
+    { "syscall", 1000000 },
+    { "hook", 1000000 },
+    { "open_close", 200 },
+};
+
+struct code {
+    const char *bytes;
+    size_t size;
+    size_t fn;          // offset of the function INDIRECT calls
+    unsigned insns;     // guest instructions per iteration
+};
+
+#define CODE(s, fn, insns) { s, sizeof(s) - 1, fn, insns }
+
+struct guest {
+    const char *name;
+    uc_arch arch;
+    uc_mode mode;
+    int counter_reg;    // iterations left
+    int ptr_reg;        // COPY: source page, INDIRECT: function
+    int sp_reg;         // stack for call/return, or 0
+    int insn;           // UC_HOOK_INSN system call, or 0 for UC_HOOK_INTR
+    struct code code[SYSCALL + 1];  // NULL bytes: workload not supported
+};
+
+static const struct guest guests[] = {
+    { "x86-16", UC_ARCH_X86, UC_MODE_16, UC_X86_REG_ECX, UC_X86_REG_SI, UC_X86_REG_SP, 0, {
+        // L: add eax, ecx; xor eax, 0x55; dec ecx; jnz L
+        CODE("\x66\x01\xc8\x66\x83\xf0\x55\x66\x49\x75\xf5", 0, 4),
+        // L: mov eax, [bx+si]; mov [bx+si+0x1000], eax; add bx, 4; and bx, 0xffc;
+        //    dec ecx; jnz L
+        CODE("\x66\x8b\x00\x66\x89\x80\x00\x10\x83\xc3\x04\x81\xe3\xfc\x0f\x66\x49\x75\xed", 0, 6),
+        // L: call si; dec ecx; jnz L; F: add eax, ecx; ret
+        CODE("\xff\xd6\x66\x49\x75\xfa\x66\x01\xc8\xc3", 6, 5),
+        // L: int 0x80; dec ecx; jnz L
+        CODE("\xcd\x80\x66\x49\x75\xfa", 0, 3),
+    } },
+    { "x86-32", UC_ARCH_X86, UC_MODE_32, UC_X86_REG_ECX, UC_X86_REG_ESI, UC_X86_REG_ESP, 0, {
+        // L: add eax, ecx; xor eax, 0x55; dec ecx; jnz L
+        CODE("\x01\xc8\x83\xf0\x55\x49\x75\xf8", 0, 4),
+        // L: mov eax, [esi+ebx]; mov [esi+ebx+0x1000], eax; add ebx, 4;
+        //    and ebx, 0xffc; dec ecx; jnz L
+        CODE("\x8b\x04\x1e\x89\x84\x1e\x00\x10\x00\x00\x83\xc3\x04\x81\xe3\xfc\x0f\x00\x00\x49\x75\xea", 0, 6),
+        // L: call esi; dec ecx; jnz L; F: add eax, ecx; ret
+        CODE("\xff\xd6\x49\x75\xfb\x01\xc8\xc3", 5, 5),
+        // L: int 0x80; dec ecx; jnz L
+        CODE("\xcd\x80\x49\x75\xfb", 0, 3),
+    } },
+    { "x86-64", UC_ARCH_X86, UC_MODE_64, UC_X86_REG_RBX, UC_X86_REG_RSI, UC_X86_REG_RSP, UC_X86_INS_SYSCALL, {
+        // L: add rax, rbx; xor rax, 0x55; dec rbx; jnz L
+        CODE("\x48\x01\xd8\x48\x83\xf0\x55\x48\xff\xcb\x75\xf4", 0, 4),
+        // L: mov rcx, [rsi+rdx]; mov [rsi+rdx+0x1000], rcx; add rdx, 8;
+        //    and rdx, 0xff8; dec rbx; jnz L
+        CODE("\x48\x8b\x0c\x16\x48\x89\x8c\x16\x00\x10\x00\x00\x48\x83\xc2\x08\x48\x81\xe2\xf8\x0f\x00\x00\x48\xff\xcb\x75\xe4", 0, 6),
+        // L: call rsi; dec rbx; jnz L; F: add rax, rbx; ret
+        CODE("\xff\xd6\x48\xff\xcb\x75\xf9\x48\x01\xd8\xc3", 7, 5),
+        // L: syscall; dec rbx; jnz L
+        CODE("\x0f\x05\x48\xff\xcb\x75\xf9", 0, 3),
+    } },
+    { "arm", UC_ARCH_ARM, UC_MODE_ARM, UC_ARM_REG_R0, UC_ARM_REG_R2, 0, 0, {
+        // L: add r1, r1, r0; eor r1, r1, #0x55; subs r0, r0, #1; bne L
+        CODE("\x00\x10\x81\xe0\x55\x10\x21\xe2\x01\x00\x50\xe2\xfb\xff\xff\x1a", 0, 4),
+        // add r5, r2, #0x1000
+        // L: ldr r12, [r2, r3]; str r12, [r5, r3]; add r3, r3, #4;
+        //    bic r3, r3, #0x1000; subs r0, r0, #1; bne L
+        CODE("\x01\x5a\x82\xe2\x03\xc0\x92\xe7\x03\xc0\x85\xe7\x04\x30\x83\xe2\x01\x3a\xc3\xe3\x01\x00\x50\xe2\xf9\xff\xff\x1a", 0, 6),
+        // L: blx r2; subs r0, r0, #1; bne L; F: add r1, r1, r0; bx lr
+        CODE("\x32\xff\x2f\xe1\x01\x00\x50\xe2\xfc\xff\xff\x1a\x00\x10\x81\xe0\x1e\xff\x2f\xe1", 12, 5),
+        // L: svc #0; subs r0, r0, #1; bne L
+        CODE("\x00\x00\x00\xef\x01\x00\x50\xe2\xfc\xff\xff\x1a", 0, 3),
+    } },
+    { "thumb", UC_ARCH_ARM, UC_MODE_THUMB, UC_ARM_REG_R0, UC_ARM_REG_R2, 0, 0, {
+        // L: add r1, r0; eor r1, r1, #0x55; subs r0, #1; bne L
+        CODE("\x01\x44\x81\xf0\x55\x01\x40\x1e\xfa\xd1", 0, 4),
+        // add.w r5, r2, #0x1000
+        // L: ldr.w r12, [r2, r3]; str.w r12, [r5, r3]; adds r3, #4;
+        //    bic r3, r3, #0x1000; subs r0, #1; bne L
+        CODE("\x02\xf5\x80\x55\x52\xf8\x03\xc0\x45\xf8\x03\xc0\x1b\x1d\x23\xf4\x80\x53\x40\x1e\xf6\xd1", 0, 6),
+        // L: blx r2; subs r0, #1; bne L; F: add r1, r0; bx lr
+        CODE("\x90\x47\x40\x1e\xfc\xd1\x01\x44\x70\x47", 6, 5),
+        // L: svc #0; subs r0, #1; bne L
+        CODE("\x00\xdf\x40\x1e\xfc\xd1", 0, 3),
+    } },
+    { "arm64", UC_ARCH_ARM64, UC_MODE_ARM, UC_ARM64_REG_X0, UC_ARM64_REG_X2, 0, 0, {
+        // L: add x1, x1, x0; eor x1, x1, #0xf0; subs x0, x0, #1; b.ne L
+        CODE("\x21\x00\x00\x8b\x21\x0c\x7c\xd2\x00\x04\x00\xf1\xa1\xff\xff\x54", 0, 4),
+        // add x5, x2, #0x1000
+        // L: ldr x4, [x2, x3]; str x4, [x5, x3]; add x3, x3, #8;
+        //    and x3, x3, #0xff8; subs x0, x0, #1; b.ne L
+        CODE("\x45\x04\x40\x91\x44\x68\x63\xf8\xa4\x68\x23\xf8\x63\x20\x00\x91\x63\x20\x7d\x92\x00\x04\x00\xf1\x61\xff\xff\x54", 0, 6),
+        // L: blr x2; subs x0, x0, #1; b.ne L; F: add x1, x1, x0; ret
+        CODE("\x40\x00\x3f\xd6\x00\x04\x00\xf1\xc1\xff\xff\x54\x21\x00\x00\x8b\xc0\x03\x5f\xd6", 12, 5),
+        // L: svc #0; subs x0, x0, #1; b.ne L
+        CODE("\x01\x00\x00\xd4\x00\x04\x00\xf1\xc1\xff\xff\x54", 0, 3),
+    } },
+    { "mips32el", UC_ARCH_MIPS, UC_MODE_MIPS32 + UC_MODE_LITTLE_ENDIAN, UC_MIPS_REG_A0, UC_MIPS_REG_A1, 0, 0, {
+        // L: addu $v0, $v0, $a0; xori $v0, $v0, 0x55; addiu $a0, $a0, -1;
+        //    bnez $a0, L; nop
+        CODE("\x21\x10\x44\x00\x55\x00\x42\x38\xff\xff\x84\x24\xfc\xff\x80\x14\x00\x00\x00\x00", 0, 5),
+        // L: addu $t0, $a1, $a2; lw $t1, 0($t0); sw $t1, 0x1000($t0);
+        //    addiu $a2, $a2, 4; andi $a2, $a2, 0xffc; addiu $a0, $a0, -1;
+        //    bnez $a0, L; nop
+        CODE("\x21\x40\xa6\x00\x00\x00\x09\x8d\x00\x10\x09\xad\x04\x00\xc6\x24\xfc\x0f\xc6\x30\xff\xff\x84\x24\xf9\xff\x80\x14\x00\x00\x00\x00", 0, 8),
+        // L: jalr $a1; nop; addiu $a0, $a0, -1; bnez $a0, L; nop
+        // F: jr $ra; addu $v0, $v0, $a0
+        CODE("\x09\xf8\xa0\x00\x00\x00\x00\x00\xff\xff\x84\x24\xfc\xff\x80\x14\x00\x00\x00\x00\x08\x00\xe0\x03\x21\x10\x44\x00", 20, 7),
+        // L: syscall; addiu $a0, $a0, -1; bnez $a0, L; nop
+        CODE("\x0c\x00\x00\x00\xff\xff\x84\x24\xfd\xff\x80\x14\x00\x00\x00\x00", 0, 4),
+    } },
+    { "mips64", UC_ARCH_MIPS, UC_MODE_MIPS64 + UC_MODE_BIG_ENDIAN, UC_MIPS_REG_A0, UC_MIPS_REG_A1, 0, 0, {
+        // L: daddu $v0, $v0, $a0; xori $v0, $v0, 0x55; daddiu $a0, $a0, -1;
+        //    bnez $a0, L; nop
+        CODE("\x00\x44\x10\x2d\x38\x42\x00\x55\x64\x84\xff\xff\x14\x80\xff\xfc\x00\x00\x00\x00", 0, 5),
+        // L: daddu $t0, $a1, $a2; ld $t1, 0($t0); sd $t1, 0x1000($t0);
+        //    daddiu $a2, $a2, 8; andi $a2, $a2, 0xff8; daddiu $a0, $a0, -1;
+        //    bnez $a0, L; nop
+        CODE("\x00\xa6\x60\x2d\xdd\x8d\x00\x00\xfd\x8d\x10\x00\x64\xc6\x00\x08\x30\xc6\x0f\xf8\x64\x84\xff\xff\x14\x80\xff\xf9\x00\x00\x00\x00", 0, 8),
+        // L: jalr $a1; nop; daddiu $a0, $a0, -1; bnez $a0, L; nop
+        // F: jr $ra; daddu $v0, $v0, $a0
+        CODE("\x00\xa0\xf8\x09\x00\x00\x00\x00\x64\x84\xff\xff\x14\x80\xff\xfc\x00\x00\x00\x00\x03\xe0\x00\x08\x00\x44\x10\x2d", 20, 7),
+        // L: syscall; daddiu $a0, $a0, -1; bnez $a0, L; nop
+        CODE("\x00\x00\x00\x0c\x64\x84\xff\xff\x14\x80\xff\xfd\x00\x00\x00\x00", 0, 4),
+    } },
+    // traps are not resumed past the trap instruction on these guests, so
+    // they have no system call workload
+    { "sparc", UC_ARCH_SPARC, UC_MODE_SPARC32 | UC_MODE_BIG_ENDIAN, UC_SPARC_REG_O0, UC_SPARC_REG_O2, 0, 0, {
+        // L: add %o1, %o0, %o1; xor %o1, 0x55, %o1; subcc %o0, 1, %o0;
+        //    bne L; nop
+        CODE("\x92\x02\x40\x08\x92\x1a\x60\x55\x90\xa2\x20\x01\x12\xbf\xff\xfd\x01\x00\x00\x00", 0, 5),
+        // sethi %hi(0x1000), %o5; add %o2, %o5, %o5
+        // L: ld [%o2+%o3], %g1; st %g1, [%o5+%o3]; add %o3, 4, %o3;
+        //    and %o3, 0xffc, %o3; subcc %o0, 1, %o0; bne L; nop
+        CODE("\x1b\x00\x00\x04\x9a\x02\x80\x0d\xc2\x02\x80\x0b\xc2\x23\x40\x0b\x96\x02\xe0\x04\x96\x0a\xef\xfc\x90\xa2\x20\x01\x12\xbf\xff\xfb\x01\x00\x00\x00", 0, 7),
+        // L: call %o2; nop; subcc %o0, 1, %o0; bne L; nop
+        // F: retl; add %o1, %o0, %o1
+        CODE("\x9f\xc2\x80\x00\x01\x00\x00\x00\x90\xa2\x20\x01\x12\xbf\xff\xfd\x01\x00\x00\x00\x81\xc3\xe0\x08\x92\x02\x40\x08", 20, 7),
+        { NULL },
+    } },
+    { "m68k", UC_ARCH_M68K, UC_MODE_BIG_ENDIAN, UC_M68K_REG_D0, UC_M68K_REG_A0, UC_M68K_REG_A7, 0, {
+        // L: add.l d0, d1; eori.l #0x55, d1; subq.l #1, d0; bne.b L
+        CODE("\xd2\x80\x0a\x81\x00\x00\x00\x55\x53\x80\x66\xf4", 0, 4),
+        // lea (0x1000, a0), a1
+        // L: move.l (0, a0, d2.l), d3; move.l d3, (0, a1, d2.l); addq.l #4, d2;
+        //    andi.l #0xffc, d2; subq.l #1, d0; bne.b L
+        CODE("\x43\xe8\x10\x00\x26\x30\x28\x00\x23\x83\x28\x00\x58\x82\x02\x82\x00\x00\x0f\xfc\x53\x80\x66\xec", 0, 6),
+        // L: jsr (a0); subq.l #1, d0; bne.b L; F: add.l d0, d1; rts
+        CODE("\x4e\x90\x53\x80\x66\xfa\xd2\x80\x4e\x75", 6, 5),
+        { NULL },
+    } },
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        fprintf(stderr, "Failed on %s() with error returned: %u (%s)\n",
+                func, err, uc_strerror(err));
+        exit(1);
+    }
+}
+
+static void hook_code(uc_engine *uc, uint64_t address, uint32_t size, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+static void hook_intr(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+static void hook_syscall(uc_engine *uc, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+// seconds to run @ops iterations of @workload on @g from a fresh engine;
+// *insns gets the guest instructions executed
+static double run(const struct guest *g, int workload, uint64_t ops, uint64_t *insns)
+{
+    const struct code *c = &g->code[workload == HOOK ? ALU : workload];
+    uint64_t begin = ADDRESS, until = ADDRESS + c->size;
+    uint64_t ptr = DATA, sp = DATA + DATA_SIZE;
+    uint64_t calls = 0;
+    uc_engine *uc;
+    uc_hook hh;
+    double t0, t1;
+
+    if (workload == INDIRECT) {
+        ptr = ADDRESS + c->fn;
+        until = ADDRESS + c->fn;
+    }
+    if (g->mode & UC_MODE_THUMB) {
+        // stay in Thumb state, on entry and through blx
+        begin |= 1;
+        if (workload == INDIRECT)
+            ptr |= 1;
+    }
+
+    check(uc_open(g->arch, g->mode, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_map(uc, DATA, DATA_SIZE, UC_PROT_READ | UC_PROT_WRITE), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, c->bytes, c->size), "uc_mem_write");
+    check(uc_reg_write(uc, g->counter_reg, &ops), "uc_reg_write");
+    check(uc_reg_write(uc, g->ptr_reg, &ptr), "uc_reg_write");
+    if (g->sp_reg)
+        check(uc_reg_write(uc, g->sp_reg, &sp), "uc_reg_write");
+
+    if (workload == SYSCALL && g->insn)
+        check(uc_hook_add(uc, &hh, UC_HOOK_INSN, hook_syscall, &calls, 1, 0, g->insn), "uc_hook_add");
+    if (workload == SYSCALL && !g->insn)
+        check(uc_hook_add(uc, &hh, UC_HOOK_INTR, hook_intr, &calls, 1, 0), "uc_hook_add");
+    if (workload == HOOK)
+        check(uc_hook_add(uc, &hh, UC_HOOK_CODE, hook_code, &calls, 1, 0), "uc_hook_add");
+
+    t0 = now();
+    check(uc_emu_start(uc, begin, until, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    if (workload == SYSCALL && calls != ops) {
+        fprintf(stderr, "%s: %" PRIu64 " system calls, expected %" PRIu64 "\n",
+                g->name, calls, ops);
+        exit(1);
+    }
+
+    // the code hook counts what ran, preamble included
+    *insns = workload == HOOK ? calls : ops * c->insns;
+
+    return t1 - t0;
+}
+
+// seconds for @ops engines of @g to be opened, given memory and closed
+static double run_open_close(const struct guest *g, uint64_t ops)
+{
+    uc_engine *uc;
+    uint64_t i;
+    double t0, t1;
+
+    t0 = now();
+    for (i = 0; i < ops; i++) {
+        check(uc_open(g->arch, g->mode, &uc), "uc_open");
+        check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+        check(uc_close(uc), "uc_close");
+    }
+    t1 = now();
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    double scale = 1;
+    int repeat = REPEAT;
+    unsigned int major, minor;
+    const char *sep = "";
+    size_t i;
+    int w, r;
+
+    if (argc > 1) {
+        scale = strtod(argv[1], NULL);
+    }
+    if (argc > 2) {
+        repeat = atoi(argv[2]);
+    }
+    if (scale <= 0 || repeat < 1) {
+        fprintf(stderr, "usage: %s [scale [repeat]]\n", argv[0]);
+        return 1;
+    }
+
+    uc_version(&major, &minor);
+    printf("{\n  \"version\": \"%u.%u\",\n  \"scale\": %g,\n  \"repeat\": %d,\n"
+            "  \"results\": [", major, minor, scale, repeat);
+
+    for (i = 0; i < sizeof(guests) / sizeof(guests[0]); i++) {
+        const struct guest *g = &guests[i];
+
+        if (!uc_arch_supported(g->arch)) {
+            continue;
+        }
+
+        for (w = 0; w < NWORKLOADS; w++) {
+            uint64_t ops = (uint64_t)(workloads[w].ops * scale);
+            uint64_t insns = 0;
+            double best = 0;
+
+            if (w == SYSCALL && !g->code[SYSCALL].bytes) {
+                continue;
+            }
+            if (ops == 0) {
+                ops = 1;
+            }
+
+            for (r = 0; r < repeat; r++) {
+                double t = w == OPEN_CLOSE ? run_open_close(g, ops) : run(g, w, ops, &insns);
+
+                if (r == 0 || t < best)
+                    best = t;
+            }
+
+            printf("%s\n    { \"arch\": \"%s\", \"workload\": \"%s\", \"ops\": %" PRIu64
+                    ", \"insns\": %" PRIu64 ", \"seconds\": %.6f, ",
+                    sep, g->name, workloads[w].name, ops, insns, best);
+            if (w == OPEN_CLOSE)
+                printf("\"mips\": null, ");
+            else
+                printf("\"mips\": %.2f, ", insns / best / 1e6);
+            printf("\"ns_per_op\": %.2f }", best * 1e9 / ops);
+            fflush(stdout);
+            sep = ",";
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
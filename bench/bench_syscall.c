@@ -0,0 +1,140 @@
+/* Unicorn Emulator Engine */
+
+/* Syscall dispatch throughput.  Each supported target runs a counted loop
+   around its system call instruction with a no-op hook registered, the
+   way a user-mode emulator services guest syscalls.  Interrupt hooks run
+   from the translated block itself, which then returns to the main loop
+   without raising an exception, so this measures the cost of one hook
+   round trip and one block lookup per trap.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       2000000
+
+struct guest {
+    const char *name;
+    uc_arch arch;
+    uc_mode mode;
+    const char *code;
+    size_t size;
+    int counter_reg;
+    int insn;           // UC_HOOK_INSN instruction, or 0 for UC_HOOK_INTR
+};
+
+// L: int 0x80; dec ecx; jnz L
+#define X86_CODE32 "\xcd\x80\x49\x75\xfb"
+// L: syscall; dec rbx; jnz L
+#define X86_CODE64 "\x0f\x05\x48\xff\xcb\x75\xf9"
+// L: svc #0; subs r0, r0, #1; bne L
+#define ARM_CODE "\x00\x00\x00\xef\x01\x00\x50\xe2\xfc\xff\xff\x1a"
+// L: svc #0; subs x0, x0, #1; b.ne L
+#define ARM64_CODE "\x01\x00\x00\xd4\x00\x04\x00\xf1\xc1\xff\xff\x54"
+// L: syscall; addiu $a0, $a0, -1; bnez $a0, L; nop
+#define MIPS_CODE "\x0c\x00\x00\x00\xff\xff\x84\x24\xfd\xff\x80\x14\x00\x00\x00\x00"
+
+static const struct guest guests[] = {
+    { "x86-32 int80", UC_ARCH_X86, UC_MODE_32, X86_CODE32, sizeof(X86_CODE32) - 1, UC_X86_REG_ECX, 0 },
+    { "x86-64 syscall", UC_ARCH_X86, UC_MODE_64, X86_CODE64, sizeof(X86_CODE64) - 1, UC_X86_REG_RBX, UC_X86_INS_SYSCALL },
+    { "arm svc", UC_ARCH_ARM, UC_MODE_ARM, ARM_CODE, sizeof(ARM_CODE) - 1, UC_ARM_REG_R0, 0 },
+    { "arm64 svc", UC_ARCH_ARM64, UC_MODE_ARM, ARM64_CODE, sizeof(ARM64_CODE) - 1, UC_ARM64_REG_X0, 0 },
+    { "mipsel syscall", UC_ARCH_MIPS, UC_MODE_MIPS32 + UC_MODE_LITTLE_ENDIAN, MIPS_CODE, sizeof(MIPS_CODE) - 1, UC_MIPS_REG_A0, 0 },
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+static void hook_intr(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+static void hook_syscall(uc_engine *uc, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+// seconds to run @iters syscalls of @g
+static double run(const struct guest *g, uint64_t iters)
+{
+    uint64_t calls = 0;
+    uc_engine *uc;
+    uc_hook hh;
+    double t0, t1;
+
+    check(uc_open(g->arch, g->mode, &uc), "uc_open");
+    check(uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, g->code, g->size), "uc_mem_write");
+    check(uc_reg_write(uc, g->counter_reg, &iters), "uc_reg_write");
+    if (g->insn) {
+        check(uc_hook_add(uc, &hh, UC_HOOK_INSN, hook_syscall, &calls, 1, 0, g->insn),
+                "uc_hook_add");
+    } else {
+        check(uc_hook_add(uc, &hh, UC_HOOK_INTR, hook_intr, &calls, 1, 0), "uc_hook_add");
+    }
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, ADDRESS + g->size, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    if (calls != iters) {
+        printf("%s: %" PRIu64 " hook calls, expected %" PRIu64 "\n", g->name, calls, iters);
+        exit(1);
+    }
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint64_t iters = ITERS;
+    size_t i;
+
+    if (argc > 1) {
+        iters = strtoull(argv[1], NULL, 0);
+    }
+
+    printf("%-16s %16s\n", "guest", "syscalls/s");
+
+    for (i = 0; i < sizeof(guests) / sizeof(guests[0]); i++) {
+        const struct guest *g = &guests[i];
+        double t;
+
+        if (!uc_arch_supported(g->arch)) {
+            continue;
+        }
+
+        t = run(g, iters);
+        printf("%-16s %14.2f M\n", g->name, iters / t / 1e6);
+    }
+
+    return 0;
+}
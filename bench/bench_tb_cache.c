@@ -0,0 +1,119 @@
+/* Unicorn Emulator Engine */
+
+/* Time to the first million guest instructions, with and without the
+   persistent translation cache.  The guest is an X86-32 "firmware" of many
+   small distinct blocks, run in a loop until one million instructions have
+   retired, so start-up is dominated by translation.  The cold run writes
+   the cache file, the warm run is a fresh engine that installs the saved
+   blocks instead of translating them.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x1000000
+#define NBLOCKS     2000
+#define BLOCK_SIZE  7       // add eax, imm32; jmp $+2
+#define TAIL_SIZE   7       // dec ecx; jnz ADDRESS
+#define INSNS       1000000
+#define CACHE_FILE  "bench_tb_cache.tbcache"
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static size_t make_code(uint8_t *code)
+{
+    uint8_t *p = code;
+    int32_t rel;
+    int i;
+
+    for (i = 0; i < NBLOCKS; i++) {
+        *p++ = 0x05;    // add eax, i
+        memcpy(p, &i, 4);
+        p += 4;
+        *p++ = 0xeb;    // jmp $+2
+        *p++ = 0x00;
+    }
+    *p++ = 0x49;        // dec ecx
+    *p++ = 0x0f;        // jnz ADDRESS
+    *p++ = 0x85;
+    rel = -(int32_t)(p + 4 - code);
+    memcpy(p, &rel, 4);
+    p += 4;
+
+    return p - code;
+}
+
+// seconds from uc_open_with() to the end of the first INSNS instructions
+static double run(const uint8_t *code, size_t len, size_t *hits, size_t *misses)
+{
+    uc_open_opts opts = { 0, 0, 0, CACHE_FILE };
+    uint32_t passes = INSNS / (2 * NBLOCKS + 2) + 1;
+    uc_engine *uc;
+    double t0, t1;
+    uc_err err;
+
+    t0 = now();
+    err = uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc);
+    if (err) {
+        printf("Failed on uc_open_with() with error returned: %u\n", err);
+        exit(1);
+    }
+    uc_mem_map(uc, ADDRESS, (len + 0xfff) & ~0xfff, UC_PROT_ALL);
+    uc_mem_write(uc, ADDRESS, code, len);
+    uc_reg_write(uc, UC_X86_REG_ECX, &passes);
+    err = uc_emu_start(uc, ADDRESS, ADDRESS + len, 0, 0);
+    t1 = now();
+    if (err) {
+        printf("Failed on uc_emu_start() with error returned: %u\n", err);
+        exit(1);
+    }
+
+    uc_query(uc, UC_QUERY_TB_CACHE_HITS, hits);
+    uc_query(uc, UC_QUERY_TB_CACHE_MISSES, misses);
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    static uint8_t code[NBLOCKS * BLOCK_SIZE + TAIL_SIZE];
+    size_t len = make_code(code);
+    size_t hits, misses;
+    double cold, warm;
+
+    if (!uc_arch_supported(UC_ARCH_X86)) {
+        printf("X86 is not supported by this build\n");
+        return 0;
+    }
+
+    remove(CACHE_FILE);
+    cold = run(code, len, &hits, &misses);
+    printf("%-6s %10.2f ms to 1M insns, %6zu hits, %6zu misses\n",
+            "cold", cold * 1e3, hits, misses);
+    warm = run(code, len, &hits, &misses);
+    printf("%-6s %10.2f ms to 1M insns, %6zu hits, %6zu misses, hit rate %.1f%%\n",
+            "warm", warm * 1e3, hits, misses,
+            hits + misses ? 100.0 * hits / (hits + misses) : 0.0);
+    printf("speedup %.2fx\n", cold / warm);
+    remove(CACHE_FILE);
+
+    return 0;
+}
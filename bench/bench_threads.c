@@ -0,0 +1,168 @@
+/* Unicorn Emulator Engine */
+
+/* Multi-core scaling of independent engines.  For 1..N threads, each thread
+   opens its own X86-64 engine and runs the same CPU-bound guest loop; all
+   threads start together.  Engines share no state, so aggregate throughput
+   should grow close to linearly with the thread count until the host runs
+   out of cores.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define ADDRESS   0x1000000
+#define DEFAULT_ITERS 50000000
+#define MAX_THREADS 256
+
+// add rax, rcx; dec rcx; jnz -8
+#define X86_CODE64 "\x48\x01\xc8\x48\xff\xc9\x75\xf8"
+#define INSNS_PER_ITER 3
+
+struct worker {
+    uint64_t iters;
+    int failed;
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static int online_cpus(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void run_worker(struct worker *w)
+{
+    uc_engine *uc;
+    uint64_t rcx = w->iters;
+
+    if (uc_open(UC_ARCH_X86, UC_MODE_64, &uc)) {
+        w->failed = 1;
+        return;
+    }
+
+    uc_mem_map(uc, ADDRESS, 0x1000, UC_PROT_ALL);
+    uc_mem_write(uc, ADDRESS, X86_CODE64, sizeof(X86_CODE64) - 1);
+    uc_reg_write(uc, UC_X86_REG_RCX, &rcx);
+
+    if (uc_emu_start(uc, ADDRESS, ADDRESS + sizeof(X86_CODE64) - 1, 0, 0))
+        w->failed = 1;
+
+    uc_close(uc);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg)
+{
+    run_worker(arg);
+    return 0;
+}
+#else
+static void *worker_main(void *arg)
+{
+    run_worker(arg);
+    return NULL;
+}
+#endif
+
+// wall-clock seconds for @n threads to finish, or a negative value on error
+static double run_threads(int n, uint64_t iters)
+{
+    struct worker workers[MAX_THREADS];
+#ifdef _WIN32
+    HANDLE threads[MAX_THREADS];
+#else
+    pthread_t threads[MAX_THREADS];
+#endif
+    double t0, t1;
+    int i, failed = 0;
+
+    t0 = now();
+    for (i = 0; i < n; i++) {
+        workers[i].iters = iters;
+        workers[i].failed = 0;
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, worker_main, &workers[i], 0, NULL);
+#else
+        pthread_create(&threads[i], NULL, worker_main, &workers[i]);
+#endif
+    }
+    for (i = 0; i < n; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+        failed |= workers[i].failed;
+    }
+    t1 = now();
+
+    return failed ? -1 : t1 - t0;
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    int max_threads = online_cpus();
+    uint64_t iters = DEFAULT_ITERS;
+    double base = 0;
+    int n;
+
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iters = strtoull(argv[2], NULL, 0);
+    }
+    if (max_threads < 1 || max_threads > MAX_THREADS) {
+        printf("thread count must be between 1 and %d\n", MAX_THREADS);
+        return 1;
+    }
+
+    printf("%8s %14s %14s %8s %10s\n",
+            "threads", "total insn/s", "insn/s/thread", "speedup", "efficiency");
+
+    for (n = 1; n <= max_threads; n++) {
+        double secs = run_threads(n, iters);
+        double rate;
+
+        if (secs < 0) {
+            printf("Failed to run %d engines\n", n);
+            return 1;
+        }
+
+        rate = (double)iters * INSNS_PER_ITER * n / secs;
+        if (n == 1) {
+            base = rate;
+        }
+        printf("%8d %14.0f %14.0f %8.2f %9.0f%%\n", n, rate, rate / n,
+                rate / base, 100.0 * rate / base / n);
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/* Unicorn Emulator Engine */
+
+/* Tiered translation on loop-heavy guests.  Each supported target runs a
+   small counted loop whose body is split by an unconditional branch, once
+   with a single translation tier and once with uc_open_opts.hot_threshold
+   set, where the loop is retranslated as an optimized superblock once hot.
+   A straight-line X86 guest of many blocks that run once shows the other
+   side: cold code only pays for the light first translation.  */
+
+#include <unicorn/unicorn.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define ADDRESS     0x10000
+#define ITERS       20000000
+#define THRESHOLD   32
+#define NBLOCKS     5000    // straight-line guest
+#define BLOCK_SIZE  7       // add eax, imm32; jmp $+2
+
+struct guest {
+    const char *name;
+    uc_arch arch;
+    uc_mode mode;
+    const char *code;
+    size_t size;
+    int counter_reg;
+    int insns_per_iter;
+};
+
+// L: add eax, ecx; jmp M; M: xor eax, 0x55; dec ecx; jnz L
+#define X86_CODE32 "\x01\xc8\xeb\x00\x83\xf0\x55\x49\x75\xf6"
+// L: add rax, rcx; jmp M; M: xor rax, 0x55; dec rcx; jnz L
+#define X86_CODE64 "\x48\x01\xc8\xeb\x00\x48\x83\xf0\x55\x48\xff\xc9\x75\xf2"
+// L: add r1, r1, r0; b M; M: eor r1, r1, #0x55; subs r0, r0, #1; bne L
+#define ARM_CODE "\x00\x10\x81\xe0\xff\xff\xff\xea\x55\x10\x21\xe2\x01\x00\x50\xe2\xfa\xff\xff\x1a"
+// L: add x1, x1, x0; b M; M: add x1, x1, #0x55; subs x0, x0, #1; b.ne L
+#define ARM64_CODE "\x21\x00\x00\x8b\x01\x00\x00\x14\x21\x54\x01\x91\x00\x04\x00\xf1\x81\xff\xff\x54"
+// L: addu $v1, $v1, $a0; xori $v1, $v1, 0x55; addiu $a0, $a0, -1; bnez $a0, L; nop
+#define MIPS_CODE "\x21\x18\x64\x00\x55\x00\x63\x38\xff\xff\x84\x24\xfc\xff\x80\x14\x00\x00\x00\x00"
+
+static const struct guest guests[] = {
+    { "x86-32", UC_ARCH_X86, UC_MODE_32, X86_CODE32, sizeof(X86_CODE32) - 1, UC_X86_REG_ECX, 5 },
+    { "x86-64", UC_ARCH_X86, UC_MODE_64, X86_CODE64, sizeof(X86_CODE64) - 1, UC_X86_REG_RCX, 5 },
+    { "arm", UC_ARCH_ARM, UC_MODE_ARM, ARM_CODE, sizeof(ARM_CODE) - 1, UC_ARM_REG_R0, 5 },
+    { "arm64", UC_ARCH_ARM64, UC_MODE_ARM, ARM64_CODE, sizeof(ARM64_CODE) - 1, UC_ARM64_REG_X0, 5 },
+    { "mipsel", UC_ARCH_MIPS, UC_MODE_MIPS32 + UC_MODE_LITTLE_ENDIAN, MIPS_CODE, sizeof(MIPS_CODE) - 1, UC_MIPS_REG_A0, 5 },
+};
+
+static double now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void check(uc_err err, const char *func)
+{
+    if (err) {
+        printf("Failed on %s() with error returned: %u\n", func, err);
+        exit(1);
+    }
+}
+
+// seconds to run @code from a fresh engine
+static double run(uc_arch arch, uc_mode mode, uint32_t hot_threshold,
+        const void *code, size_t size, int counter_reg, uint64_t counter)
+{
+    uc_open_opts opts = { 0, 0, 0, NULL, hot_threshold };
+    uc_engine *uc;
+    double t0, t1;
+
+    check(uc_open_with(arch, mode, &opts, &uc), "uc_open_with");
+    check(uc_mem_map(uc, ADDRESS, (size + 0xfff) & ~0xfff, UC_PROT_ALL), "uc_mem_map");
+    check(uc_mem_write(uc, ADDRESS, code, size), "uc_mem_write");
+    if (counter_reg)
+        check(uc_reg_write(uc, counter_reg, &counter), "uc_reg_write");
+
+    t0 = now();
+    check(uc_emu_start(uc, ADDRESS, ADDRESS + size, 0, 0), "uc_emu_start");
+    t1 = now();
+
+    uc_close(uc);
+
+    return t1 - t0;
+}
+
+static void bench_straight(void)
+{
+    static uint8_t code[NBLOCKS * BLOCK_SIZE];
+    uint8_t *p = code;
+    double single, tiered;
+    int i;
+
+    for (i = 0; i < NBLOCKS; i++) {
+        *p++ = 0x05;    // add eax, i
+        memcpy(p, &i, 4);
+        p += 4;
+        *p++ = 0xeb;    // jmp $+2
+        *p++ = 0x00;
+    }
+
+    single = run(UC_ARCH_X86, UC_MODE_32, 0, code, sizeof(code), 0, 0);
+    tiered = run(UC_ARCH_X86, UC_MODE_32, THRESHOLD, code, sizeof(code), 0, 0);
+    printf("%-14s %12.3f ms %12.3f ms %8.2fx\n", "x86-32 cold",
+            single * 1e3, tiered * 1e3, single / tiered);
+}
+
+int main(int argc, char **argv, char **envp)
+{
+    uint64_t iters = ITERS;
+    size_t i;
+
+    if (argc > 1) {
+        iters = strtoull(argv[1], NULL, 0);
+    }
+
+    printf("%-14s %15s %15s %9s\n", "guest", "single tier", "tiered", "speedup");
+
+    for (i = 0; i < sizeof(guests) / sizeof(guests[0]); i++) {
+        const struct guest *g = &guests[i];
+        double single, tiered;
+
+        if (!uc_arch_supported(g->arch)) {
+            continue;
+        }
+
+        single = run(g->arch, g->mode, 0, g->code, g->size, g->counter_reg, iters);
+        tiered = run(g->arch, g->mode, THRESHOLD, g->code, g->size, g->counter_reg, iters);
+        printf("%-14s %10.1f Mips %10.1f Mips %8.2fx\n", g->name,
+                iters * g->insns_per_iter / single / 1e6,
+                iters * g->insns_per_iter / tiered / 1e6, single / tiered);
+    }
+
+    if (uc_arch_supported(UC_ARCH_X86)) {
+        bench_straight();
+    }
+
+    return 0;
+}
@@ -102,6 +102,14 @@ module Common =
     let UC_QUERY_MODE = 1
     let UC_QUERY_PAGE_SIZE = 2
     let UC_QUERY_ARCH = 3
+    let UC_QUERY_MEMORY = 4
+    let UC_QUERY_TB_CACHE_HITS = 5
+    let UC_QUERY_TB_CACHE_MISSES = 6
+    let UC_QUERY_TB_HOT = 7
+    let UC_OPT_LOW_MEMORY = 1
+    let UC_OPT_PERF_MAP = 2
+    let UC_OPT_JITDUMP = 4
+    let UC_OPT_TB_COUNTS = 8
 
     let UC_PROT_NONE = 0
     let UC_PROT_READ = 1
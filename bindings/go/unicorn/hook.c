@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <unicorn/unicorn.h>
 #include "_cgo_export.h"
 
@@ -13,6 +14,35 @@ uc_err uc_hook_add_insn(uc_engine *handle, uc_hook *h2, uc_hook_type type, void
     return uc_hook_add(handle, h2, type, callback, (void *)user, begin, end, insn);
 }
 
+hook_batch *hook_batch_new(uintptr_t user) {
+    hook_batch *batch = calloc(1, sizeof(hook_batch));
+    if (batch)
+        batch->user = user;
+    return batch;
+}
+
+void hook_batch_flush(uc_engine *handle, hook_batch *batch) {
+    uint32_t count = batch->count;
+    if (count) {
+        // reset first: the Go callback may run the engine again
+        batch->count = 0;
+        hookCodeBatch(handle, batch->events, count, (void *)batch->user);
+    }
+}
+
+static void hookCodeBatch_cgo(uc_engine *handle, uint64_t addr, uint32_t size, hook_batch *batch) {
+    batch->events[batch->count].addr = addr;
+    batch->events[batch->count].size = size;
+    if (++batch->count == HOOK_BATCH_SIZE)
+        hook_batch_flush(handle, batch);
+}
+
+uc_err uc_hook_add_batch(uc_engine *handle, uc_hook *h2, uc_hook_type type, hook_batch *batch, uint64_t begin, uint64_t end) {
+    if (!batch)
+        return UC_ERR_NOMEM;
+    return uc_hook_add(handle, h2, type, hookCodeBatch_cgo, batch, begin, end);
+}
+
 void hookCode_cgo(uc_engine *handle, uint64_t addr, uint32_t size, uintptr_t user) {
     hookCode(handle, addr, size, (void *)user);
 }
@@ -3,10 +3,12 @@ package unicorn
 import (
 	"errors"
 	"sync"
+	"sync/atomic"
 	"unsafe"
 )
 
 /*
+#include <stdlib.h>
 #include <unicorn/unicorn.h>
 #include "hook.h"
 */
@@ -19,85 +21,131 @@ type HookData struct {
 
 type Hook uint64
 
-type fastHookMap struct {
-	vals []*HookData
-	sync.RWMutex
+// CodeEvent is one block or instruction delivered by HookAddBatch.
+type CodeEvent struct {
+	Addr uint64
+	Size uint32
 }
 
-func (m *fastHookMap) insert(h *HookData) uintptr {
-	// don't change this to defer
-	m.Lock()
-	for i, v := range m.vals {
+// snapshotTable is a slot table that readers access without locking:
+// writers copy the slice under the mutex and publish the copy atomically.
+// Callbacks read it on every event; inserts and removes are rare.
+type snapshotTable struct {
+	vals atomic.Value // []interface{}
+	sync.Mutex
+}
+
+func (t *snapshotTable) insert(v interface{}) uintptr {
+	t.Lock()
+	old, _ := t.vals.Load().([]interface{})
+	vals := make([]interface{}, len(old), len(old)+1)
+	copy(vals, old)
+	i := len(vals)
+	for j, v := range vals {
 		if v == nil {
-			m.vals[i] = h
-			m.Unlock()
-			return uintptr(i)
+			i = j
+			break
 		}
 	}
-	i := len(m.vals)
-	m.vals = append(m.vals, h)
-	m.Unlock()
+	if i == len(vals) {
+		vals = append(vals, v)
+	} else {
+		vals[i] = v
+	}
+	t.vals.Store(vals)
+	t.Unlock()
 	return uintptr(i)
 }
 
-func (m *fastHookMap) get(i unsafe.Pointer) *HookData {
-	m.RLock()
-	// TODO: nil check?
-	v := m.vals[uintptr(i)]
-	m.RUnlock()
-	return v
+func (t *snapshotTable) get(i uintptr) interface{} {
+	return t.vals.Load().([]interface{})[i]
 }
 
-func (m *fastHookMap) remove(i uintptr) {
-	m.Lock()
-	m.vals[i] = nil
-	m.Unlock()
+func (t *snapshotTable) remove(i uintptr) {
+	t.Lock()
+	old := t.vals.Load().([]interface{})
+	vals := make([]interface{}, len(old))
+	copy(vals, old)
+	vals[i] = nil
+	t.vals.Store(vals)
+	t.Unlock()
+}
+
+// The user data of a hook holds the engine's slot in engines, and the slot
+// of its HookData in that engine's own table.
+const hookSlotBits = 16 << (^uintptr(0) >> 63)
+
+// engines holds the hook table of each open engine
+var engines snapshotTable
+
+func hookKey(engine, slot uintptr) uintptr {
+	return engine<<hookSlotBits | slot
 }
 
-var hookMap fastHookMap
+func getHook(user unsafe.Pointer) *HookData {
+	key := uintptr(user)
+	hooks := engines.get(key >> hookSlotBits).(*snapshotTable)
+	return hooks.get(key & (1<<hookSlotBits - 1)).(*HookData)
+}
 
 //export hookCode
 func hookCode(handle unsafe.Pointer, addr uint64, size uint32, user unsafe.Pointer) {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	hook.Callback.(func(Unicorn, uint64, uint32))(hook.Uc, uint64(addr), uint32(size))
 }
 
+//export hookCodeBatch
+func hookCodeBatch(handle unsafe.Pointer, events *C.uc_code_event, count C.uint32_t, user unsafe.Pointer) {
+	hook := getHook(user)
+	evs := (*[1 << 24]CodeEvent)(unsafe.Pointer(events))[:count:count]
+	hook.Callback.(func(Unicorn, []CodeEvent))(hook.Uc, evs)
+}
+
 //export hookMemInvalid
 func hookMemInvalid(handle unsafe.Pointer, typ C.uc_mem_type, addr uint64, size int, value int64, user unsafe.Pointer) bool {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	return hook.Callback.(func(Unicorn, int, uint64, int, int64) bool)(hook.Uc, int(typ), addr, size, value)
 }
 
 //export hookMemAccess
 func hookMemAccess(handle unsafe.Pointer, typ C.uc_mem_type, addr uint64, size int, value int64, user unsafe.Pointer) {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	hook.Callback.(func(Unicorn, int, uint64, int, int64))(hook.Uc, int(typ), addr, size, value)
 }
 
 //export hookInterrupt
 func hookInterrupt(handle unsafe.Pointer, intno uint32, user unsafe.Pointer) {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	hook.Callback.(func(Unicorn, uint32))(hook.Uc, intno)
 }
 
 //export hookX86In
 func hookX86In(handle unsafe.Pointer, port, size uint32, user unsafe.Pointer) uint32 {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	return hook.Callback.(func(Unicorn, uint32, uint32) uint32)(hook.Uc, port, size)
 }
 
 //export hookX86Out
 func hookX86Out(handle unsafe.Pointer, port, size, value uint32, user unsafe.Pointer) {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	hook.Callback.(func(Unicorn, uint32, uint32, uint32))(hook.Uc, port, size, value)
 }
 
 //export hookX86Syscall
 func hookX86Syscall(handle unsafe.Pointer, user unsafe.Pointer) {
-	hook := hookMap.get(user)
+	hook := getHook(user)
 	hook.Callback.(func(Unicorn))(hook.Uc)
 }
 
+func (u *uc) insertHook(cb interface{}) (uintptr, error) {
+	slot := u.table.insert(&HookData{u, cb})
+	if slot >= 1<<hookSlotBits {
+		u.table.remove(slot)
+		return 0, errors.New("Too many hooks.")
+	}
+	return hookKey(u.id, slot), nil
+}
+
 func (u *uc) HookAdd(htype int, cb interface{}, begin, end uint64, extra ...int) (Hook, error) {
 	var callback unsafe.Pointer
 	var insn C.int
@@ -132,8 +180,10 @@ func (u *uc) HookAdd(htype int, cb interface{}, begin, end uint64, extra ...int)
 		}
 	}
 	var h2 C.uc_hook
-	data := &HookData{u, cb}
-	uptr := hookMap.insert(data)
+	uptr, err := u.insertHook(cb)
+	if err != nil {
+		return 0, err
+	}
 	if insnMode {
 		C.uc_hook_add_insn(u.handle, &h2, C.uc_hook_type(htype), callback, C.uintptr_t(uptr), C.uint64_t(begin), C.uint64_t(end), insn)
 	} else {
@@ -144,10 +194,51 @@ func (u *uc) HookAdd(htype int, cb interface{}, begin, end uint64, extra ...int)
 	return Hook(h2), nil
 }
 
+// HookAddBatch adds a HOOK_BLOCK or HOOK_CODE hook whose events are queued
+// in C and passed to cb in batches, instead of one cgo call per event. The
+// queue is flushed when full and when Start returns. Events arrive in order
+// but late, so cb observes execution and cannot stop or redirect it: use
+// HookAdd for that. The slice is only valid during the call, and cb must
+// not delete its own hook.
+func (u *uc) HookAddBatch(htype int, cb func(Unicorn, []CodeEvent), begin, end uint64) (Hook, error) {
+	if htype != HOOK_BLOCK && htype != HOOK_CODE {
+		return 0, errors.New("Unknown hook type.")
+	}
+	uptr, err := u.insertHook(cb)
+	if err != nil {
+		return 0, err
+	}
+	batch := C.hook_batch_new(C.uintptr_t(uptr))
+	var h2 C.uc_hook
+	if ucerr := C.uc_hook_add_batch(u.handle, &h2, C.uc_hook_type(htype), batch, C.uint64_t(begin), C.uint64_t(end)); ucerr != ERR_OK {
+		C.free(unsafe.Pointer(batch))
+		u.table.remove(uptr & (1<<hookSlotBits - 1))
+		return 0, UcError(ucerr)
+	}
+	u.hooks[Hook(h2)] = uptr
+	u.batches[Hook(h2)] = batch
+	return Hook(h2), nil
+}
+
+// flushBatches delivers the events still queued by HookAddBatch hooks
+func (u *uc) flushBatches() {
+	for _, batch := range u.batches {
+		C.hook_batch_flush(u.handle, batch)
+	}
+}
+
 func (u *uc) HookDel(hook Hook) error {
+	if batch, ok := u.batches[hook]; ok {
+		C.hook_batch_flush(u.handle, batch)
+	}
+	err := errReturn(C.uc_hook_del(u.handle, C.uc_hook(hook)))
+	if batch, ok := u.batches[hook]; ok {
+		delete(u.batches, hook)
+		C.free(unsafe.Pointer(batch))
+	}
 	if uptr, ok := u.hooks[hook]; ok {
 		delete(u.hooks, hook)
-		hookMap.remove(uptr)
+		u.table.remove(uptr & (1<<hookSlotBits - 1))
 	}
-	return errReturn(C.uc_hook_del(u.handle, C.uc_hook(hook)))
+	return err
 }
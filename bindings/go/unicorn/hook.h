@@ -1,3 +1,22 @@
+#ifndef UNICORN_GO_HOOK_H
+#define UNICORN_GO_HOOK_H
+
+#include <stdint.h>
+
+// events queued by a batched code hook before they are passed to Go
+#define HOOK_BATCH_SIZE 256
+
+typedef struct uc_code_event {
+    uint64_t addr;
+    uint32_t size;
+} uc_code_event;
+
+typedef struct hook_batch {
+    uintptr_t user;
+    uint32_t count;
+    uc_code_event events[HOOK_BATCH_SIZE];
+} hook_batch;
+
 uc_err uc_hook_add_wrap(uc_engine *handle, uc_hook *h2, uc_hook_type type, void *callback, uintptr_t user, uint64_t begin, uint64_t end);
 uc_err uc_hook_add_insn(uc_engine *handle, uc_hook *h2, uc_hook_type type, void *callback, uintptr_t user, uint64_t begin, uint64_t end, int insn);
 void hookCode_cgo(uc_engine *handle, uint64_t addr, uint32_t size, uintptr_t user);
@@ -7,3 +26,8 @@ void hookInterrupt_cgo(uc_engine *handle, uint32_t intno, uintptr_t user);
 uint32_t hookX86In_cgo(uc_engine *handle, uint32_t port, uint32_t size, uintptr_t user);
 void hookX86Out_cgo(uc_engine *handle, uint32_t port, uint32_t size, uint32_t value, uintptr_t user);
 void hookX86Syscall_cgo(uc_engine *handle, uintptr_t user);
+hook_batch *hook_batch_new(uintptr_t user);
+void hook_batch_flush(uc_engine *handle, hook_batch *batch);
+uc_err uc_hook_add_batch(uc_engine *handle, uc_hook *h2, uc_hook_type type, hook_batch *batch, uint64_t begin, uint64_t end);
+
+#endif
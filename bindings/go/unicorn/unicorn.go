@@ -10,7 +10,9 @@ import (
 #cgo CFLAGS: -O3 -Wall -Werror -I../../../include
 #cgo LDFLAGS: -L../../../ -lunicorn
 #cgo linux LDFLAGS: -L../../../ -lunicorn -lrt
+#include <stdlib.h>
 #include <unicorn/unicorn.h>
+#include "hook.h"
 #include "uc.h"
 */
 import "C"
@@ -53,6 +55,7 @@ type Unicorn interface {
 	StartWithOptions(begin, until uint64, options *UcOptions) error
 	Stop() error
 	HookAdd(htype int, cb interface{}, begin, end uint64, extra ...int) (Hook, error)
+	HookAddBatch(htype int, cb func(Unicorn, []CodeEvent), begin, end uint64) (Hook, error)
 	HookDel(hook Hook) error
 	Query(queryType int) (uint64, error)
 	Close() error
@@ -63,9 +66,12 @@ type Unicorn interface {
 }
 
 type uc struct {
-	handle *C.uc_engine
-	final  sync.Once
-	hooks  map[Hook]uintptr
+	handle  *C.uc_engine
+	final   sync.Once
+	id      uintptr
+	table   *snapshotTable
+	hooks   map[Hook]uintptr
+	batches map[Hook]*C.hook_batch
 }
 
 type UcOptions struct {
@@ -87,7 +93,13 @@ func NewUnicorn(arch, mode int) (Unicorn, error) {
 	if ucerr := C.uc_open(C.uc_arch(arch), C.uc_mode(mode), &handle); ucerr != ERR_OK {
 		return nil, UcError(ucerr)
 	}
-	u := &uc{handle: handle, hooks: make(map[Hook]uintptr)}
+	u := &uc{
+		handle:  handle,
+		table:   &snapshotTable{},
+		hooks:   make(map[Hook]uintptr),
+		batches: make(map[Hook]*C.hook_batch),
+	}
+	u.id = engines.insert(u.table)
 	runtime.SetFinalizer(u, func(u *uc) { u.Close() })
 	return u, nil
 }
@@ -95,12 +107,14 @@ func NewUnicorn(arch, mode int) (Unicorn, error) {
 func (u *uc) Close() (err error) {
 	u.final.Do(func() {
 		if u.handle != nil {
-			for _, uptr := range u.hooks {
-				hookMap.remove(uptr)
-			}
-			u.hooks = nil
 			err = errReturn(C.uc_close(u.handle))
 			u.handle = nil
+			for _, batch := range u.batches {
+				C.free(unsafe.Pointer(batch))
+			}
+			u.batches = nil
+			u.hooks = nil
+			engines.remove(u.id)
 		}
 	})
 	return err
@@ -108,6 +122,7 @@ func (u *uc) Close() (err error) {
 
 func (u *uc) StartWithOptions(begin, until uint64, options *UcOptions) error {
 	ucerr := C.uc_emu_start(u.handle, C.uint64_t(begin), C.uint64_t(until), C.uint64_t(options.Timeout), C.size_t(options.Count))
+	u.flushBatches()
 	return errReturn(ucerr)
 }
 
@@ -97,6 +97,14 @@ const (
 	QUERY_MODE = 1
 	QUERY_PAGE_SIZE = 2
 	QUERY_ARCH = 3
+	QUERY_MEMORY = 4
+	QUERY_TB_CACHE_HITS = 5
+	QUERY_TB_CACHE_MISSES = 6
+	QUERY_TB_HOT = 7
+	OPT_LOW_MEMORY = 1
+	OPT_PERF_MAP = 2
+	OPT_JITDUMP = 4
+	OPT_TB_COUNTS = 8
 
 	PROT_NONE = 0
 	PROT_READ = 1
@@ -1,6 +1,7 @@
 package unicorn
 
 import (
+	"reflect"
 	"testing"
 )
 
@@ -72,3 +73,93 @@ func TestQuery(t *testing.T) {
 		t.Fatalf("query returned invalid mode: %d != %d", mode, MODE_THUMB)
 	}
 }
+
+// inc ecx; jmp $-1, run for a given instruction count
+const loopCode = "\x41\xeb\xfd"
+
+func makeLoop(tb testing.TB) Unicorn {
+	mu, err := NewUnicorn(ARCH_X86, MODE_32)
+	if err != nil {
+		tb.Fatal(err)
+	}
+	if err := mu.MemMap(0x1000, 0x1000); err != nil {
+		tb.Fatal(err)
+	}
+	if err := mu.MemWrite(0x1000, []byte(loopCode)); err != nil {
+		tb.Fatal(err)
+	}
+	return mu
+}
+
+func TestHookBatch(t *testing.T) {
+	mu := makeLoop(t)
+	var single, batched []uint64
+	mu.HookAdd(HOOK_CODE, func(mu Unicorn, addr uint64, size uint32) {
+		single = append(single, addr)
+	}, 1, 0)
+	h, err := mu.HookAddBatch(HOOK_CODE, func(mu Unicorn, events []CodeEvent) {
+		for _, ev := range events {
+			batched = append(batched, ev.Addr)
+		}
+	}, 1, 0)
+	if err != nil {
+		t.Fatal(err)
+	}
+	// more than one batch, plus what is left when Start returns
+	if err := mu.StartWithOptions(0x1000, 0x1003, &UcOptions{Count: 1000}); err != nil {
+		t.Fatal(err)
+	}
+	if len(single) != 1000 || !reflect.DeepEqual(single, batched) {
+		t.Fatalf("batched events differ: %d != %d", len(batched), len(single))
+	}
+	if err := mu.HookDel(h); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := mu.HookAddBatch(HOOK_INTR, func(mu Unicorn, events []CodeEvent) {}, 1, 0); err == nil {
+		t.Fatal("HookAddBatch accepted HOOK_INTR")
+	}
+}
+
+func benchHookCode(b *testing.B, mu Unicorn, n int) {
+	if err := mu.StartWithOptions(0x1000, 0x1003, &UcOptions{Count: uint64(n)}); err != nil {
+		b.Fatal(err)
+	}
+}
+
+func BenchmarkHookCode(b *testing.B) {
+	mu := makeLoop(b)
+	defer mu.Close()
+	count := 0
+	mu.HookAdd(HOOK_CODE, func(mu Unicorn, addr uint64, size uint32) {
+		count++
+	}, 1, 0)
+	b.ResetTimer()
+	benchHookCode(b, mu, b.N)
+}
+
+func BenchmarkHookCodeBatch(b *testing.B) {
+	mu := makeLoop(b)
+	defer mu.Close()
+	count := 0
+	mu.HookAddBatch(HOOK_CODE, func(mu Unicorn, events []CodeEvent) {
+		count += len(events)
+	}, 1, 0)
+	b.ResetTimer()
+	benchHookCode(b, mu, b.N)
+}
+
+// one engine per goroutine, 1000 instructions per op: with per-engine hook
+// tables this scales with the number of cores
+func BenchmarkHookCodeParallel(b *testing.B) {
+	b.RunParallel(func(pb *testing.PB) {
+		mu := makeLoop(b)
+		defer mu.Close()
+		count := 0
+		mu.HookAdd(HOOK_CODE, func(mu Unicorn, addr uint64, size uint32) {
+			count++
+		}, 1, 0)
+		for pb.Next() {
+			benchHookCode(b, mu, 1000)
+		}
+	})
+}
@@ -22,6 +22,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 package unicorn;
 
 import java.util.*;
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
 
 public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, SparcConst, MipsConst, X86Const {
 
@@ -281,14 +283,6 @@ public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, S
       }
    }
 
-/**
- * Write to register.
- *
- * @param  regid  Register ID that is to be modified.
- * @param  value  Number containing the new register value
- */
-   private native void reg_write_num(int regid, Number value) throws UnicornException;
-
 /**
  * Write to register.
  *
@@ -297,14 +291,6 @@ public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, S
  */
    private native void reg_write_mmr(int regid, X86_MMR value) throws UnicornException;
 
-/**
- * Read register value.
- *
- * @param regid  Register ID that is to be retrieved.
- * @return Number containing the requested register value.
- */
-   private native Number reg_read_num(int regid) throws UnicornException;
-
 /**
  * Read register value.
  *
@@ -426,7 +412,7 @@ public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, S
  */
    public void reg_write(int regid, Object value) throws UnicornException {
       if (value instanceof Number) {
-         reg_write_num(regid, (Number)value);
+         reg_write_long(regid, ((Number)value).longValue());
       }
       else if (arch == UC_ARCH_X86 && value instanceof X86_MMR) {
          if (regid >= UC_X86_REG_IDTR && regid <= UC_X86_REG_TR) {
@@ -461,10 +447,26 @@ public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, S
          return reg_read_mmr(regid);
       }
       else {
-         return reg_read_num(regid);
+         return reg_read_long(regid);
       }
    }
 
+/**
+ * Write to register, without boxing the value. For registers of up to 64 bits.
+ *
+ * @param  regid  Register ID that is to be modified.
+ * @param  value  The new register value
+ */
+   public native void reg_write_long(int regid, long value) throws UnicornException;
+
+/**
+ * Read register value, without boxing the result. For registers of up to 64 bits.
+ *
+ * @param regid  Register ID that is to be retrieved.
+ * @return The requested register value, zero-extended.
+ */
+   public native long reg_read_long(int regid) throws UnicornException;
+
 /**
  * Batch write register values. regids.length == vals.length or UC_ERR_ARG
  *
@@ -511,6 +513,56 @@ public class Unicorn implements UnicornConst, ArmConst, Arm64Const, M68kConst, S
  */
    public native byte[] mem_read(long address, long size) throws UnicornException;
 
+   private native void mem_write_direct(long address, ByteBuffer bytes, int offset, int size) throws UnicornException;
+
+   private native void mem_read_direct(long address, ByteBuffer bytes, int offset, int size) throws UnicornException;
+
+/**
+ * Write to memory from a buffer. bytes.remaining() bytes are written, starting at the
+ * buffer's position, which is then advanced past them. A direct buffer is passed to the
+ * engine without being copied to a Java array.
+ *
+ * @param  address  Start addres of the memory region to be written.
+ * @param  bytes    Buffer holding the values to be written into memory.
+ */
+   public void mem_write(long address, ByteBuffer bytes) throws UnicornException {
+      int pos = bytes.position();
+      int size = bytes.remaining();
+      if (bytes.isDirect()) {
+         mem_write_direct(address, bytes, pos, size);
+      }
+      else {
+         byte[] tmp = new byte[size];
+         bytes.duplicate().get(tmp);
+         mem_write(address, tmp);
+      }
+      bytes.position(pos + size);
+   }
+
+/**
+ * Read memory contents into a buffer. bytes.remaining() bytes are read to the buffer's
+ * position, which is then advanced past them. A direct buffer is filled by the engine
+ * without a Java array in between.
+ *
+ * @param address  Start addres of the memory region to be read.
+ * @param bytes    Buffer receiving the contents of the requested memory range.
+ * @throws ReadOnlyBufferException if bytes is read-only.
+ */
+   public void mem_read(long address, ByteBuffer bytes) throws UnicornException {
+      if (bytes.isReadOnly()) {
+         throw new ReadOnlyBufferException();
+      }
+      int pos = bytes.position();
+      int size = bytes.remaining();
+      if (bytes.isDirect()) {
+         mem_read_direct(address, bytes, pos, size);
+      }
+      else {
+         bytes.duplicate().put(mem_read(address, size));
+      }
+      bytes.position(pos + size);
+   }
+
 /**
  * Emulate machine code in a specific duration of time.
  *
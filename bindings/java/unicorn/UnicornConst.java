@@ -99,6 +99,14 @@ public interface UnicornConst {
    public static final int UC_QUERY_MODE = 1;
    public static final int UC_QUERY_PAGE_SIZE = 2;
    public static final int UC_QUERY_ARCH = 3;
+   public static final int UC_QUERY_MEMORY = 4;
+   public static final int UC_QUERY_TB_CACHE_HITS = 5;
+   public static final int UC_QUERY_TB_CACHE_MISSES = 6;
+   public static final int UC_QUERY_TB_HOT = 7;
+   public static final int UC_OPT_LOW_MEMORY = 1;
+   public static final int UC_OPT_PERF_MAP = 2;
+   public static final int UC_OPT_JITDUMP = 4;
+   public static final int UC_OPT_TB_COUNTS = 8;
 
    public static final int UC_PROT_NONE = 0;
    public static final int UC_PROT_READ = 1;
@@ -21,6 +21,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <sys/types.h>
 #include "unicorn/platform.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -28,38 +29,129 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include <unicorn/x86.h>
 #include "unicorn_Unicorn.h"
 
-//cache jmethodID values as we look them up
-static jmethodID invokeBlockCallbacks = 0;
-static jmethodID invokeInterruptCallbacks = 0;
-static jmethodID invokeCodeCallbacks = 0;
+//big enough for every register uc_reg_read() can write
+#define REG_SLOT (8 * sizeof(uint64_t))
 
-static jmethodID invokeEventMemCallbacks = 0;
-static jmethodID invokeReadCallbacks = 0;
-static jmethodID invokeWriteCallbacks = 0;
-static jmethodID invokeInCallbacks = 0;
-static jmethodID invokeOutCallbacks = 0;
-static jmethodID invokeSyscallCallbacks = 0;
+//class, method and field IDs, looked up once in JNI_OnLoad
+static jclass unicornClass;
+static jclass exceptionClass;
+static jclass mmrClass;
+static jclass memRegionClass;
+
+static jmethodID invokeBlockCallbacks;
+static jmethodID invokeInterruptCallbacks;
+static jmethodID invokeCodeCallbacks;
+
+static jmethodID invokeEventMemCallbacks;
+static jmethodID invokeReadCallbacks;
+static jmethodID invokeWriteCallbacks;
+static jmethodID invokeInCallbacks;
+static jmethodID invokeOutCallbacks;
+static jmethodID invokeSyscallCallbacks;
+
+static jmethodID mmrInit;
+static jmethodID memRegionInit;
+
+static jfieldID engField;
+static jfieldID mmrBase;
+static jfieldID mmrLimit;
+static jfieldID mmrFlags;
+static jfieldID mmrSelector;
 
 static JavaVM* cachedJVM;
 
+//native threads attached to run callbacks are detached when they exit
+static pthread_key_t detachKey;
+
+static void detachThread(void *jvm) {
+   (*(JavaVM *)jvm)->DetachCurrentThread((JavaVM *)jvm);
+}
+
+static jclass findClass(JNIEnv *env, const char *name) {
+   jclass clz = (*env)->FindClass(env, name);
+   if (clz == NULL) {
+      return NULL;
+   }
+   return (jclass)(*env)->NewGlobalRef(env, clz);
+}
+
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *jvm, void *reserved) {
+   JNIEnv *env;
    cachedJVM = jvm;
+   if ((*jvm)->GetEnv(jvm, (void **)&env, JNI_VERSION_1_6) != JNI_OK) {
+      return JNI_ERR;
+   }
+   if (pthread_key_create(&detachKey, detachThread) != 0) {
+      return JNI_ERR;
+   }
+
+   unicornClass = findClass(env, "unicorn/Unicorn");
+   exceptionClass = findClass(env, "unicorn/UnicornException");
+   mmrClass = findClass(env, "unicorn/X86_MMR");
+   memRegionClass = findClass(env, "unicorn/MemRegion");
+   if (!unicornClass || !exceptionClass || !mmrClass || !memRegionClass) {
+      return JNI_ERR;
+   }
+
+   invokeBlockCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeBlockCallbacks", "(JJI)V");
+   invokeInterruptCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeInterruptCallbacks", "(JI)V");
+   invokeCodeCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeCodeCallbacks", "(JJI)V");
+   invokeEventMemCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeEventMemCallbacks", "(JIJIJ)Z");
+   invokeReadCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeReadCallbacks", "(JJI)V");
+   invokeWriteCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeWriteCallbacks", "(JJIJ)V");
+   invokeInCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeInCallbacks", "(JII)I");
+   invokeOutCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeOutCallbacks", "(JIII)V");
+   invokeSyscallCallbacks = (*env)->GetStaticMethodID(env, unicornClass, "invokeSyscallCallbacks", "(J)V");
+
+   mmrInit = (*env)->GetMethodID(env, mmrClass, "<init>", "(JIIS)V");
+   memRegionInit = (*env)->GetMethodID(env, memRegionClass, "<init>", "(JJI)V");
+
+   engField = (*env)->GetFieldID(env, unicornClass, "eng", "J");
+   mmrBase = (*env)->GetFieldID(env, mmrClass, "base", "J");
+   mmrLimit = (*env)->GetFieldID(env, mmrClass, "limit", "I");
+   mmrFlags = (*env)->GetFieldID(env, mmrClass, "flags", "I");
+   mmrSelector = (*env)->GetFieldID(env, mmrClass, "selector", "S");
+
+   if ((*env)->ExceptionCheck(env)) {
+      return JNI_ERR;
+   }
    return JNI_VERSION_1_6;
 }
 
+//JNIEnv of the thread running a callback, or NULL if Java must not be
+//called: a callback that threw stops emulation, and its exception stays
+//pending until emu_start() returns to Java
+static JNIEnv *callbackEnv(void) {
+   JNIEnv *env;
+   if ((*cachedJVM)->GetEnv(cachedJVM, (void **)&env, JNI_VERSION_1_6) != JNI_OK) {
+      if ((*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL) != JNI_OK) {
+         return NULL;
+      }
+      pthread_setspecific(detachKey, cachedJVM);
+   }
+   if ((*env)->ExceptionCheck(env)) {
+      return NULL;
+   }
+   return env;
+}
+
+static void checkCallback(JNIEnv *env, uc_engine *eng) {
+   if ((*env)->ExceptionCheck(env)) {
+      uc_emu_stop(eng);
+   }
+}
+
 // Callback function for tracing code (UC_HOOK_CODE & UC_HOOK_BLOCK)
 // @address: address where the code is being executed
 // @size: size of machine instruction being executed
 // @user_data: user data passed to tracing APIs.
 static void cb_hookcode(uc_engine *eng, uint64_t address, uint32_t size, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
-   (*env)->CallStaticVoidMethod(env, clz, invokeCodeCallbacks, (jlong)eng, (jlong)address, (int)size);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   (*env)->CallStaticVoidMethod(env, unicornClass, invokeCodeCallbacks, (jlong)eng, (jlong)address, (int)size);
+   checkCallback(env, eng);
 }
 
 // Callback function for tracing code (UC_HOOK_CODE & UC_HOOK_BLOCK)
@@ -67,28 +159,24 @@ static void cb_hookcode(uc_engine *eng, uint64_t address, uint32_t size, void *u
 // @size: size of machine instruction being executed
 // @user_data: user data passed to tracing APIs.
 static void cb_hookblock(uc_engine *eng, uint64_t address, uint32_t size, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
-   (*env)->CallStaticVoidMethod(env, clz, invokeBlockCallbacks, (jlong)eng, (jlong)address, (int)size);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   (*env)->CallStaticVoidMethod(env, unicornClass, invokeBlockCallbacks, (jlong)eng, (jlong)address, (int)size);
+   checkCallback(env, eng);
 }
 
 // Callback function for tracing interrupts (for uc_hook_intr())
 // @intno: interrupt number
 // @user_data: user data passed to tracing APIs.
 static void cb_hookintr(uc_engine *eng, uint32_t intno, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
-   (*env)->CallStaticVoidMethod(env, clz, invokeInterruptCallbacks, (jlong)eng, (int)intno);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   (*env)->CallStaticVoidMethod(env, unicornClass, invokeInterruptCallbacks, (jlong)eng, (int)intno);
+   checkCallback(env, eng);
 }
 
 // Callback function for tracing IN instruction of X86
@@ -96,15 +184,13 @@ static void cb_hookintr(uc_engine *eng, uint32_t intno, void *user_data) {
 // @size: data size (1/2/4) to be read from this port
 // @user_data: user data passed to tracing APIs.
 static uint32_t cb_insn_in(uc_engine *eng, uint32_t port, int size, void *user_data) {
-   JNIEnv *env;
+   JNIEnv *env = callbackEnv();
    uint32_t res = 0;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   if (env == NULL) {
       return 0;
    }
-   res = (uint32_t)(*env)->CallStaticIntMethod(env, clz, invokeInCallbacks, (jlong)eng, (jint)port, (jint)size);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   res = (uint32_t)(*env)->CallStaticIntMethod(env, unicornClass, invokeInCallbacks, (jlong)eng, (jint)port, (jint)size);
+   checkCallback(env, eng);
    return res;
 }
 
@@ -113,26 +199,22 @@ static uint32_t cb_insn_in(uc_engine *eng, uint32_t port, int size, void *user_d
 // @size: data size (1/2/4) to be written to this port
 // @value: data value to be written to this port
 static void cb_insn_out(uc_engine *eng, uint32_t port, int size, uint32_t value, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
-   (*env)->CallStaticVoidMethod(env, clz, invokeOutCallbacks, (jlong)eng, (jint)port, (jint)size, (jint)value);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   (*env)->CallStaticVoidMethod(env, unicornClass, invokeOutCallbacks, (jlong)eng, (jint)port, (jint)size, (jint)value);
+   checkCallback(env, eng);
 }
 
 // x86's handler for SYSCALL/SYSENTER
 static void cb_insn_syscall(uc_engine *eng, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
-   (*env)->CallStaticVoidMethod(env, clz, invokeSyscallCallbacks, (jlong)eng);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   (*env)->CallStaticVoidMethod(env, unicornClass, invokeSyscallCallbacks, (jlong)eng);
+   checkCallback(env, eng);
 }
 
 // Callback function for hooking memory (UC_HOOK_MEM_*)
@@ -143,21 +225,19 @@ static void cb_insn_syscall(uc_engine *eng, void *user_data) {
 // @user_data: user data passed to tracing APIs
 static void cb_hookmem(uc_engine *eng, uc_mem_type type,
         uint64_t address, int size, int64_t value, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return;
    }
    switch (type) {
       case UC_MEM_READ:
-         (*env)->CallStaticVoidMethod(env, clz, invokeReadCallbacks, (jlong)eng, (jlong)address, (int)size);
+         (*env)->CallStaticVoidMethod(env, unicornClass, invokeReadCallbacks, (jlong)eng, (jlong)address, (int)size);
          break;
       case UC_MEM_WRITE:
-         (*env)->CallStaticVoidMethod(env, clz, invokeWriteCallbacks, (jlong)eng, (jlong)address, (int)size, (jlong)value);
+         (*env)->CallStaticVoidMethod(env, unicornClass, invokeWriteCallbacks, (jlong)eng, (jlong)address, (int)size, (jlong)value);
          break;
    }
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   checkCallback(env, eng);
 }
 
 // Callback function for handling memory events (for UC_HOOK_MEM_UNMAPPED)
@@ -169,55 +249,53 @@ static void cb_hookmem(uc_engine *eng, uc_mem_type type,
 // @return: return true to continue, or false to stop program (due to invalid memory).
 static bool cb_eventmem(uc_engine *eng, uc_mem_type type,
                         uint64_t address, int size, int64_t value, void *user_data) {
-   JNIEnv *env;
-   (*cachedJVM)->AttachCurrentThread(cachedJVM, (void **)&env, NULL);
-   jclass clz = (*env)->FindClass(env, "unicorn/Unicorn");
-   if ((*env)->ExceptionCheck(env)) {
+   JNIEnv *env = callbackEnv();
+   if (env == NULL) {
       return false;
    }
-   jboolean res = (*env)->CallStaticBooleanMethod(env, clz, invokeEventMemCallbacks, (jlong)eng, (int)type, (jlong)address, (int)size, (jlong)value);
-   (*cachedJVM)->DetachCurrentThread(cachedJVM);
+   jboolean res = (*env)->CallStaticBooleanMethod(env, unicornClass, invokeEventMemCallbacks, (jlong)eng, (int)type, (jlong)address, (int)size, (jlong)value);
+   checkCallback(env, eng);
    return res;
 }
 
 static void throwException(JNIEnv *env, uc_err err) {
    //throw exception
-   jclass clazz = (*env)->FindClass(env, "unicorn/UnicornException");
    if (err != UC_ERR_OK) {
       const char *msg = uc_strerror(err);
-      (*env)->ThrowNew(env, clazz, msg);
+      (*env)->ThrowNew(env, exceptionClass, msg);
    }
 }
 
 static uc_engine *getEngine(JNIEnv *env, jobject self) {
-   static int haveFid = 0;
-   static jfieldID fid;
-   if (haveFid == 0) {
-      //cache the field id
-      jclass clazz = (*env)->GetObjectClass(env, self);
-      fid = (*env)->GetFieldID(env, clazz, "eng", "J");
-      haveFid = 1;
+   return (uc_engine *)(*env)->GetLongField(env, self, engField);
+}
+
+//address of a direct buffer, or NULL with IllegalArgumentException pending
+//if the JVM does not give native code access to it
+static jbyte *getDirectBuffer(JNIEnv *env, jobject buffer) {
+   jbyte *array = (*env)->GetDirectBufferAddress(env, buffer);
+   if (array == NULL) {
+      jclass clz = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
+      if (clz != NULL) {
+         (*env)->ThrowNew(env, clz, "direct buffer address is not accessible");
+      }
    }
-   return (uc_engine *)(*env)->GetLongField(env, self, fid);
+   return array;
 }
 
 /*
  * Class:     unicorn_Unicorn
- * Method:    reg_write_num
- * Signature: (ILjava/lang/Number;)V
+ * Method:    reg_write_long
+ * Signature: (IJ)V
  */
-JNIEXPORT void JNICALL Java_unicorn_Unicorn_reg_1write_1num
-  (JNIEnv *env, jobject self, jint regid, jobject value) {
+JNIEXPORT void JNICALL Java_unicorn_Unicorn_reg_1write_1long
+  (JNIEnv *env, jobject self, jint regid, jlong value) {
    uc_engine *eng = getEngine(env, self);
+   //wide registers (x87, XMM/YMM, ARM64 Q/V) take their low 64 bits from value
+   uint64_t slot[REG_SLOT / sizeof(uint64_t)] = { 0 };
 
-   jclass clz = (*env)->FindClass(env, "java/lang/Number");
-   if ((*env)->ExceptionCheck(env)) {
-      return;
-   }
-
-   jmethodID longValue = (*env)->GetMethodID(env, clz, "longValue", "()J");
-   jlong longVal = (*env)->CallLongMethod(env, value, longValue);
-   uc_err err = uc_reg_write(eng, regid, &longVal);
+   slot[0] = (uint64_t)value;
+   uc_err err = uc_reg_write(eng, regid, slot);
    if (err != UC_ERR_OK) {
       throwException(env, err);
    }
@@ -233,22 +311,10 @@ JNIEXPORT void JNICALL Java_unicorn_Unicorn_reg_1write_1mmr
    uc_engine *eng = getEngine(env, self);
    uc_x86_mmr mmr;
 
-   jclass clz = (*env)->FindClass(env, "unicorn/X86_MMR");
-   if ((*env)->ExceptionCheck(env)) {
-      return;
-   }
-
-   jfieldID fid = (*env)->GetFieldID(env, clz, "base", "J");
-   mmr.base = (uint64_t)(*env)->GetLongField(env, value, fid);
-
-   fid = (*env)->GetFieldID(env, clz, "limit", "I");
-   mmr.limit = (uint32_t)(*env)->GetLongField(env, value, fid);
-
-   fid = (*env)->GetFieldID(env, clz, "flags", "I");
-   mmr.flags = (uint32_t)(*env)->GetLongField(env, value, fid);
-
-   fid = (*env)->GetFieldID(env, clz, "selector", "S");
-   mmr.selector = (uint16_t)(*env)->GetLongField(env, value, fid);
+   mmr.base = (uint64_t)(*env)->GetLongField(env, value, mmrBase);
+   mmr.limit = (uint32_t)(*env)->GetIntField(env, value, mmrLimit);
+   mmr.flags = (uint32_t)(*env)->GetIntField(env, value, mmrFlags);
+   mmr.selector = (uint16_t)(*env)->GetShortField(env, value, mmrSelector);
 
    uc_err err = uc_reg_write(eng, regid, &mmr);
    if (err != UC_ERR_OK) {
@@ -258,30 +324,21 @@ JNIEXPORT void JNICALL Java_unicorn_Unicorn_reg_1write_1mmr
 
 /*
  * Class:     unicorn_Unicorn
- * Method:    reg_read_num
- * Signature: (I)Ljava/lang/Number;
+ * Method:    reg_read_long
+ * Signature: (I)J
  */
-JNIEXPORT jobject JNICALL Java_unicorn_Unicorn_reg_1read_1num
+JNIEXPORT jlong JNICALL Java_unicorn_Unicorn_reg_1read_1long
   (JNIEnv *env, jobject self, jint regid) {
    uc_engine *eng = getEngine(env, self);
 
-   jclass clz = (*env)->FindClass(env, "java/lang/Long");
-   if ((*env)->ExceptionCheck(env)) {
-      return NULL;
-   }
-
-   jlong longVal;
-   uc_err err = uc_reg_read(eng, regid, &longVal);
+   //registers narrower than 64 bits only fill the low bytes, wider ones
+   //are truncated to them
+   uint64_t slot[REG_SLOT / sizeof(uint64_t)] = { 0 };
+   uc_err err = uc_reg_read(eng, regid, slot);
    if (err != UC_ERR_OK) {
       throwException(env, err);
    }
-
-   jmethodID cons = (*env)->GetMethodID(env, clz, "<init>", "(J)V");
-   jobject result = (*env)->NewObject(env, clz, cons, longVal);
-   if ((*env)->ExceptionCheck(env)) {
-      return NULL;
-   }
-   return result;
+   return (jlong)slot[0];
 }
 
 /*
@@ -293,19 +350,14 @@ JNIEXPORT jobject JNICALL Java_unicorn_Unicorn_reg_1read_1mmr
   (JNIEnv *env, jobject self, jint regid) {
    uc_engine *eng = getEngine(env, self);
 
-   jclass clz = (*env)->FindClass(env, "unicorn/X86_MMR");
-   if ((*env)->ExceptionCheck(env)) {
-      return NULL;
-   }
-
    uc_x86_mmr mmr;
    uc_err err = uc_reg_read(eng, regid, &mmr);
    if (err != UC_ERR_OK) {
       throwException(env, err);
+      return NULL;
    }
 
-   jmethodID cons = (*env)->GetMethodID(env, clz, "<init>", "(JIIS)V");
-   jobject result = (*env)->NewObject(env, clz, cons, mmr.base, mmr.limit, mmr.flags, mmr.selector);
+   jobject result = (*env)->NewObject(env, mmrClass, mmrInit, mmr.base, mmr.limit, mmr.flags, mmr.selector);
    if ((*env)->ExceptionCheck(env)) {
       return NULL;
    }
@@ -475,6 +527,42 @@ JNIEXPORT jbyteArray JNICALL Java_unicorn_Unicorn_mem_1read
    return bytes;
 }
 
+/*
+ * Class:     unicorn_Unicorn
+ * Method:    mem_write_direct
+ * Signature: (JLjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_unicorn_Unicorn_mem_1write_1direct
+  (JNIEnv *env, jobject self, jlong address, jobject buffer, jint offset, jint size) {
+   uc_engine *eng = getEngine(env, self);
+   jbyte *array = getDirectBuffer(env, buffer);
+   if (array == NULL) {
+      return;
+   }
+   uc_err err = uc_mem_write(eng, (uint64_t)address, array + offset, (size_t)size);
+   if (err != UC_ERR_OK) {
+      throwException(env, err);
+   }
+}
+
+/*
+ * Class:     unicorn_Unicorn
+ * Method:    mem_read_direct
+ * Signature: (JLjava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_unicorn_Unicorn_mem_1read_1direct
+  (JNIEnv *env, jobject self, jlong address, jobject buffer, jint offset, jint size) {
+   uc_engine *eng = getEngine(env, self);
+   jbyte *array = getDirectBuffer(env, buffer);
+   if (array == NULL) {
+      return;
+   }
+   uc_err err = uc_mem_read(eng, (uint64_t)address, array + offset, (size_t)size);
+   if (err != UC_ERR_OK) {
+      throwException(env, err);
+   }
+}
+
 /*
  * Class:     unicorn_Unicorn
  * Method:    emu_start
@@ -485,7 +573,8 @@ JNIEXPORT void JNICALL Java_unicorn_Unicorn_emu_1start
    uc_engine *eng = getEngine(env, self);
 
    uc_err err = uc_emu_start(eng, (uint64_t)begin, (uint64_t)until, (uint64_t)timeout, (size_t)count);
-   if (err != UC_ERR_OK) {
+   //an exception thrown by a callback stopped the run: let it propagate
+   if (err != UC_ERR_OK && !(*env)->ExceptionCheck(env)) {
       throwException(env, err);
    }
 }
@@ -516,9 +605,6 @@ JNIEXPORT jlong JNICALL Java_unicorn_Unicorn_registerHook__JI
    uc_err err = 0;
    switch (type) {
       case UC_HOOK_INTR:           // Hook all interrupt events
-         if (invokeInterruptCallbacks == 0) {
-            invokeInterruptCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeInterruptCallbacks", "(JI)V");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_hookintr, env, 1, 0);
          break;
       case UC_HOOK_MEM_FETCH_UNMAPPED:    // Hook for all invalid memory access events
@@ -527,9 +613,6 @@ JNIEXPORT jlong JNICALL Java_unicorn_Unicorn_registerHook__JI
       case UC_HOOK_MEM_FETCH_PROT:    // Hook for all invalid memory access events
       case UC_HOOK_MEM_READ_PROT:    // Hook for all invalid memory access events
       case UC_HOOK_MEM_WRITE_PROT:    // Hook for all invalid memory access events
-         if (invokeEventMemCallbacks == 0) {
-            invokeEventMemCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeEventMemCallbacks", "(JIJIJ)Z");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_eventmem, env, 1, 0);
          break;
    }
@@ -549,21 +632,15 @@ JNIEXPORT jlong JNICALL Java_unicorn_Unicorn_registerHook__JII
       case UC_HOOK_INSN:           // Hook a particular instruction
          switch (arg1) {
             case UC_X86_INS_OUT:
-               if (invokeOutCallbacks == 0) {
-                  invokeOutCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeOutCallbacks", "(JIII)V");
-               }
                err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_insn_out, env, 1, 0, arg1);
+               break;
             case UC_X86_INS_IN:
-               if (invokeInCallbacks == 0) {
-                  invokeInCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeInCallbacks", "(JII)I");
-               }
                err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_insn_in, env, 1, 0, arg1);
+               break;
             case UC_X86_INS_SYSENTER:
             case UC_X86_INS_SYSCALL:
-               if (invokeSyscallCallbacks == 0) {
-                  invokeSyscallCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeSyscallCallbacks", "(J)V");
-               }
                err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_insn_syscall, env, 1, 0, arg1);
+               break;
          }
          break;
    }
@@ -581,27 +658,15 @@ JNIEXPORT jlong JNICALL Java_unicorn_Unicorn_registerHook__JIJJ
    uc_err err = 0;
    switch (type) {
       case UC_HOOK_CODE:           // Hook a range of code
-         if (invokeCodeCallbacks == 0) {
-            invokeCodeCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeCodeCallbacks", "(JJI)V");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_hookcode, env, 1, 0, arg1, arg2);
          break;
       case UC_HOOK_BLOCK:          // Hook basic blocks
-         if (invokeBlockCallbacks == 0) {
-            invokeBlockCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeBlockCallbacks", "(JJI)V");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_hookblock, env, 1, 0, arg1, arg2);
          break;
       case UC_HOOK_MEM_READ:       // Hook all memory read events.
-         if (invokeReadCallbacks == 0) {
-            invokeReadCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeReadCallbacks", "(JJI)V");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_hookmem, env, 1, 0, arg1, arg2);
          break;
       case UC_HOOK_MEM_WRITE:      // Hook all memory write events.
-         if (invokeWriteCallbacks == 0) {
-            invokeWriteCallbacks = (*env)->GetStaticMethodID(env, clz, "invokeWriteCallbacks", "(JJIJ)V");
-         }
          err = uc_hook_add((uc_engine*)eng, &hh, (uc_hook_type)type, cb_hookmem, env, 1, 0, arg1, arg2);
          break;
    }
@@ -708,14 +773,9 @@ JNIEXPORT jobjectArray JNICALL Java_unicorn_Unicorn_mem_1regions
    if (err != UC_ERR_OK) {
       throwException(env, err);
    }
-   jclass clz = (*env)->FindClass(env, "unicorn/MemRegion");
-   if ((*env)->ExceptionCheck(env)) {
-      return NULL;
-   }
-   jobjectArray result = (*env)->NewObjectArray(env, (jsize)count, clz, NULL);
-   jmethodID cons = (*env)->GetMethodID(env, clz, "<init>", "(JJI)V");
+   jobjectArray result = (*env)->NewObjectArray(env, (jsize)count, memRegionClass, NULL);
    for (i = 0; i < count; i++) {
-      jobject mr = (*env)->NewObject(env, clz, cons, regions[i].begin, regions[i].end, regions[i].perms);
+      jobject mr = (*env)->NewObject(env, memRegionClass, memRegionInit, regions[i].begin, regions[i].end, regions[i].perms);
       (*env)->SetObjectArrayElement(env, result, (jsize)i, mr);
    }
    uc_free(regions);
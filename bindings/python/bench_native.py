@@ -0,0 +1,125 @@
+#!/usr/bin/env python
+# Compare the native fast paths (unicorn/_unicorn.c) with the ctypes ones.
+# Each workload runs once through ctypes and once through the native module.
+#
+# usage: bench_native.py [iterations]
+
+from __future__ import print_function
+import sys
+import time
+
+import unicorn
+import unicorn.unicorn as binding
+from unicorn import *
+from unicorn.x86_const import *
+
+ADDRESS = 0x10000
+
+# L: add eax, ecx; dec ecx; jnz L
+X86_CODE32 = b"\x01\xc8\x49\x75\xfb"
+
+REGS = [UC_X86_REG_EAX, UC_X86_REG_EBX, UC_X86_REG_ECX, UC_X86_REG_EDX,
+        UC_X86_REG_ESI, UC_X86_REG_EDI, UC_X86_REG_EBP, UC_X86_REG_ESP]
+
+
+def setup(iters):
+    mu = Uc(UC_ARCH_X86, UC_MODE_32)
+    mu.mem_map(ADDRESS, 0x1000)
+    mu.mem_write(ADDRESS, X86_CODE32)
+    mu.reg_write(UC_X86_REG_ECX, iters)
+    return mu
+
+
+def run(mu, iters):
+    # three instructions per iteration
+    mu.emu_start(ADDRESS, ADDRESS + len(X86_CODE32), 0, iters * 3)
+
+
+def hook_nop(uc, address, size, user_data):
+    pass
+
+
+def hook_reg(uc, address, size, user_data):
+    uc.reg_read(UC_X86_REG_ECX)
+
+
+# each returns (seconds, operations)
+
+def bench_code_hook(iters):
+    mu = setup(iters)
+    mu.hook_add(UC_HOOK_CODE, hook_nop)
+    t0 = time.time()
+    run(mu, iters)
+    return time.time() - t0, iters * 3
+
+
+def bench_code_hook_reg(iters):
+    mu = setup(iters)
+    mu.hook_add(UC_HOOK_CODE, hook_reg)
+    t0 = time.time()
+    run(mu, iters)
+    return time.time() - t0, iters * 3
+
+
+def bench_reg(iters):
+    mu = setup(iters)
+    t0 = time.time()
+    for i in range(iters):
+        mu.reg_write(UC_X86_REG_EAX, i)
+        mu.reg_read(UC_X86_REG_EAX)
+    return time.time() - t0, iters * 2
+
+
+def bench_reg_batch(iters):
+    mu = setup(iters)
+    values = list(range(len(REGS)))
+    t0 = time.time()
+    for i in range(iters):
+        mu.reg_write_batch(REGS, values)
+        mu.reg_read_batch(REGS)
+    return time.time() - t0, iters * 2
+
+
+def bench_mem(iters):
+    mu = setup(iters)
+    data = b"\x90" * 64
+    t0 = time.time()
+    for i in range(iters):
+        mu.mem_write(ADDRESS + 0x100, data)
+        mu.mem_read(ADDRESS + 0x100, 64)
+    return time.time() - t0, iters * 2
+
+
+BENCHES = [
+    ("code hook", bench_code_hook),
+    ("code hook + reg_read", bench_code_hook_reg),
+    ("reg_read/reg_write", bench_reg),
+    ("reg batch of 8", bench_reg_batch),
+    ("mem 64 bytes", bench_mem),
+]
+
+
+def main():
+    iters = int(sys.argv[1]) if len(sys.argv) > 1 else 200000
+    native = binding._native
+
+    if native is None:
+        print("unicorn._unicorn is not built, timing ctypes only")
+
+    print("%-22s %14s %14s %9s" % ("workload", "ctypes ns/op", "native ns/op", "speedup"))
+    for name, bench in BENCHES:
+        binding._native = None
+        t, ops = bench(iters)
+        slow = t * 1e9 / ops
+        if native is None:
+            print("%-22s %14.1f" % (name, slow))
+            continue
+
+        binding._native = native
+        t, ops = bench(iters)
+        fast = t * 1e9 / ops
+        print("%-22s %14.1f %14.1f %8.2fx" % (name, slow, fast, slow / fast))
+
+
+if __name__ == '__main__':
+    main()
@@ -10,7 +10,7 @@ import sys
 import platform
 
 from distutils import log
-from distutils.core import setup
+from distutils.core import setup, Extension
 from distutils.util import get_platform
 from distutils.command.build import build
 from distutils.command.sdist import sdist
@@ -270,6 +270,12 @@ setup(
         'Programming Language :: Python :: 3',
     ],
     requires=['ctypes'],
+    # optional fast paths for hooks, registers & memory; the binding falls
+    # back to ctypes when this cannot be compiled
+    ext_modules=[Extension('unicorn._unicorn',
+        sources=['unicorn/_unicorn.c'],
+        include_dirs=[os.path.join(BUILD_DIR, 'include')],
+        optional=True)],
     cmdclass=cmdclass,
     zip_safe=True,
     include_package_data=True,
@@ -0,0 +1,591 @@
+/* Unicorn Python bindings: native fast paths
+ *
+ * unicorn.py reaches the engine through ctypes, which marshals the
+ * arguments of every call through libffi and enters every hook callback
+ * through a CFUNCTYPE trampoline.  This optional module does the same work
+ * in C for the calls an analysis makes millions of times: hook dispatch,
+ * 64-bit register access, register batches and memory access.
+ *
+ * It does not link against libunicorn.  unicorn.py passes it the addresses
+ * of the functions in the library it loaded, so both talk to the same
+ * engine, and keeps using ctypes when the module is not built.
+ */
+
+#include <Python.h>
+#include <stddef.h>
+#include <string.h>
+#include <unicorn/unicorn.h>
+
+/* big enough for every register uc_reg_read() can write */
+#define REG_SLOT    (8 * sizeof(uint64_t))
+
+static struct api {
+    uc_err (*reg_read)(uc_engine *uc, int regid, void *value);
+    uc_err (*reg_write)(uc_engine *uc, int regid, const void *value);
+    uc_err (*reg_read_batch)(uc_engine *uc, int *regs, void **vals, int count);
+    uc_err (*reg_write_batch)(uc_engine *uc, int *regs, void *const *vals, int count);
+    uc_err (*mem_read)(uc_engine *uc, uint64_t address, void *bytes, size_t size);
+    uc_err (*mem_write)(uc_engine *uc, uint64_t address, const void *bytes, size_t size);
+    uc_err (*hook_add)(uc_engine *uc, uc_hook *hh, int type, void *callback,
+            void *user_data, uint64_t begin, uint64_t end, ...);
+} api;
+
+static const struct {
+    const char *name;
+    size_t offset;
+} api_names[] = {
+    { "uc_reg_read", offsetof(struct api, reg_read) },
+    { "uc_reg_write", offsetof(struct api, reg_write) },
+    { "uc_reg_read_batch", offsetof(struct api, reg_read_batch) },
+    { "uc_reg_write_batch", offsetof(struct api, reg_write_batch) },
+    { "uc_mem_read", offsetof(struct api, mem_read) },
+    { "uc_mem_write", offsetof(struct api, mem_write) },
+    { "uc_hook_add", offsetof(struct api, hook_add) },
+};
+
+static PyObject *UcError;
+
+static PyObject *raise_error(uc_err err)
+{
+    PyObject *exc = PyObject_CallFunction(UcError, "i", (int)err);
+
+    if (exc != NULL) {
+        PyErr_SetObject(UcError, exc);
+        Py_DECREF(exc);
+    }
+    return NULL;
+}
+
+static int to_u64(PyObject *o, uint64_t *value)
+{
+    PyObject *l = PyNumber_Long(o);
+
+    if (l == NULL)
+        return -1;
+    // wrap negative values, as ctypes.c_uint64() does
+    *value = PyLong_AsUnsignedLongLongMask(l);
+    Py_DECREF(l);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+#define ENGINE(h) ((uc_engine *)(uintptr_t)(h))
+
+static PyObject *native_bind(PyObject *self, PyObject *args)
+{
+    PyObject *error, *functions, *addr;
+    struct api bound;
+    void *p;
+    size_t i;
+
+    if (!PyArg_ParseTuple(args, "OO!", &error, &PyDict_Type, &functions))
+        return NULL;
+
+    for (i = 0; i < sizeof(api_names) / sizeof(api_names[0]); i++) {
+        addr = PyDict_GetItemString(functions, api_names[i].name);
+        if (addr == NULL) {
+            PyErr_Format(PyExc_KeyError, "%s", api_names[i].name);
+            return NULL;
+        }
+        p = PyLong_AsVoidPtr(addr);
+        if (p == NULL) {
+            if (!PyErr_Occurred())
+                PyErr_Format(PyExc_ValueError, "%s is NULL", api_names[i].name);
+            return NULL;
+        }
+        memcpy((char *)&bound + api_names[i].offset, &p, sizeof(p));
+    }
+
+    api = bound;
+    Py_INCREF(error);
+    Py_XDECREF(UcError);
+    UcError = error;
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *native_reg_read(PyObject *self, PyObject *args)
+{
+    unsigned long long uch;
+    uint64_t value[REG_SLOT / sizeof(uint64_t)] = { 0 };
+    int regid;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "Ki", &uch, &regid))
+        return NULL;
+
+    err = api.reg_read(ENGINE(uch), regid, value);
+    if (err != UC_ERR_OK)
+        return raise_error(err);
+
+    return PyLong_FromUnsignedLongLong(value[0]);
+}
+
+static PyObject *native_reg_write(PyObject *self, PyObject *args)
+{
+    unsigned long long uch;
+    uint64_t value[REG_SLOT / sizeof(uint64_t)] = { 0 };
+    PyObject *o;
+    int regid;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KiO", &uch, &regid, &o))
+        return NULL;
+    if (to_u64(o, &value[0]) < 0)
+        return NULL;
+
+    err = api.reg_write(ENGINE(uch), regid, value);
+    if (err != UC_ERR_OK)
+        return raise_error(err);
+
+    Py_RETURN_NONE;
+}
+
+// register ids of @seq and a zeroed REG_SLOT per register; the caller frees
+// both with PyMem_Free()
+static int batch_alloc(PyObject *seq, int **regs, void ***vals)
+{
+    Py_ssize_t i, count = PySequence_Fast_GET_SIZE(seq);
+    char *slots;
+    long id;
+
+    *regs = PyMem_Malloc(count * sizeof(int));
+    *vals = PyMem_Malloc(count * (sizeof(void *) + REG_SLOT));
+    if (*regs == NULL || *vals == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    slots = (char *)(*vals + count);
+    memset(slots, 0, count * REG_SLOT);
+    for (i = 0; i < count; i++) {
+        id = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+        if (id == -1 && PyErr_Occurred())
+            return -1;
+        (*regs)[i] = (int)id;
+        (*vals)[i] = slots + i * REG_SLOT;
+    }
+
+    return 0;
+}
+
+static PyObject *native_reg_read_batch(PyObject *self, PyObject *args)
+{
+    unsigned long long uch;
+    PyObject *ids, *seq, *result = NULL, *v;
+    int *regs = NULL;
+    void **vals = NULL;
+    Py_ssize_t i, count;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KO", &uch, &ids))
+        return NULL;
+    seq = PySequence_Fast(ids, "register ids must be a sequence");
+    if (seq == NULL)
+        return NULL;
+    count = PySequence_Fast_GET_SIZE(seq);
+
+    if (batch_alloc(seq, &regs, &vals) < 0)
+        goto out;
+
+    err = api.reg_read_batch(ENGINE(uch), regs, vals, (int)count);
+    if (err != UC_ERR_OK) {
+        raise_error(err);
+        goto out;
+    }
+
+    result = PyList_New(count);
+    if (result == NULL)
+        goto out;
+    for (i = 0; i < count; i++) {
+        v = PyLong_FromUnsignedLongLong(*(uint64_t *)vals[i]);
+        if (v == NULL) {
+            Py_CLEAR(result);
+            goto out;
+        }
+        PyList_SET_ITEM(result, i, v);
+    }
+
+out:
+    PyMem_Free(regs);
+    PyMem_Free(vals);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *native_reg_write_batch(PyObject *self, PyObject *args)
+{
+    unsigned long long uch;
+    PyObject *ids, *values, *seq, *vseq = NULL, *result = NULL;
+    int *regs = NULL;
+    void **vals = NULL;
+    Py_ssize_t i, count;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KOO", &uch, &ids, &values))
+        return NULL;
+    seq = PySequence_Fast(ids, "register ids must be a sequence");
+    if (seq == NULL)
+        return NULL;
+    vseq = PySequence_Fast(values, "register values must be a sequence");
+    if (vseq == NULL)
+        goto out;
+    count = PySequence_Fast_GET_SIZE(seq);
+    if (PySequence_Fast_GET_SIZE(vseq) != count) {
+        PyErr_SetString(PyExc_ValueError, "register ids and values differ in length");
+        goto out;
+    }
+
+    if (batch_alloc(seq, &regs, &vals) < 0)
+        goto out;
+    for (i = 0; i < count; i++) {
+        if (to_u64(PySequence_Fast_GET_ITEM(vseq, i), (uint64_t *)vals[i]) < 0)
+            goto out;
+    }
+
+    err = api.reg_write_batch(ENGINE(uch), regs, vals, (int)count);
+    if (err != UC_ERR_OK) {
+        raise_error(err);
+        goto out;
+    }
+
+    Py_INCREF(Py_None);
+    result = Py_None;
+
+out:
+    PyMem_Free(regs);
+    PyMem_Free(vals);
+    Py_XDECREF(vseq);
+    Py_DECREF(seq);
+    return result;
+}
+
+static PyObject *native_mem_read(PyObject *self, PyObject *args)
+{
+    unsigned long long uch, address;
+    Py_ssize_t size;
+    PyObject *data;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KKn", &uch, &address, &size))
+        return NULL;
+
+    // filled in place, without the ctypes string buffer and its copy
+    data = PyByteArray_FromStringAndSize(NULL, size);
+    if (data == NULL)
+        return NULL;
+
+    err = api.mem_read(ENGINE(uch), address, PyByteArray_AS_STRING(data), size);
+    if (err != UC_ERR_OK) {
+        Py_DECREF(data);
+        return raise_error(err);
+    }
+
+    return data;
+}
+
+static PyObject *native_mem_write(PyObject *self, PyObject *args)
+{
+    unsigned long long uch, address;
+    Py_buffer data;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KKs*", &uch, &address, &data))
+        return NULL;
+
+    err = api.mem_write(ENGINE(uch), address, data.buf, data.len);
+    PyBuffer_Release(&data);
+    if (err != UC_ERR_OK)
+        return raise_error(err);
+
+    Py_RETURN_NONE;
+}
+
+/* A registered callback.  Its address is the user_data of the engine hook,
+   and unicorn.py keeps it alive for as long as the Uc object.  */
+typedef struct {
+    PyObject_HEAD
+    PyObject *uc;           // passed to the callback as its first argument
+    PyObject *callback;
+    PyObject *user_data;
+} Hook;
+
+static int hook_traverse(Hook *h, visitproc visit, void *arg)
+{
+    Py_VISIT(h->uc);
+    Py_VISIT(h->callback);
+    Py_VISIT(h->user_data);
+    return 0;
+}
+
+static int hook_clear(Hook *h)
+{
+    Py_CLEAR(h->uc);
+    Py_CLEAR(h->callback);
+    Py_CLEAR(h->user_data);
+    return 0;
+}
+
+static void hook_dealloc(Hook *h)
+{
+    PyObject_GC_UnTrack(h);
+    hook_clear(h);
+    PyObject_GC_Del(h);
+}
+
+static PyTypeObject HookType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "unicorn._unicorn.Hook",                    /* tp_name */
+    sizeof(Hook),                               /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)hook_dealloc,                   /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_compare */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,    /* tp_flags */
+    "callback registered by Uc.hook_add()",     /* tp_doc */
+    (traverseproc)hook_traverse,                /* tp_traverse */
+    (inquiry)hook_clear,                        /* tp_clear */
+};
+
+/* The trampolines below run on the emulation thread, which ctypes let go
+   of the GIL in uc_emu_start().  As with ctypes callbacks, an exception is
+   reported and emulation goes on.  */
+
+static PyObject *hook_call(Hook *h, const char *format, ...)
+{
+    PyObject *args, *result;
+    va_list va;
+
+    if (h->callback == NULL)
+        return NULL;
+
+    va_start(va, format);
+    args = Py_VaBuildValue(format, va);
+    va_end(va);
+    if (args == NULL) {
+        PyErr_WriteUnraisable(h->callback);
+        return NULL;
+    }
+
+    result = PyObject_Call(h->callback, args, NULL);
+    Py_DECREF(args);
+    if (result == NULL)
+        PyErr_WriteUnraisable(h->callback);
+
+    return result;
+}
+
+static void hook_code(uc_engine *uc, uint64_t address, uint32_t size, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Py_XDECREF(hook_call(h, "(OKIO)", h->uc, (unsigned long long)address, size, h->user_data));
+    PyGILState_Release(gil);
+}
+
+static bool hook_mem_invalid(uc_engine *uc, uc_mem_type type, uint64_t address,
+        int size, int64_t value, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    PyObject *r;
+    bool handled = false;
+
+    r = hook_call(h, "(OiKiLO)", h->uc, (int)type, (unsigned long long)address,
+            size, (long long)value, h->user_data);
+    if (r != NULL) {
+        handled = PyObject_IsTrue(r) == 1;
+        Py_DECREF(r);
+    }
+    PyGILState_Release(gil);
+
+    return handled;
+}
+
+static void hook_mem_access(uc_engine *uc, uc_mem_type type, uint64_t address,
+        int size, int64_t value, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Py_XDECREF(hook_call(h, "(OiKiLO)", h->uc, (int)type, (unsigned long long)address,
+            size, (long long)value, h->user_data));
+    PyGILState_Release(gil);
+}
+
+static void hook_intr(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Py_XDECREF(hook_call(h, "(OIO)", h->uc, intno, h->user_data));
+    PyGILState_Release(gil);
+}
+
+static uint32_t hook_insn_in(uc_engine *uc, uint32_t port, int size, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+    uint64_t value = 0;
+    PyObject *r;
+
+    r = hook_call(h, "(OIiO)", h->uc, port, size, h->user_data);
+    if (r != NULL) {
+        if (to_u64(r, &value) < 0) {
+            PyErr_WriteUnraisable(h->callback);
+            value = 0;
+        }
+        Py_DECREF(r);
+    }
+    PyGILState_Release(gil);
+
+    return (uint32_t)value;
+}
+
+static void hook_insn_out(uc_engine *uc, uint32_t port, int size, uint32_t value, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Py_XDECREF(hook_call(h, "(OIiIO)", h->uc, port, size, value, h->user_data));
+    PyGILState_Release(gil);
+}
+
+static void hook_insn_syscall(uc_engine *uc, void *user_data)
+{
+    Hook *h = user_data;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    Py_XDECREF(hook_call(h, "(OO)", h->uc, h->user_data));
+    PyGILState_Release(gil);
+}
+
+// (handle, Hook), picking the trampoline the way Uc.hook_add() picks a
+// CFUNCTYPE
+static PyObject *native_hook_add(PyObject *self, PyObject *args)
+{
+    unsigned long long uch, begin, end;
+    PyObject *uc, *callback, *user_data;
+    int type, arg1;
+    void *fn = NULL;
+    uc_hook hh;
+    Hook *h;
+    uc_err err;
+
+    if (!PyArg_ParseTuple(args, "KiOOOKKi", &uch, &type, &uc, &callback,
+                &user_data, &begin, &end, &arg1))
+        return NULL;
+
+    if (type == UC_HOOK_INSN) {
+        switch (arg1) {
+            case UC_X86_INS_IN:
+                fn = (void *)hook_insn_in;
+                break;
+            case UC_X86_INS_OUT:
+                fn = (void *)hook_insn_out;
+                break;
+            case UC_X86_INS_SYSCALL:
+            case UC_X86_INS_SYSENTER:
+                fn = (void *)hook_insn_syscall;
+                break;
+            default:
+                return raise_error(UC_ERR_HOOK);
+        }
+    } else if (type == UC_HOOK_INTR) {
+        fn = (void *)hook_intr;
+    } else if (type == UC_HOOK_BLOCK || type == UC_HOOK_CODE) {
+        fn = (void *)hook_code;
+    } else if (type & (UC_HOOK_MEM_READ_UNMAPPED | UC_HOOK_MEM_WRITE_UNMAPPED |
+                UC_HOOK_MEM_FETCH_UNMAPPED | UC_HOOK_MEM_READ_PROT |
+                UC_HOOK_MEM_WRITE_PROT | UC_HOOK_MEM_FETCH_PROT)) {
+        fn = (void *)hook_mem_invalid;
+    } else {
+        fn = (void *)hook_mem_access;
+    }
+
+    h = PyObject_GC_New(Hook, &HookType);
+    if (h == NULL)
+        return NULL;
+    Py_INCREF(uc);
+    h->uc = uc;
+    Py_INCREF(callback);
+    h->callback = callback;
+    Py_INCREF(user_data);
+    h->user_data = user_data;
+    PyObject_GC_Track(h);
+
+    if (type == UC_HOOK_INSN)
+        err = api.hook_add(ENGINE(uch), &hh, type, fn, h, begin, end, arg1);
+    else
+        err = api.hook_add(ENGINE(uch), &hh, type, fn, h, begin, end);
+    if (err != UC_ERR_OK) {
+        Py_DECREF(h);
+        return raise_error(err);
+    }
+
+    return Py_BuildValue("(nN)", (Py_ssize_t)hh, (PyObject *)h);
+}
+
+static PyMethodDef native_methods[] = {
+    { "bind", native_bind, METH_VARARGS,
+        "bind(UcError, {name: address}): use the engine functions at these addresses" },
+    { "reg_read", native_reg_read, METH_VARARGS,
+        "reg_read(uch, reg_id) -> int" },
+    { "reg_write", native_reg_write, METH_VARARGS,
+        "reg_write(uch, reg_id, value)" },
+    { "reg_read_batch", native_reg_read_batch, METH_VARARGS,
+        "reg_read_batch(uch, reg_ids) -> [int]" },
+    { "reg_write_batch", native_reg_write_batch, METH_VARARGS,
+        "reg_write_batch(uch, reg_ids, values)" },
+    { "mem_read", native_mem_read, METH_VARARGS,
+        "mem_read(uch, address, size) -> bytearray" },
+    { "mem_write", native_mem_write, METH_VARARGS,
+        "mem_write(uch, address, data)" },
+    { "hook_add", native_hook_add, METH_VARARGS,
+        "hook_add(uch, htype, uc, callback, user_data, begin, end, arg1) -> (handle, Hook)" },
+    { NULL, NULL, 0, NULL }
+};
+
+#define MODULE_DOC "Native fast paths for the Unicorn Python bindings"
+
+#if PY_MAJOR_VERSION >= 3
+
+static struct PyModuleDef native_module = {
+    PyModuleDef_HEAD_INIT,
+    "_unicorn",
+    MODULE_DOC,
+    -1,
+    native_methods,
+};
+
+PyMODINIT_FUNC PyInit__unicorn(void)
+{
+    if (PyType_Ready(&HookType) < 0)
+        return NULL;
+
+    return PyModule_Create(&native_module);
+}
+
+#else
+
+PyMODINIT_FUNC init_unicorn(void)
+{
+    if (PyType_Ready(&HookType) < 0)
+        return;
+
+    Py_InitModule3("_unicorn", native_methods, MODULE_DOC);
+}
+
+#endif
@@ -124,8 +124,11 @@ _setup_prototype(_uc, "uc_strerror", ctypes.c_char_p, ucerr)
 _setup_prototype(_uc, "uc_errno", ucerr, uc_engine)
 _setup_prototype(_uc, "uc_reg_read", ucerr, uc_engine, ctypes.c_int, ctypes.c_void_p)
 _setup_prototype(_uc, "uc_reg_write", ucerr, uc_engine, ctypes.c_int, ctypes.c_void_p)
+_setup_prototype(_uc, "uc_reg_read_batch", ucerr, uc_engine, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_void_p), ctypes.c_int)
+_setup_prototype(_uc, "uc_reg_write_batch", ucerr, uc_engine, ctypes.POINTER(ctypes.c_int), ctypes.POINTER(ctypes.c_void_p), ctypes.c_int)
 _setup_prototype(_uc, "uc_mem_read", ucerr, uc_engine, ctypes.c_uint64, ctypes.POINTER(ctypes.c_char), ctypes.c_size_t)
 _setup_prototype(_uc, "uc_mem_write", ucerr, uc_engine, ctypes.c_uint64, ctypes.POINTER(ctypes.c_char), ctypes.c_size_t)
+_setup_prototype(_uc, "uc_mem_ptr", ucerr, uc_engine, ctypes.c_uint64, ctypes.c_size_t, ctypes.POINTER(ctypes.c_void_p))
 _setup_prototype(_uc, "uc_emu_start", ucerr, uc_engine, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_size_t)
 _setup_prototype(_uc, "uc_emu_stop", ucerr, uc_engine)
 _setup_prototype(_uc, "uc_hook_del", ucerr, uc_engine, uc_hook_h)
@@ -175,6 +178,40 @@ class UcError(Exception):
         return _uc.uc_strerror(self.errno).decode('ascii')
 
 
+# The optional native module (unicorn/_unicorn.c) takes over hook dispatch,
+# 64-bit register access and memory access from ctypes.  It calls the
+# functions of the library loaded above.  Set _native to None to compare.
+try:
+    from . import _unicorn as _native
+except ImportError:
+    _native = None
+
+if _native is not None:
+    _native.bind(UcError, dict(
+        (name, ctypes.cast(getattr(_uc, name), ctypes.c_void_p).value)
+        for name in ("uc_reg_read", "uc_reg_write", "uc_reg_read_batch",
+                     "uc_reg_write_batch", "uc_mem_read", "uc_mem_write",
+                     "uc_hook_add")))
+
+# instructions the native module has trampolines for
+_native_insns = (x86_const.UC_X86_INS_IN, x86_const.UC_X86_INS_OUT,
+                 x86_const.UC_X86_INS_SYSCALL, x86_const.UC_X86_INS_SYSENTER)
+
+# registers that do not fit in 64 bits, read and written through structures
+_wide_regs = {
+    uc.UC_ARCH_X86: frozenset(
+        [x86_const.UC_X86_REG_IDTR, x86_const.UC_X86_REG_GDTR,
+         x86_const.UC_X86_REG_LDTR, x86_const.UC_X86_REG_TR,
+         x86_const.UC_X86_REG_MSR] +
+        list(range(x86_const.UC_X86_REG_FP0, x86_const.UC_X86_REG_FP0+8)) +
+        list(range(x86_const.UC_X86_REG_XMM0, x86_const.UC_X86_REG_XMM0+8)) +
+        list(range(x86_const.UC_X86_REG_YMM0, x86_const.UC_X86_REG_YMM0+8))),
+    uc.UC_ARCH_ARM64: frozenset(
+        list(range(arm64_const.UC_ARM64_REG_Q0, arm64_const.UC_ARM64_REG_Q31+1)) +
+        list(range(arm64_const.UC_ARM64_REG_V0, arm64_const.UC_ARM64_REG_V31+1))),
+}
+
+
 # return the core's version
 def uc_version():
     major = ctypes.c_int()
@@ -292,10 +329,14 @@ class Uc(object):
         if status != uc.UC_ERR_OK:
             self._uch = None
             raise UcError(status)
+        self._h = self._uch.value
+        self._wide_regs = _wide_regs.get(arch, frozenset())
         # internal mapping table to save callback & userdata
         self._callbacks = {}
         self._ctype_cbs = {}
         self._callback_count = 0
+        # (address, size, weakref to buffer) of each mem_view()
+        self._views = []
         self._cleanup.register(self)
 
     @staticmethod
@@ -322,6 +363,9 @@ class Uc(object):
 
     # return the value of a register
     def reg_read(self, reg_id, opt=None):
+        if _native is not None and reg_id not in self._wide_regs:
+            return _native.reg_read(self._h, reg_id)
+
         if self._arch == uc.UC_ARCH_X86:
             if reg_id in [x86_const.UC_X86_REG_IDTR, x86_const.UC_X86_REG_GDTR, x86_const.UC_X86_REG_LDTR, x86_const.UC_X86_REG_TR]:
                 reg = uc_x86_mmr()
@@ -374,6 +418,9 @@ class Uc(object):
 
     # write to a register
     def reg_write(self, reg_id, value):
+        if _native is not None and reg_id not in self._wide_regs:
+            return _native.reg_write(self._h, reg_id, value)
+
         reg = None
 
         if self._arch == uc.UC_ARCH_X86:
@@ -417,6 +464,39 @@ class Uc(object):
         if status != uc.UC_ERR_OK:
             raise UcError(status)
 
+    # return the values of several registers, none wider than 64 bits
+    def reg_read_batch(self, reg_ids):
+        if self._wide_regs.intersection(reg_ids):
+            raise UcError(uc.UC_ERR_ARG)
+        if _native is not None:
+            return _native.reg_read_batch(self._h, reg_ids)
+
+        count = len(reg_ids)
+        regs = (ctypes.c_int * count)(*reg_ids)
+        vals = (ctypes.c_uint64 * count)()
+        ptrs = (ctypes.c_void_p * count)(*[ctypes.addressof(vals) + 8 * i for i in range(count)])
+        status = _uc.uc_reg_read_batch(self._uch, regs, ptrs, count)
+        if status != uc.UC_ERR_OK:
+            raise UcError(status)
+        return list(vals)
+
+    # write to several registers, none wider than 64 bits
+    def reg_write_batch(self, reg_ids, values):
+        if self._wide_regs.intersection(reg_ids):
+            raise UcError(uc.UC_ERR_ARG)
+        if _native is not None:
+            return _native.reg_write_batch(self._h, reg_ids, values)
+
+        count = len(reg_ids)
+        if len(values) != count:
+            raise UcError(uc.UC_ERR_ARG)
+        regs = (ctypes.c_int * count)(*reg_ids)
+        vals = (ctypes.c_uint64 * count)(*[v & 0xffffffffffffffff for v in values])
+        ptrs = (ctypes.c_void_p * count)(*[ctypes.addressof(vals) + 8 * i for i in range(count)])
+        status = _uc.uc_reg_write_batch(self._uch, regs, ptrs, count)
+        if status != uc.UC_ERR_OK:
+            raise UcError(status)
+
     # read from MSR - X86 only
     def msr_read(self, msr_id):
         return self.reg_read(x86_const.UC_X86_REG_MSR, msr_id)
@@ -427,6 +507,9 @@ class Uc(object):
 
     # read data from memory
     def mem_read(self, address, size):
+        if _native is not None:
+            return _native.mem_read(self._h, address, size)
+
         data = ctypes.create_string_buffer(size)
         status = _uc.uc_mem_read(self._uch, address, data, size)
         if status != uc.UC_ERR_OK:
@@ -435,10 +518,48 @@ class Uc(object):
 
     # write to memory
     def mem_write(self, address, data):
+        if _native is not None:
+            return _native.mem_write(self._h, address, data)
+
         status = _uc.uc_mem_write(self._uch, address, data, len(data))
         if status != uc.UC_ERR_OK:
             raise UcError(status)
 
+    # return a writable memoryview of guest memory, without copying.
+    # the range must lie inside one region of mem_map() or mem_map_ptr().
+    # accesses through the view bypass hooks & permissions, and do not
+    # invalidate translated code.
+    def mem_view(self, address, size):
+        ptr = ctypes.c_void_p()
+        status = _uc.uc_mem_ptr(self._uch, address, size, ctypes.byref(ptr))
+        if status != uc.UC_ERR_OK:
+            raise UcError(status)
+
+        buf = (ctypes.c_ubyte * size).from_address(ptr.value)
+        # the engine, and so its memory, lives as long as any view of it
+        buf._uc = self
+        self._views.append((address, size, weakref.ref(buf)))
+
+        view = memoryview(buf)
+        if hasattr(view, 'cast'):
+            view = view.cast('B')
+        return view
+
+    # unmapping or protecting any part of a region can move all of it, so
+    # refuse while a view, or anything made from one, points into it
+    def _check_views(self, address, size):
+        self._views = [v for v in self._views if v[2]() is not None]
+        if not self._views or size == 0:
+            return
+
+        last = address + size - 1
+        for (begin, end, _perms) in self.mem_regions():
+            if begin > last or end < address:
+                continue
+            for (vaddr, vsize, _buf) in self._views:
+                if vsize and vaddr <= end and vaddr + vsize - 1 >= begin:
+                    raise BufferError("memory at 0x%x is in use by mem_view()" % vaddr)
+
     # map a range of memory
     def mem_map(self, address, size, perms=uc.UC_PROT_ALL):
         status = _uc.uc_mem_map(self._uch, address, size, perms)
@@ -453,12 +574,14 @@ class Uc(object):
 
     # unmap a range of memory
     def mem_unmap(self, address, size):
+        self._check_views(address, size)
         status = _uc.uc_mem_unmap(self._uch, address, size)
         if status != uc.UC_ERR_OK:
             raise UcError(status)
 
     # protect a range of memory
     def mem_protect(self, address, size, perms=uc.UC_PROT_ALL):
+        self._check_views(address, size)
         status = _uc.uc_mem_protect(self._uch, address, size, perms)
         if status != uc.UC_ERR_OK:
             raise UcError(status)
@@ -508,6 +631,13 @@ class Uc(object):
 
     # add a hook
     def hook_add(self, htype, callback, user_data=None, begin=1, end=0, arg1=0):
+        if _native is not None and (htype != uc.UC_HOOK_INSN or arg1 in _native_insns):
+            h, hook = _native.hook_add(self._h, htype, self, callback, user_data, begin, end, arg1)
+            # keep the callback alive, as for the ctypes functions below
+            self._callback_count += 1
+            self._ctype_cbs[self._callback_count] = hook
+            return h
+
         _h2 = uc_hook_h()
 
         # save callback & user_data
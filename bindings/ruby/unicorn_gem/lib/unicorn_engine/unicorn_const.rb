@@ -97,6 +97,14 @@ module UnicornEngine
 	UC_QUERY_MODE = 1
 	UC_QUERY_PAGE_SIZE = 2
 	UC_QUERY_ARCH = 3
+	UC_QUERY_MEMORY = 4
+	UC_QUERY_TB_CACHE_HITS = 5
+	UC_QUERY_TB_CACHE_MISSES = 6
+	UC_QUERY_TB_HOT = 7
+	UC_OPT_LOW_MEMORY = 1
+	UC_OPT_PERF_MAP = 2
+	UC_OPT_JITDUMP = 4
+	UC_OPT_TB_COUNTS = 8
 
 	UC_PROT_NONE = 0
 	UC_PROT_READ = 1
@@ -46,6 +46,9 @@ typedef struct RAMList {
     RAMBlock *mru_block;
     QTAILQ_HEAD(, RAMBlock) blocks;
     uint32_t version;
+    ram_addr_t last_offset;     /* end of the highest block */
+    ram_addr_t used;            /* sum of all block lengths */
+    ram_addr_t dirty_pages;     /* pages covered by dirty_memory[] */
 } RAMList;
 
 #endif
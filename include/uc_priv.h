@@ -49,6 +49,9 @@ typedef int (*reg_write_t)(struct uc_struct *uc, unsigned int *regs, void *const
 
 typedef void (*reg_reset_t)(struct uc_struct *uc);
 
+// pointer to a register inside CPUArchState, or NULL; for uc_reg_ptr()
+typedef void *(*reg_ptr_t)(struct uc_struct *uc, unsigned int regid, size_t *size);
+
 typedef bool (*uc_write_mem_t)(AddressSpace *as, hwaddr addr, const uint8_t *buf, int len);
 
 typedef bool (*uc_read_mem_t)(AddressSpace *as, hwaddr addr, uint8_t *buf, int len);
@@ -62,16 +65,34 @@ typedef bool (*uc_args_tcg_enable_t)(struct uc_struct*);
 
 typedef void (*uc_args_uc_long_t)(struct uc_struct*, unsigned long);
 
+typedef size_t (*uc_args_size_uc_t)(struct uc_struct*);
+
+typedef uc_err (*uc_args_uc_range_t)(struct uc_struct*, uint64_t begin, uint64_t end);
+
 typedef void (*uc_args_uc_u64_t)(struct uc_struct *, uint64_t addr);
 
+typedef uint64_t (*uc_args_uc_pc_t)(struct uc_struct *);
+
+typedef bool (*uc_prof_resolve_t)(struct uc_struct *, uintptr_t host_pc, uint64_t *pc);
+
 typedef MemoryRegion* (*uc_args_uc_ram_size_t)(struct uc_struct*,  hwaddr begin, size_t size, uint32_t perms);
 
 typedef MemoryRegion* (*uc_args_uc_ram_size_ptr_t)(struct uc_struct*,  hwaddr begin, size_t size, uint32_t perms, void *ptr);
 
+typedef MemoryRegion* (*uc_args_uc_ram_file_t)(struct uc_struct*,  hwaddr begin, size_t size, uint32_t perms, int fd, uint64_t offset);
+
+typedef MemoryRegion* (*uc_args_uc_ram_lazy_t)(struct uc_struct*,  hwaddr begin, size_t size, uint32_t perms,
+        uc_cb_page_provider_t provider, void *user_data);
+
+typedef MemoryRegion* (*uc_args_uc_mmio_t)(struct uc_struct*,  hwaddr begin, size_t size,
+        uc_cb_mmio_read_t read_cb, uc_cb_mmio_write_t write_cb, void *user_data);
+
 typedef void (*uc_mem_unmap_t)(struct uc_struct*, MemoryRegion *mr);
 
 typedef void (*uc_readonly_mem_t)(MemoryRegion *mr, bool readonly);
 
+typedef void *(*uc_get_ram_ptr_t)(MemoryRegion *mr);
+
 // which interrupt should make emulation stop?
 typedef bool (*uc_args_int_t)(int intno);
 
@@ -128,6 +149,9 @@ enum uc_hook_idx {
     ((((addr) >= (hh)->begin && (addr) <= (hh)->end) \
          || (hh)->begin > (hh)->end))
 
+// count a callback for uc_stats_read(), just before calling it
+#define HOOK_COUNT(uc, idx) ((uc)->stats.hook_calls[idx##_IDX]++)
+
 #define HOOK_EXISTS(uc, idx) ((uc)->hook[idx##_IDX].head != NULL)
 #define HOOK_EXISTS_BOUNDED(uc, idx, addr) _hook_exists_bounded((uc)->hook[idx##_IDX].head, addr)
 
@@ -153,6 +177,7 @@ struct uc_struct {
     reg_read_t reg_read;
     reg_write_t reg_write;
     reg_reset_t reg_reset;
+    reg_ptr_t reg_ptr;
 
     uc_write_mem_t write_mem;
     uc_read_mem_t read_mem;
@@ -164,10 +189,22 @@ struct uc_struct {
     uc_args_int_uc_t vm_start;
     uc_args_tcg_enable_t tcg_enabled;
     uc_args_uc_long_t tcg_exec_init;
+    uc_args_size_uc_t tcg_exec_memory;
+    uc_args_uc_range_t translate_range;
+    uc_args_uc_pc_t prof_env_pc;    // guest PC from the CPU state, for profiler samples
+    uc_prof_resolve_t prof_resolve; // guest PC from a host PC in translated code
+    uc_args_uc_t tb_fold_counts;    // move TB execution counts to tb_count_table
+    uc_args_uc_t tb_flush;
     uc_args_uc_ram_size_t memory_map;
     uc_args_uc_ram_size_ptr_t memory_map_ptr;
+    uc_args_uc_ram_file_t memory_map_file;
+    uc_args_uc_ram_lazy_t memory_map_lazy;
+    uc_args_uc_mmio_t memory_map_io;
     uc_mem_unmap_t memory_unmap;
+    uc_args_uc_t memory_batch_begin;
+    uc_args_uc_t memory_batch_end;
     uc_readonly_mem_t readonly_mem;
+    uc_get_ram_ptr_t get_ram_ptr;
     uc_mem_redirect_t mem_redirect;
     // TODO: remove current_cpu, as it's a flag for something else ("cpu running"?)
     CPUState *cpu, *current_cpu;
@@ -189,6 +226,16 @@ struct uc_struct {
     size_t l1_map_size;
     /* code generation context */
     void *tcg_ctx;  // for "TCGContext tcg_ctx" in qemu/translate-all.c
+    size_t tb_cache_size;   // code buffer size from uc_open_with(), 0 = default
+    uint32_t tb_hash_bits;  // initial TB hash bits from uc_open_with(), 0 = default
+    char *tb_cache_file;    // persistent TB cache from uc_open_with(), qemu/tb-cache.c
+    uint64_t tb_cache_hits, tb_cache_misses;
+    uint32_t tb_hot_threshold;  // tiered translation from uc_open_with(), 0 = off
+    uint64_t tb_hot_count;  // blocks retranslated as superblocks, qemu/translate-all.c
+    unsigned int perf_map;  // PERF_MAP_* outputs from uc_open_with(), qemu/util/perf-map.c
+    bool tb_counts;         // UC_OPT_TB_COUNTS from uc_open_with()
+    GHashTable *tb_count_table; // uc_tb_count by guest PC, of TBs folded so far
+    uc_stats stats;     // counters for uc_stats_read()
     /* memory.c */
     unsigned memory_region_transaction_depth;
     bool memory_region_update_pending;
@@ -225,13 +272,39 @@ struct uc_struct {
     bool stop_request;  // request to immediately stop emulation - for uc_emu_stop()
     bool quit_request;  // request to quit the current TB, but continue to emulate - for uc_mem_protect()
     bool emulation_done;  // emulation is done by uc_emu_start()
+    bool pause_request; // stop, but keep translated code - for uc_emu_pause()
+    bool paused;        // stopped by uc_emu_pause(), uc_emu_resume() may continue
     QemuThread timer;   // timer for emulation timeout
-    uint64_t timeout;   // timeout for uc_emu_start()
+    uint64_t timeout;   // timeout for uc_emu_start(), what is left of it while paused
+    int64_t timeout_start;  // when the timer was started
+
+    // guest threads for uc_sched_start(), indexed by thread id
+    struct uc_context **threads;    // saved state, NULL once a thread has finished
+    uint32_t thread_count;  // thread ids handed out so far
+    uint32_t thread_current;    // the thread that owns the CPU while the scheduler runs
+    uint32_t sched_quantum; // instructions per time slice, 0 = scheduler not running
+    bool sched_exit_request;    // drop the running thread at the next switch
+    const struct uc_span *thread_regs;  // CPU state a thread owns, NULL = whole context
+
+    // sampling profiler of uc_profile_start()
+    uint32_t prof_interval; // microseconds between samples, 0 = off
+    QemuThread prof_thread; // sends the sampling signal while emulation runs
+    QemuThread prof_target; // the emulating thread
+    bool prof_done;         // tells prof_thread to finish
+    int prof_sent;          // prof_thread signalled, tells our SIGPROF from the host's
+    struct uc_prof_sample *prof_ring;   // samples not resolved yet
+    volatile unsigned prof_head;    // advanced by the signal handler only
+    unsigned prof_tail;
+    uc_profile_entry *prof_table;   // histogram, open addressing on address
+    size_t prof_table_size, prof_table_used;
 
     uint64_t invalid_addr;  // invalid address to be accessed
     int invalid_error;  // invalid memory code: 1 = READ, 2 = WRITE, 3 = CODE
 
     uint64_t addr_end;  // address where emulation stops (@end param of uc_emu_start())
+    uint64_t tb_addr_end;   // addr_end the translated code was generated for
+    bool tb_stale;      // drop translated code once the CPU stops
+    bool host_writes;   // the host may write guest memory directly: uc_mem_map_ptr(), uc_mem_ptr()
 
     int thumb;  // thumb mode for ARM
     // full TCG cache leads to middle-block break in the last translation?
@@ -240,6 +313,7 @@ struct uc_struct {
     MemoryRegion **mapped_blocks;
     uint32_t mapped_block_count;
     uint32_t mapped_block_cache_index;
+    struct list unmapped_blocks;    // freed at the end of a uc_mem_map_batch()
     void *qemu_thread_data; // to support cross compile to Windows (qemu-thread-win32.c)
     uint32_t target_page_size;
     uint32_t target_page_align;
@@ -253,8 +327,37 @@ struct uc_context {
    char data[0];
 };
 
+// Part of the CPU state, as an offset into CPUArchState and a size
+struct uc_span {
+    size_t offset;
+    size_t size;
+};
+
 // check if this address is mapped in (via uc_mem_map())
 MemoryRegion *memory_mapping(struct uc_struct* uc, uint64_t address);
 
+// switch to the next guest thread, false if none is left (cpu_exec())
+bool uc_sched_switch(struct uc_struct *uc);
+
+// add @count executions of the TB at guest @pc to tb_count_table (tb_flush())
+void uc_tb_count_add(struct uc_struct *uc, uint64_t pc, uint32_t size,
+        uint32_t host_size, uint64_t count);
+
+// A profiler sample, resolved to a guest PC while its block still exists
+struct uc_prof_sample {
+    uintptr_t host_pc;
+    uint64_t env_pc;
+};
+
+#define UC_PROF_RING 1024   // samples taken but not resolved yet
+
+// add the pending profiler samples to the histogram (cpu_exec(), tb_flush())
+void uc_prof_drain(struct uc_struct *uc);
+
+static inline bool uc_prof_pending(struct uc_struct *uc)
+{
+    return uc->prof_head != uc->prof_tail;
+}
+
 #endif
 /* vim: set ts=4 noet:  */
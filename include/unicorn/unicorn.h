@@ -168,6 +168,11 @@ typedef void (*uc_cb_hookcode_t)(uc_engine *uc, uint64_t address, uint32_t size,
 /*
   Callback function for tracing interrupts (for uc_hook_intr())
 
+  X86 "int N", ARM/ARM64 SVC and MIPS SYSCALL call these hooks straight
+  from the translated code rather than by raising an exception. The block
+  ends after the call, so the next one is looked up for whatever CPU state
+  the hooks left.
+
   @intno: interrupt number
   @user_data: user data passed to tracing APIs.
 */
@@ -294,7 +299,42 @@ typedef bool (*uc_cb_eventmem_t)(uc_engine *uc, uc_mem_type type,
         uint64_t address, int size, int64_t value, void *user_data);
 
 /*
-  Memory region mapped by uc_mem_map() and uc_mem_map_ptr()
+  Callback function for reads from a region mapped with uc_mmio_map()
+
+  @offset: offset of the access from the start of the region
+  @size: size of data being read (1, 2, 4 or 8 bytes)
+  @user_data: user data passed to uc_mmio_map()
+
+  @return: the value read by the guest.
+*/
+typedef uint64_t (*uc_cb_mmio_read_t)(uc_engine *uc, uint64_t offset,
+        unsigned size, void *user_data);
+
+/*
+  Callback function for writes to a region mapped with uc_mmio_map()
+
+  @offset: offset of the access from the start of the region
+  @size: size of data being written (1, 2, 4 or 8 bytes)
+  @value: value of data being written
+  @user_data: user data passed to uc_mmio_map()
+*/
+typedef void (*uc_cb_mmio_write_t)(uc_engine *uc, uint64_t offset,
+        unsigned size, uint64_t value, void *user_data);
+
+/*
+  Callback function supplying the contents of a page of a region reserved
+  with uc_mem_reserve(), called once when the page is first touched.
+
+  @address: guest address of the page
+  @page: host memory backing the page, zero-filled; write its contents here
+  @page_size: size of @page (the target page size, at most 4KB)
+  @user_data: user data passed to uc_mem_reserve()
+*/
+typedef void (*uc_cb_page_provider_t)(uc_engine *uc, uint64_t address,
+        void *page, size_t page_size, void *user_data);
+
+/*
+  Memory region mapped by uc_mem_map(), uc_mem_map_ptr() and uc_mmio_map()
   Retrieve the list of memory regions with uc_mem_regions()
 */
 typedef struct uc_mem_region {
@@ -309,8 +349,79 @@ typedef enum uc_query_type {
     UC_QUERY_MODE = 1,
     UC_QUERY_PAGE_SIZE,
     UC_QUERY_ARCH,
+    // Host memory held by the engine in bytes: translator state, generated
+    // code and mapped guest RAM. This is an upper bound on what is resident,
+    // since untouched pages of the code buffer and of guest RAM are not.
+    UC_QUERY_MEMORY,
+    // Blocks installed from / missing in the persistent TB cache
+    // (see uc_open_opts.tb_cache_file)
+    UC_QUERY_TB_CACHE_HITS,
+    UC_QUERY_TB_CACHE_MISSES,
+    // Blocks retranslated as hot superblocks (see uc_open_opts.hot_threshold)
+    UC_QUERY_TB_HOT,
 } uc_query_type;
 
+// Engine counters for uc_stats_read(). They count from uc_open(), or from
+// the last uc_stats_reset(), and are always kept: each is a single
+// increment on a path that is already slow.
+typedef struct uc_stats {
+    uint64_t tb_translated;     // translation blocks generated
+    uint64_t tb_code_bytes;     // host code generated for them, in bytes
+    uint64_t tb_flushes;        // flushes of the whole translation cache
+    uint64_t tb_lookups;        // block lookups, when a block is not chained to the last one
+    uint64_t tb_lookup_misses;  // of these, lookups that missed the jump cache
+    uint64_t tlb_fills;         // guest TLB entries filled
+    uint64_t mem_slow_path;     // guest memory accesses through the softmmu helpers
+    // callbacks run, by bit number of uc_hook_type: hook_calls[2] counts
+    // UC_HOOK_CODE (1 << 2) callbacks, including the one of a uc_emu_start() count
+    uint64_t hook_calls[16];
+    // why translated code returned to the execution loop
+    uint64_t exit_unchained;    // a block ended without a chained successor
+    uint64_t exit_requested;    // stop, pause or exit request
+    uint64_t exit_quantum;      // end of a time slice of uc_sched_start()
+    uint64_t exit_exception;    // exceptions, interrupts, halts and faults
+    uint64_t translate_ns;      // time spent translating
+    uint64_t execute_ns;        // time spent emulating, translation excluded
+} uc_stats;
+
+// One guest address of the uc_profile_read() histogram
+typedef struct uc_profile_entry {
+    uint64_t address;       // guest PC
+    uint64_t samples;       // samples taken in translated code of this instruction
+    uint64_t helper_samples;    // samples taken in helpers, hooks and the engine
+                                // while the CPU was at this address
+} uc_profile_entry;
+
+// Executions of one translated block, for uc_tb_counts_read()
+typedef struct uc_tb_count {
+    uint64_t address;   // guest PC of the block
+    uint32_t size;      // guest code size in bytes
+    uint32_t host_size; // translated host code size in bytes
+    uint64_t count;     // times the block ran
+} uc_tb_count;
+
+// Flags for uc_open_opts.flags
+#define UC_OPT_LOW_MEMORY 1  // small code buffer and TB hash; see uc_open_with()
+#define UC_OPT_PERF_MAP 2    // name translated blocks in /tmp/perf-<pid>.map (Linux)
+#define UC_OPT_JITDUMP 4     // write translated blocks to a perf jitdump file (Linux)
+#define UC_OPT_TB_COUNTS 8   // count executions of every block; see uc_tb_counts_read()
+
+// Engine options for uc_open_with(). Zero fields keep the default.
+typedef struct uc_open_opts {
+    size_t tb_cache_size;   // size of translated code buffer in bytes
+    uint32_t tb_hash_bits;  // log2 of initial TB hash buckets (6..20)
+    uint32_t flags;         // UC_OPT_* flags
+    // Persistent translation cache file, or NULL. Translated blocks are
+    // loaded from it instead of being translated again, and new ones are
+    // written back by uc_close(). Only used on x86-64 hosts, and only while
+    // the engine has no hooks installed.
+    const char *tb_cache_file;
+    // Tiered translation: blocks are first translated quickly without
+    // optimization, and retranslated as optimized superblocks after running
+    // this many times. 0 translates every block once, fully optimized.
+    uint32_t hot_threshold;
+} uc_open_opts;
+
 // Opaque storage for CPU context, used with uc_context_*()
 struct uc_context;
 typedef struct uc_context uc_context;
@@ -349,6 +460,12 @@ bool uc_arch_supported(uc_arch arch);
 
 /*
  Create new instance of unicorn engine.
+ Separate engines may be created, run and closed concurrently from different
+ threads. They do share some process-wide state, which is safe to touch from
+ several engines: host CPU features, which every engine detects to the same
+ values, and the perf map/jitdump files, which are written under a lock.
+ A single engine must only be used by one thread at a time (uc_emu_stop()
+ excepted).
 
  @arch: architecture type (UC_ARCH_*)
  @mode: hardware mode. This is combined of UC_MODE_*
@@ -360,6 +477,40 @@ bool uc_arch_supported(uc_arch arch);
 UNICORN_EXPORT
 uc_err uc_open(uc_arch arch, uc_mode mode, uc_engine **uc);
 
+/*
+ Create new instance of unicorn engine with translator options.
+ By default each engine reserves an 8MB translated code buffer and a 32K
+ bucket TB hash. UC_OPT_LOW_MEMORY shrinks these to 1MB and 256 buckets,
+ for running thousands of small engines at once; the hash still grows as
+ blocks are translated. Explicit @tb_cache_size / @tb_hash_bits override
+ the profile. Use uc_query(UC_QUERY_MEMORY) to see the resulting footprint.
+
+ With a @hot_threshold, cold code only pays for a light translation, while
+ hot blocks are replaced by superblocks that follow unconditional direct
+ jumps (X86 and ARM) and are optimized as a whole. Superblocks are not
+ formed while a UC_HOOK_BLOCK hook is installed, so block callbacks still
+ see every basic block.
+
+ UC_OPT_PERF_MAP and UC_OPT_JITDUMP make translated code visible to Linux
+ perf: each block is named "guest:<arch>:0x<pc>" after its guest address.
+ The map file is read by "perf top" and "perf report" directly. The
+ jitdump file, written to $JITDUMPDIR or /tmp, also holds the host code
+ and is merged into a "perf record -k mono" profile with "perf inject
+ --jit". Both are shared by all engines of the process, and writing them
+ adds to the cost of every translation, not of running translated code.
+
+ @arch: architecture type (UC_ARCH_*)
+ @mode: hardware mode. This is combined of UC_MODE_*
+ @opts: engine options, or NULL for the defaults of uc_open()
+ @uc: pointer to uc_engine, which will be updated at return time
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if @tb_hash_bits is out of range,
+   or other value on failure (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_open_with(uc_arch arch, uc_mode mode, const uc_open_opts *opts,
+        uc_engine **uc);
+
 /*
  Close a Unicorn engine instance.
  NOTE: this must be called only when there is no longer any
@@ -389,6 +540,132 @@ uc_err uc_close(uc_engine *uc);
 UNICORN_EXPORT
 uc_err uc_query(uc_engine *uc, uc_query_type type, size_t *result);
 
+/*
+ Read the engine counters. See uc_stats for what they count.
+ New counters are only ever added at the end of uc_stats: a caller built
+ against an older header gets the counters it knows, and counters this
+ library does not have read as zero.
+
+ @uc: handle returned by uc_open()
+ @stats: where to copy the counters
+ @size: sizeof(uc_stats), i.e. the size of the structure at @stats
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_stats_read(uc_engine *uc, uc_stats *stats, size_t size);
+
+/*
+ Reset the engine counters to zero, e.g. to measure one uc_emu_start().
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_stats_reset(uc_engine *uc);
+
+/*
+ Start the sampling profiler, or restart it with an empty histogram.
+ While uc_emu_start() and uc_emu_resume() run, the engine interrupts the
+ emulating thread with SIGPROF every @interval_us microseconds and records
+ the guest PC it was at. In translated code this is the exact instruction,
+ recovered from the host PC; in helpers, hooks and the engine itself it is
+ the PC last saved in the CPU state. Each sample also makes the CPU leave
+ the translated block it runs, to account for it, so the cost is a few
+ hundred nanoseconds per sample rather than per instruction.
+
+ The engine installs its own SIGPROF handler while any engine profiles, and
+ passes signals it did not send to the handler it replaced; the last
+ uc_profile_stop() (or uc_close()) restores that handler. Not available on
+ Windows.
+
+ @uc: handle returned by uc_open()
+ @interval_us: time between samples in microseconds, > 0
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if @interval_us is 0, emulation
+   is running or the host is not supported, or other value on failure
+   (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_profile_start(uc_engine *uc, uint32_t interval_us);
+
+/*
+ Stop the sampling profiler. The histogram is kept for uc_profile_read().
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_profile_stop(uc_engine *uc);
+
+/*
+ Read the profile histogram, most sampled addresses first.
+
+ @uc: handle returned by uc_open()
+ @entries: pointer to an array of uc_profile_entry. This is allocated by
+   Unicorn, and must be freed by user later with uc_free()
+ @count: pointer to number of entries in @entries
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_profile_read(uc_engine *uc, uc_profile_entry **entries, size_t *count);
+
+/*
+ Write the profile histogram in the folded stack format of flamegraph.pl,
+ one "<address> <samples>" line per sampled address and one
+ "<address>;[helper] <samples>" line for its helper samples. Addresses are
+ hexadecimal with a 0x prefix.
+
+ @uc: handle returned by uc_open()
+ @path: file to write
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if @path cannot be written, or
+   other value on failure (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_profile_dump(uc_engine *uc, const char *path);
+
+/*
+ Read the exact execution count of every block translated so far, most
+ executed first. Needs an engine opened with UC_OPT_TB_COUNTS, where each
+ translated block increments its own 64-bit counter on entry, so counting
+ costs one memory increment per block rather than a UC_HOOK_BLOCK callback.
+
+ Counts of blocks dropped from the translation cache, at the end of every
+ uc_emu_start() or when the cache fills up, are kept and added to by later
+ translations of the same guest address, so they cover all runs of the
+ engine. Superblocks of uc_open_opts.hot_threshold are counted as one block
+ at their first address.
+
+ @uc: handle returned by uc_open()
+ @counts: pointer to an array of uc_tb_count. This is allocated by
+   Unicorn, and must be freed by user later with uc_free()
+ @count: pointer to number of entries in @counts
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if the engine does not count
+   blocks, or other value on failure (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_tb_counts_read(uc_engine *uc, uc_tb_count **counts, size_t *count);
+
+/*
+ Reset all block execution counts to zero.
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if the engine does not count
+   blocks, or other value on failure (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_tb_counts_reset(uc_engine *uc);
+
 /*
  Report the last error number when some API function fail.
  Like glibc's errno, uc_errno might not retain its old value once accessed.
@@ -465,6 +742,39 @@ uc_err uc_reg_write_batch(uc_engine *uc, int *regs, void *const *vals, int count
 UNICORN_EXPORT
 uc_err uc_reg_read_batch(uc_engine *uc, int *regs, void **vals, int count);
 
+/*
+ Get a pointer to a register inside the CPU state, for hooks that access
+ many registers on every call. The pointer stays valid until uc_close(), and
+ accesses through it skip the per-register dispatch of uc_reg_read() and
+ uc_reg_write(). Look registers up once, e.g. when installing the hook.
+
+ Only general purpose registers and the PC have a direct view:
+   X86: EAX-EDI and EIP in 32-bit mode, RAX-R15 and RIP in 64-bit mode
+   ARM: R0-R15;  ARM64: X0-X30, W0-W30, SP and PC
+   MIPS: $0-$31 and PC;  M68K: A0-A7, D0-D7 and PC
+ Registers are stored in host byte order, with the size given in @size.
+ ARM64 W0-W30 and the 32-bit X86 registers are the low 4 bytes of a 64-bit
+ slot, and a write through their pointer leaves the upper half as it was.
+ uc_reg_write() of a 32-bit X86 register clears it instead, which 32-bit code
+ cannot see. On ARM64 the X register keeps its old upper half, like with
+ uc_reg_write() of a W register, where a guest instruction writing the W
+ register would clear it: write the X register to get that.
+ Special registers (flags, segment, FPU, vector and system registers),
+ 16-bit X86 and SPARC go through uc_reg_read()/uc_reg_write().
+
+ Writing the PC through the pointer does not redirect the translation block
+ being executed: from a hook, use uc_reg_write() to jump.
+
+ @uc: handle returned by uc_open()
+ @regid: register ID, from the uc_<arch>_reg enum
+ @ptr: on success, pointer to the register
+ @size: on success, size of the register in bytes
+
+ @return UC_ERR_OK on success, or UC_ERR_ARG if @regid has no direct view.
+*/
+UNICORN_EXPORT
+uc_err uc_reg_ptr(uc_engine *uc, int regid, void **ptr, size_t *size);
+
 /*
  Write to a range of bytes in memory.
 
@@ -497,6 +807,33 @@ uc_err uc_mem_write(uc_engine *uc, uint64_t address, const void *bytes, size_t s
 UNICORN_EXPORT
 uc_err uc_mem_read(uc_engine *uc, uint64_t address, void *bytes, size_t size);
 
+/*
+ Get a pointer to the host memory backing a range of guest memory, to scan or
+ patch large areas in place instead of copying them with uc_mem_read() and
+ uc_mem_write().
+
+ [@address, @address+@size) must lie inside one region mapped by uc_mem_map(),
+ uc_mem_map_ptr() or uc_mem_map_file(). Regions of uc_mmio_map() and
+ uc_mem_reserve() have no contiguous backing and are refused.
+
+ The pointer stays valid until the region is unmapped or, since splitting a
+ region moves it, until uc_mem_unmap() or uc_mem_protect() is applied to any
+ part of it. Accesses through the pointer do not run memory hooks, ignore the
+ region's permissions and do not invalidate translated code: write code with
+ uc_mem_write() while the CPU runs. Once this was called, every uc_emu_start()
+ drops the translated code, as the pointer may have rewritten it.
+
+ @uc: handle returned by uc_open()
+ @address: starting guest address of the range.
+ @size: size of the range.
+ @ptr: on success, host pointer to the byte at @address.
+
+ @return UC_ERR_OK on success, UC_ERR_READ_UNMAPPED if @address is not mapped,
+   or UC_ERR_ARG if the range has no single host block.
+*/
+UNICORN_EXPORT
+uc_err uc_mem_ptr(uc_engine *uc, uint64_t address, size_t size, void **ptr);
+
 /*
  Emulate machine code in a specific duration of time.
 
@@ -508,6 +845,10 @@ uc_err uc_mem_read(uc_engine *uc, uint64_t address, void *bytes, size_t size);
  @count: the number of instructions to be emulated. When this value is 0,
         we will emulate all the code available, until the code is finished.
 
+ Translated code is kept for the next call as long as @until, the hooks and
+ the memory map stay the same, and no run fails. Code changed by the guest or
+ with uc_mem_write() is translated again.
+
  @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
    for detailed error).
 */
@@ -526,6 +867,79 @@ uc_err uc_emu_start(uc_engine *uc, uint64_t begin, uint64_t until, uint64_t time
 UNICORN_EXPORT
 uc_err uc_emu_stop(uc_engine *uc);
 
+/*
+ Pause emulation, to continue it later with uc_emu_resume().
+ This must be called from a callback function while the CPU runs. Emulation
+ stops like with uc_emu_stop() and uc_emu_start() (or uc_emu_resume())
+ returns UC_ERR_OK, but the translated code, the @until address and what is
+ left of the @timeout and @count budgets of uc_emu_start() are kept.
+ Registers and memory may be accessed while paused. Adding or deleting hooks,
+ unmapping memory or removing UC_PROT_EXEC drops the translated code, and
+ uc_emu_start() abandons the paused emulation.
+ When pausing from a UC_HOOK_CODE callback, the instruction being hooked has
+ not run yet: it runs, and its hooks are called again, on resume.
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, or UC_ERR_ARG if the CPU is not running.
+*/
+UNICORN_EXPORT
+uc_err uc_emu_pause(uc_engine *uc);
+
+/*
+ Continue an emulation paused by uc_emu_pause(), from the current PC.
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, UC_ERR_ARG if emulation is not paused, or
+   other value on failure (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_emu_resume(uc_engine *uc);
+
+/*
+ Translate the code in a memory range ahead of emulation, so a following
+ uc_emu_start() does not pay the translation cost on first execution.
+ Blocks are decoded back to back from @begin until @end is reached, in the
+ CPU mode currently set (e.g. ARM Thumb state). The blocks stay cached across
+ uc_emu_start() calls as long as uc_emu_start() keeps them (see there). On
+ failure, the translation cache is flushed.
+
+ Blocks are specialized for the hooks installed at translation time and for
+ the stop address, so install hooks first, and pass as @until the address the
+ later uc_emu_start() will be given. Runs that set a @count are counted by a
+ code hook, and do not reuse blocks translated without one.
+
+ NOTE: this cannot be called from inside a callback.
+
+ @uc: handle returned by uc_open()
+ @begin: address of the first instruction to translate
+ @end: address right after the last instruction to translate
+ @until: @until argument of the uc_emu_start() that will run this code
+
+ @return UC_ERR_OK on success, UC_ERR_FETCH_UNMAPPED or UC_ERR_FETCH_PROT if
+   the code is not mapped executable, or other value on failure (refer to
+   uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_translate_range(uc_engine *uc, uint64_t begin, uint64_t end, uint64_t until);
+
+/*
+ Translate the block starting at each of a list of entry points, such as
+ the functions of a guest symbol table. See uc_translate_range() for how
+ the translated blocks are used.
+
+ @uc: handle returned by uc_open()
+ @entries: array of @count code addresses
+ @count: number of addresses in @entries
+ @until: @until argument of the uc_emu_start() that will run this code
+
+ @return UC_ERR_OK on success, or the error of the first entry point that
+   could not be translated (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_translate(uc_engine *uc, const uint64_t *entries, size_t count, uint64_t until);
+
 /*
  Register callback for a hook event.
  The callback will be run when the hook event is hit.
@@ -607,6 +1021,8 @@ uc_err uc_mem_map(uc_engine *uc, uint64_t address, size_t size, uint32_t perms);
  @ptr: pointer to host memory backing the newly mapped memory. This host memory is
     expected to be an equal or larger size than provided, and be mapped with at
     least PROT_READ | PROT_WRITE. If it is not, the resulting behavior is undefined.
+    As the host may write code there, every uc_emu_start() of this engine
+    drops the translated code.
 
  @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
    for detailed error).
@@ -614,6 +1030,89 @@ uc_err uc_mem_map(uc_engine *uc, uint64_t address, size_t size, uint32_t perms);
 UNICORN_EXPORT
 uc_err uc_mem_map_ptr(uc_engine *uc, uint64_t address, size_t size, uint32_t perms, void *ptr);
 
+/*
+ Map a range of a file in for emulation, copy-on-write.
+ The file is mapped privately, so pages are read from it on first access and
+ guest writes (and uc_mem_write()) never reach the file. Pages that are never
+ written stay shared with the page cache of other processes mapping the same
+ file.
+
+ @uc: handle returned by uc_open()
+ @address: starting address of the new memory region to be mapped in.
+    This address must be aligned to 4KB, or this will return with UC_ERR_ARG error.
+ @size: size of the new memory region to be mapped in.
+    This size must be multiple of 4KB, or this will return with UC_ERR_ARG error.
+    On POSIX hosts, bytes past the end of the file read as zero; on Windows the
+    range must lie within the file.
+ @perms: Permissions for the newly mapped region.
+    This must be some combination of UC_PROT_READ | UC_PROT_WRITE | UC_PROT_EXEC,
+    or this will return with UC_ERR_ARG error.
+ @fd: file descriptor opened for reading. It may be closed once this returns.
+ @offset: offset into the file. This must be aligned to 4KB and to the host
+    page size (16KB or 64KB on some arm64 and ppc64 hosts; the 64KB allocation
+    granularity on Windows), or this will return with UC_ERR_ARG error.
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_mem_map_file(uc_engine *uc, uint64_t address, size_t size, uint32_t perms, int fd, uint64_t offset);
+
+/*
+ Reserve a range of guest address space whose pages are supplied on demand.
+ Nothing is read or allocated up front: the first guest access, uc_mem_read()
+ or uc_mem_write() touching a page commits host memory for it and calls
+ @provider to fill it, after which the page is ordinary memory. Only host
+ address space is reserved for the rest, so this does not rely on the host
+ overcommitting memory. This lets huge, sparsely used address spaces (core
+ dumps, snapshots, large heaps) be mapped without UC_HOOK_MEM_UNMAPPED
+ handlers that stop emulation for every first touch.
+ uc_mem_protect() and uc_mem_unmap() must cover the whole region.
+
+ @uc: handle returned by uc_open()
+ @address: starting address of the range to be reserved.
+    This address must be aligned to 4KB, or this will return with UC_ERR_ARG error.
+ @size: size of the range to be reserved.
+    This size must be multiple of 4KB, or this will return with UC_ERR_ARG error.
+ @perms: Permissions for the newly mapped region.
+    This must be some combination of UC_PROT_READ | UC_PROT_WRITE | UC_PROT_EXEC,
+    or this will return with UC_ERR_ARG error.
+ @provider: callback filling each page on first touch.
+ @user_data: user-defined data passed to @provider.
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_mem_reserve(uc_engine *uc, uint64_t address, size_t size, uint32_t perms,
+        uc_cb_page_provider_t provider, void *user_data);
+
+/*
+ Map a device (MMIO) region in for emulation.
+ Guest loads and stores to this region are passed to @read_cb and @write_cb
+ instead of touching memory, so device registers can be modeled without
+ global UC_HOOK_MEM_* hooks or unmapped-memory handlers.
+ The region is never executable, and uc_mem_read()/uc_mem_write() on it also
+ go through the callbacks. uc_mem_protect() is refused, and uc_mem_unmap()
+ must cover the whole region.
+
+ @uc: handle returned by uc_open()
+ @address: starting address of the new region to be mapped in.
+    This address must be aligned to 4KB, or this will return with UC_ERR_ARG error.
+ @size: size of the new region to be mapped in.
+    This size must be multiple of 4KB, or this will return with UC_ERR_ARG error.
+ @read_cb: callback for guest reads, or NULL to make the region write-only.
+ @write_cb: callback for guest writes, or NULL to make the region read-only.
+    At least one of @read_cb and @write_cb must be given.
+ @user_data: user-defined data passed to both callbacks.
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_mmio_map(uc_engine *uc, uint64_t address, size_t size,
+        uc_cb_mmio_read_t read_cb, uc_cb_mmio_write_t write_cb, void *user_data);
+
 /*
  Unmap a region of emulation memory.
  This API deletes a memory mapping from the emulation memory space.
@@ -649,6 +1148,41 @@ uc_err uc_mem_unmap(uc_engine *uc, uint64_t address, size_t size);
 UNICORN_EXPORT
 uc_err uc_mem_protect(uc_engine *uc, uint64_t address, size_t size, uint32_t perms);
 
+// Operations for uc_mem_map_batch()
+typedef enum uc_mem_op_type {
+    UC_MEM_OP_MAP = 0,  // uc_mem_map(address, size, perms)
+    UC_MEM_OP_MAP_PTR,  // uc_mem_map_ptr(address, size, perms, ptr)
+    UC_MEM_OP_UNMAP,    // uc_mem_unmap(address, size)
+    UC_MEM_OP_PROTECT,  // uc_mem_protect(address, size, perms)
+} uc_mem_op_type;
+
+typedef struct uc_mem_op {
+    uc_mem_op_type type;
+    uint64_t address;
+    size_t size;
+    uint32_t perms;     // ignored for UC_MEM_OP_UNMAP
+    void *ptr;          // only used by UC_MEM_OP_MAP_PTR
+} uc_mem_op;
+
+/*
+ Apply many map, unmap and protect operations at once.
+ This behaves like calling uc_mem_map(), uc_mem_map_ptr(), uc_mem_unmap() and
+ uc_mem_protect() for each entry in order, but the emulated address space is
+ rebuilt and the TLB flushed only once, at the end. Use it to load images with
+ many sections.
+
+ @uc: handle returned by uc_open()
+ @ops: array of operations, applied in order.
+ @count: number of entries in @ops.
+ @done: if not NULL, receives the number of operations applied. On failure
+    this is the index of the failing entry; earlier entries stay applied.
+
+ @return UC_ERR_OK on success, or the error of the first failing operation
+   (refer to uc_err enum for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_mem_map_batch(uc_engine *uc, const uc_mem_op *ops, size_t count, size_t *done);
+
 /*
  Retrieve all memory regions mapped by uc_mem_map() and uc_mem_map_ptr()
  This API allocates memory for @regions, and user must free this memory later
@@ -723,6 +1257,86 @@ uc_err uc_context_save(uc_engine *uc, uc_context *context);
 UNICORN_EXPORT
 uc_err uc_context_restore(uc_engine *uc, uc_context *context);
 
+/*
+ Register a guest thread for uc_sched_start().
+ The thread starts from a copy of @context, at the PC saved in it. This can
+ also be called from a callback while the scheduler runs, e.g. to emulate
+ a clone() syscall; the new thread gets its first time slice after the
+ threads already registered.
+
+ @uc: handle returned by uc_open()
+ @context: a CPU context saved by uc_context_save()
+ @id: on success, the id of the new thread
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_thread_add(uc_engine *uc, const uc_context *context, uint32_t *id);
+
+/*
+ Remove a guest thread. Removing the running thread from a callback ends
+ it at the next translation block boundary, as when it reaches the end
+ address of uc_sched_start(): use this to emulate an exit() syscall.
+
+ @uc: handle returned by uc_open()
+ @id: thread id returned by uc_thread_add()
+
+ @return UC_ERR_OK on success, or UC_ERR_ARG if there is no such thread.
+*/
+UNICORN_EXPORT
+uc_err uc_thread_remove(uc_engine *uc, uint32_t id);
+
+/*
+ Get the id of the guest thread the CPU is running, from a callback.
+
+ @uc: handle returned by uc_open()
+ @id: on success, the id of the running thread
+
+ @return UC_ERR_OK on success, or UC_ERR_ARG if the scheduler is not running.
+*/
+UNICORN_EXPORT
+uc_err uc_thread_current(uc_engine *uc, uint32_t *id);
+
+/*
+ End the time slice of the running guest thread at the next translation
+ block boundary, e.g. from the hook of a sched_yield() or futex syscall.
+
+ @uc: handle returned by uc_open()
+
+ @return UC_ERR_OK on success, or UC_ERR_ARG if the scheduler is not running.
+*/
+UNICORN_EXPORT
+uc_err uc_thread_yield(uc_engine *uc);
+
+/*
+ Run the guest threads registered with uc_thread_add(), round robin, in a
+ single emulation. Each thread runs for @quantum instructions and is then
+ switched out at the next translation block boundary, so a time slice may
+ run over by part of a block. Switching happens inside the engine: the
+ translated code is shared by all threads and stays cached, and only the
+ registers a thread owns are saved and restored. On X86 these are the
+ general purpose, segment, x87/MMX and SSE/AVX registers, while control
+ registers and MSRs are shared. Other architectures switch the whole
+ context.
+
+ A thread finishes when it reaches @until, halts, or is removed with
+ uc_thread_remove(). Emulation ends when no thread is left, or on an error,
+ uc_emu_stop() or the timeout. In the last three cases, the registers of
+ the thread that was running can be read, and calling this again continues
+ with that thread. uc_emu_pause() is not supported here.
+
+ @uc: handle returned by uc_open()
+ @until: address where a thread stops running
+ @quantum: time slice, in instructions (up to INT32_MAX)
+ @timeout: timeout for the whole run, in microseconds. 0 for no timeout.
+
+ @return UC_ERR_OK on success, or other value on failure (refer to uc_err enum
+   for detailed error).
+*/
+UNICORN_EXPORT
+uc_err uc_sched_start(uc_engine *uc, uint64_t until, uint32_t quantum, uint64_t timeout);
+
 #ifdef __cplusplus
 }
 #endif
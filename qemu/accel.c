@@ -32,9 +32,6 @@
 #include "qom/object.h"
 #include "hw/boards.h"
 
-// use default size for TCG translated block
-#define TCG_TB_SIZE 0
-
 static bool tcg_allowed = true;
 static int tcg_init(MachineState *ms);
 static AccelClass *accel_find(struct uc_struct *uc, const char *opt_name);
@@ -43,7 +40,8 @@ static void tcg_accel_class_init(struct uc_struct *uc, ObjectClass *oc, void *da
 
 static int tcg_init(MachineState *ms)
 {
-    ms->uc->tcg_exec_init(ms->uc, TCG_TB_SIZE * 1024 * 1024); // arch-dependent
+    // zero selects the default size
+    ms->uc->tcg_exec_init(ms->uc, ms->uc->tb_cache_size); // arch-dependent
     return 0;
 }
 
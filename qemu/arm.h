@@ -12,14 +12,28 @@
 #define tb_invalidate_phys_page_fast tb_invalidate_phys_page_fast_arm
 #define phys_mem_clean phys_mem_clean_arm
 #define tb_cleanup tb_cleanup_arm
+#define tb_cache_open tb_cache_open_arm
+#define tb_cache_load tb_cache_load_arm
+#define tb_cache_store tb_cache_store_arm
+#define tb_cache_close tb_cache_close_arm
 #define memory_map memory_map_arm
 #define memory_map_ptr memory_map_ptr_arm
+#define memory_map_file memory_map_file_arm
+#define memory_map_lazy memory_map_lazy_arm
+#define memory_map_io memory_map_io_arm
 #define memory_unmap memory_unmap_arm
+#define memory_batch_begin memory_batch_begin_arm
+#define memory_batch_end memory_batch_end_arm
 #define memory_free memory_free_arm
 #define free_code_gen_buffer free_code_gen_buffer_arm
 #define helper_raise_exception helper_raise_exception_arm
 #define tcg_enabled tcg_enabled_arm
 #define tcg_exec_init tcg_exec_init_arm
+#define tcg_exec_memory tcg_exec_memory_arm
+#define tb_translate_range tb_translate_range_arm
+#define tb_prof_env_pc tb_prof_env_pc_arm
+#define tb_prof_resolve tb_prof_resolve_arm
+#define tb_fold_counts tb_fold_counts_arm
 #define memory_register_types memory_register_types_arm
 #define cpu_exec_init_all cpu_exec_init_all_arm
 #define vm_start vm_start_arm
@@ -2042,6 +2056,7 @@
 #define memory_region_init_io memory_region_init_io_arm
 #define memory_region_init_ram memory_region_init_ram_arm
 #define memory_region_init_ram_ptr memory_region_init_ram_ptr_arm
+#define memory_region_init_ram_file memory_region_init_ram_file_arm
 #define memory_region_init_reservation memory_region_init_reservation_arm
 #define memory_region_is_iommu memory_region_is_iommu_arm
 #define memory_region_is_logging memory_region_is_logging_arm
@@ -2365,8 +2380,6 @@
 #define qdict_size qdict_size_arm
 #define qdict_type qdict_type_arm
 #define qemu_clock_get_us qemu_clock_get_us_arm
-#define qemu_clock_ptr qemu_clock_ptr_arm
-#define qemu_clocks qemu_clocks_arm
 #define qemu_get_cpu qemu_get_cpu_arm
 #define qemu_get_guest_memory_mapping qemu_get_guest_memory_mapping_arm
 #define qemu_get_guest_simple_memory_mapping qemu_get_guest_simple_memory_mapping_arm
@@ -2374,6 +2387,7 @@
 #define qemu_get_ram_block_host_ptr qemu_get_ram_block_host_ptr_arm
 #define qemu_get_ram_fd qemu_get_ram_fd_arm
 #define qemu_get_ram_ptr qemu_get_ram_ptr_arm
+#define qemu_ram_populate qemu_ram_populate_arm
 #define qemu_host_page_mask qemu_host_page_mask_arm
 #define qemu_host_page_size qemu_host_page_size_arm
 #define qemu_init_vcpu qemu_init_vcpu_arm
@@ -2389,6 +2403,7 @@
 #define qemu_ram_addr_from_host_nofail qemu_ram_addr_from_host_nofail_arm
 #define qemu_ram_alloc qemu_ram_alloc_arm
 #define qemu_ram_alloc_from_ptr qemu_ram_alloc_from_ptr_arm
+#define qemu_ram_alloc_from_file qemu_ram_alloc_from_file_arm
 #define qemu_ram_foreach_block qemu_ram_foreach_block_arm
 #define qemu_ram_free qemu_ram_free_arm
 #define qemu_ram_free_from_ptr qemu_ram_free_from_ptr_arm
@@ -2652,6 +2667,7 @@
 #define tb_flush_jmp_cache tb_flush_jmp_cache_arm
 #define tb_free tb_free_arm
 #define tb_gen_code tb_gen_code_arm
+#define tb_gen_hot tb_gen_hot_arm
 #define tb_hash_remove tb_hash_remove_arm
 #define tb_invalidate_phys_addr tb_invalidate_phys_addr_arm
 #define tb_invalidate_phys_page_range tb_invalidate_phys_page_range_arm
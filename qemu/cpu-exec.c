@@ -21,6 +21,8 @@
 
 #include "tcg.h"
 #include "sysemu/sysemu.h"
+#include "qemu/timer.h"
+#include "qemu/probes.h"
 
 #include "uc_priv.h"
 
@@ -29,6 +31,7 @@ static TranslationBlock *tb_find_slow(CPUArchState *env, target_ulong pc,
         target_ulong cs_base, uint64_t flags);
 static TranslationBlock *tb_find_fast(CPUArchState *env);
 static void cpu_handle_debug_exception(CPUArchState *env);
+static bool cpu_sched_switch(CPUState *cpu);
 
 void cpu_loop_exit(CPUState *cpu)
 {
@@ -65,6 +68,8 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
     uint8_t *tc_ptr;
     uintptr_t next_tb;
     struct hook *hook;
+    int64_t t0 = get_clock();
+    uint64_t translate_ns = uc->stats.translate_ns;
 
 
     if (cpu->halted) {
@@ -89,6 +94,7 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
         cpu->exit_request = 1;
     }
 
+    UC_PROBE1(cpu_exec_enter, tb_prof_env_pc(uc));
     cc->cpu_exec_enter(cpu);
     cpu->exception_index = -1;
     env->invalid_error = UC_ERR_OK;
@@ -115,6 +121,16 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
                     if (ret == EXCP_DEBUG) {
                         cpu_handle_debug_exception(env);
                     }
+                    /* Unicorn: a guest thread that halts, or reaches the
+                       end address, has finished; run the next one */
+                    if (ret == EXCP_HLT && uc->sched_quantum) {
+                        uc->sched_exit_request = true;
+                        if (cpu_sched_switch(cpu)) {
+                            cpu->halted = 0;
+                            cpu->exception_index = -1;
+                            continue;
+                        }
+                    }
                     break;
                 } else {
 #if defined(CONFIG_USER_ONLY)
@@ -131,6 +147,7 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
                     // Unicorn: call registered interrupt callbacks
                     HOOK_FOREACH_VAR_DECLARE;
                     HOOK_FOREACH(uc, hook, UC_HOOK_INTR) {
+                        HOOK_COUNT(uc, UC_HOOK_INTR);
                         ((uc_cb_hookintr_t)hook->callback)(uc, cpu->exception_index, hook->user_data);
                         catched = true;
                     }
@@ -208,12 +225,23 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
                     cpu->exception_index = EXCP_INTERRUPT;
                     cpu_loop_exit(cpu);
                 }
+                /* Unicorn: profiler samples, while their blocks exist */
+                if (unlikely(uc_prof_pending(uc))) {
+                    uc_prof_drain(uc);
+                }
                 tb = tb_find_fast(env);	// qq
                 if (!tb) {   // invalid TB due to invalid code?
                     uc->invalid_error = UC_ERR_FETCH_UNMAPPED;
                     ret = EXCP_HLT;
                     break;
                 }
+                /* Unicorn: cold TBs are never chained to, so each of their
+                   executions is counted here until they turn hot */
+                if (unlikely(tb->cflags & CF_COLD) &&
+                        ++tb->exec_count >= uc->tb_hot_threshold) {
+                    tb = tb_gen_hot(cpu, tb);
+                    next_tb = 0;
+                }
                 /* Note: we do it here to avoid a gcc bug on Mac OS X when
                    doing it in tb_find_slow */
                 if (tcg_ctx->tb_ctx.tb_invalidated_flag) {
@@ -226,7 +254,8 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
                 /* see if we can patch the calling TB. When the TB
                    spans two pages, we cannot safely do a direct
                    jump. */
-                if (next_tb != 0 && tb->page_addr[1] == -1) {
+                if (next_tb != 0 && tb->page_addr[1] == -1 &&
+                        !(tb->cflags & CF_COLD)) {
                     tb_add_jump((TranslationBlock *)(next_tb & ~TB_EXIT_MASK),
                             next_tb & TB_EXIT_MASK, tb);
                 }
@@ -253,8 +282,22 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
                              */
                             tb = (TranslationBlock *)(next_tb & ~TB_EXIT_MASK);
                             next_tb = 0;
+                            uc->stats.exit_requested++;
+                            break;
+                        case TB_EXIT_ICOUNT_EXPIRED:
+                            /* Unicorn: the guest thread used up its
+                               quantum, or was removed or yielded */
+                            uc->stats.exit_quantum++;
+                            if (!cpu_sched_switch(cpu)) {
+                                cpu->halted = 1;
+                                cpu->exception_index = EXCP_HLT;
+                                cpu_loop_exit(cpu);
+                            }
+                            next_tb = 0;
                             break;
                         default:
+                            /* fell out of a block that is not chained */
+                            uc->stats.exit_unchained++;
                             break;
                     }
                 }
@@ -271,15 +314,25 @@ int cpu_exec(struct uc_struct *uc, CPUArchState *env)   // qq
 #ifdef TARGET_I386
             x86_cpu = X86_CPU(uc, cpu);
 #endif
+            uc->stats.exit_exception++;
         }
     } /* for(;;) */
 
     cc->cpu_exec_exit(cpu);
 
-    // Unicorn: flush JIT cache to because emulation might stop in
-    // the middle of translation, thus generate incomplete code.
-    // TODO: optimize this for better performance
-    tb_flush(env);
+    // Unicorn: translated code is kept for the next run, unless this
+    // one failed: emulation might stop in the middle of translation,
+    // thus generate incomplete code. uc.c marks it stale when hooks or
+    // mappings change while the CPU runs, and flushes when the stop
+    // address changes.
+    if (uc->invalid_error || uc->tb_stale) {
+        tb_flush(env);
+        uc->tb_stale = false;
+    }
+
+    t0 = get_clock() - t0;
+    uc->stats.execute_ns += t0 - (uc->stats.translate_ns - translate_ns);
+    UC_PROBE2(cpu_exec_exit, ret, t0);
 
     /* fail safe : never use current_cpu outside cpu_exec() */
     uc->current_cpu = NULL;
@@ -323,6 +376,23 @@ static tcg_target_ulong cpu_tb_exec(CPUState *cpu, uint8_t *tb_ptr)
     return next_tb;
 }
 
+/* Unicorn: switch the CPU to the next guest thread at a TB boundary.
+   Threads are saved the way uc_context_save() sees them, outside of
+   cpu_exec_enter().  Returns false when no thread is left to run.  */
+static bool cpu_sched_switch(CPUState *cpu)
+{
+    struct uc_struct *uc = cpu->uc;
+    CPUClass *cc = CPU_GET_CLASS(uc, cpu);
+    bool more;
+
+    cc->cpu_exec_exit(cpu);
+    more = uc_sched_switch(uc);
+    cc->cpu_exec_enter(cpu);
+    cpu->quantum = uc->sched_quantum;
+
+    return more;
+}
+
 static TranslationBlock *tb_find_slow(CPUArchState *env, target_ulong pc,
         target_ulong cs_base, uint64_t flags)   // qq
 {
@@ -341,7 +411,7 @@ static TranslationBlock *tb_find_slow(CPUArchState *env, target_ulong pc,
         return NULL;
     }
     phys_page1 = phys_pc & TARGET_PAGE_MASK;
-    h = tb_phys_hash_func(phys_pc);
+    h = tb_phys_hash_func(phys_pc, tcg_ctx->tb_ctx.tb_phys_hash_bits);
     ptb1 = &tcg_ctx->tb_ctx.tb_phys_hash[h];
     for(;;) {
         tb = *ptb1;
@@ -367,8 +437,12 @@ static TranslationBlock *tb_find_slow(CPUArchState *env, target_ulong pc,
         ptb1 = &tb->phys_hash_next;
     }
 not_found:
-    /* if no translated code available, then translate it now */
-    tb = tb_gen_code(cpu, pc, cs_base, (int)flags, 0);   // qq
+    /* if no translated code available, then translate it now.  The new TB
+       is already at the head of its chain, and the hash may have been
+       resized, so ptb1 and h are stale.  */
+    tb = tb_gen_code(cpu, pc, cs_base, (int)flags,
+                     env->uc->tb_hot_threshold ? CF_COLD : 0);   // qq
+    goto done;
 
 found:
     /* Move the last found TB to the head of the list */
@@ -377,6 +451,7 @@ found:
         tb->phys_hash_next = tcg_ctx->tb_ctx.tb_phys_hash[h];
         tcg_ctx->tb_ctx.tb_phys_hash[h] = tb;
     }
+done:
     /* we add the TB in the virtual pc hash table */
     cpu->tb_jmp_cache[tb_jmp_cache_hash_func(pc)] = tb;
     return tb;
@@ -394,13 +469,63 @@ static TranslationBlock *tb_find_fast(CPUArchState *env)    // qq
        is executed. */
     cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
     tb = cpu->tb_jmp_cache[tb_jmp_cache_hash_func(pc)];
+    env->uc->stats.tb_lookups++;
     if (unlikely(!tb || tb->pc != pc || tb->cs_base != cs_base ||
                 tb->flags != flags)) {
+        env->uc->stats.tb_lookup_misses++;
         tb = tb_find_slow(env, pc, cs_base, flags); // qq
     }
     return tb;
 }
 
+/* Unicorn: translate the blocks covering [begin, end) ahead of execution,
+   in the CPU mode the next uc_emu_start() would run them.  Each block is
+   looked up as tb_find_fast() would, so it lands in the phys hash and the
+   jump cache.  Returns the fetch error that stopped translation, if any.  */
+uc_err tb_translate_range(struct uc_struct *uc, uint64_t begin, uint64_t end)
+{
+    CPUState *cpu = uc->cpu;
+    CPUArchState *env = cpu->env_ptr;
+    TranslationBlock *tb;
+    target_ulong pc, cs_base;
+    int flags;
+    /* survives the siglongjmp() of a fetch fault */
+    volatile uint64_t next = begin;
+    uc_err err;
+
+    uc->current_cpu = cpu;
+    env->invalid_error = UC_ERR_OK;
+
+    if (sigsetjmp(cpu->jmp_env, 0) == 0) {
+        cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
+        while (next < end) {
+#ifdef TARGET_SPARC
+            /* straight-line code: npc follows pc */
+            cs_base = (target_ulong)next + 4;
+#endif
+            tb = tb_find_slow(env, (target_ulong)next, cs_base, flags);
+            if (!tb || env->invalid_error || tb->size == 0) {
+                break;
+            }
+            next += tb->size;
+        }
+    }
+
+    err = env->invalid_error;
+    env->invalid_error = UC_ERR_OK;
+    /* a fetch fault requested an exit that no run is waiting for */
+    cpu->exit_request = 0;
+    cpu->tcg_exit_req = 0;
+    if (err != UC_ERR_OK) {
+        /* the faulting block was allocated but never finished: drop it
+           like cpu_exec() does, so tb_find_pc() cannot resolve to it */
+        tb_flush(env);
+    }
+    uc->current_cpu = NULL;
+
+    return err;
+}
+
 static void cpu_handle_debug_exception(CPUArchState *env)
 {
     CPUState *cpu = ENV_GET_CPU(env);
@@ -134,8 +134,8 @@ static bool tcg_exec_all(struct uc_struct* uc)
             uc->quit_request = false;
             r = tcg_cpu_exec(uc, env);
 
-            // quit current TB but continue emulating?
-            if (uc->quit_request) {
+            // quit current TB but continue emulating? (unless pausing)
+            if (uc->quit_request && !uc->pause_request) {
                 // reset stop_request
                 uc->stop_request = false;
             } else if (uc->stop_request) {
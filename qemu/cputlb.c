@@ -31,6 +31,7 @@
 #include "exec/memory-internal.h"
 #include "exec/ram_addr.h"
 #include "tcg/tcg.h"
+#include "qemu/probes.h"
 
 #include "uc_priv.h"
 
@@ -212,6 +213,9 @@ void tlb_set_page(CPUState *cpu, target_ulong vaddr,
     hwaddr iotlb, xlat, sz;
     unsigned vidx = env->vtlb_index++ % CPU_VTLB_SIZE;
 
+    cpu->uc->stats.tlb_fills++;
+    UC_PROBE3(tlb_fill, (uint64_t)vaddr, (uint64_t)paddr, prot);
+
     assert(size >= TARGET_PAGE_SIZE);
     if (size != TARGET_PAGE_SIZE) {
         tlb_add_large_page(env, vaddr, size);
@@ -235,6 +239,11 @@ void tlb_set_page(CPUState *cpu, target_ulong vaddr,
         addend = 0;
     } else {
         /* TLB_MMIO for rom/romd handled below */
+        if (unlikely(section->mr->page_provider)) {
+            /* first touch of a uc_mem_reserve() page: fill it in place */
+            qemu_ram_populate(cpu->uc, section->mr->ram_addr + xlat,
+                              TARGET_PAGE_SIZE);
+        }
         addend = (uintptr_t)((char*)memory_region_get_ram_ptr(section->mr) + xlat);
     }
 
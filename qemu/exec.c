@@ -59,6 +59,9 @@
 /* RAM is mmap-ed with MAP_SHARED */
 #define RAM_SHARED     (1 << 1)
 
+/* RAM is a private (copy-on-write) mapping of a file */
+#define RAM_FILE       (1 << 2)
+
 #endif
 
 #if !defined(CONFIG_USER_ONLY)
@@ -914,31 +917,56 @@ static void mem_add(MemoryListener *listener, MemoryRegionSection *section)
 
 #endif
 
+static int ram_block_cmp_offset(const void *a, const void *b)
+{
+    const RAMBlock *ba = *(const RAMBlock **)a;
+    const RAMBlock *bb = *(const RAMBlock **)b;
+
+    if (ba->offset < bb->offset) {
+        return -1;
+    }
+    return ba->offset > bb->offset;
+}
+
 static ram_addr_t find_ram_offset(struct uc_struct *uc, ram_addr_t size)
 {
-    RAMBlock *block, *next_block;
+    RAMBlock *block, **sorted;
     ram_addr_t offset = RAM_ADDR_MAX, mingap = RAM_ADDR_MAX;
+    ram_addr_t end = 0;
+    int i, n = 0;
 
     assert(size != 0); /* it would hand out same offset multiple times */
 
-    if (QTAILQ_EMPTY(&uc->ram_list.blocks))
-        return 0;
+    /* No holes left by freed blocks: append after the highest block.
+       This is the common case when mapping a large image.  */
+    if (uc->ram_list.used == uc->ram_list.last_offset) {
+        return uc->ram_list.last_offset;
+    }
 
+    /* Otherwise look for the smallest gap that fits, in one pass over
+       the blocks sorted by offset.  */
+    QTAILQ_FOREACH(block, &uc->ram_list.blocks, next) {
+        n++;
+    }
+    sorted = g_new(RAMBlock *, n);
+    i = 0;
     QTAILQ_FOREACH(block, &uc->ram_list.blocks, next) {
-        ram_addr_t end, next = RAM_ADDR_MAX;
+        sorted[i++] = block;
+    }
+    qsort(sorted, n, sizeof(*sorted), ram_block_cmp_offset);
 
-        end = block->offset + block->length;
+    for (i = 0; i <= n; i++) {
+        ram_addr_t next = i < n ? sorted[i]->offset : RAM_ADDR_MAX;
 
-        QTAILQ_FOREACH(next_block, &uc->ram_list.blocks, next) {
-            if (next_block->offset >= end) {
-                next = MIN(next, next_block->offset);
-            }
-        }
         if (next - end >= size && next - end < mingap) {
             offset = end;
             mingap = next - end;
         }
+        if (i < n) {
+            end = MAX(end, sorted[i]->offset + sorted[i]->length);
+        }
     }
+    g_free(sorted);
 
     if (offset == RAM_ADDR_MAX) {
         fprintf(stderr, "Failed to find gap of requested size: %" PRIu64 "\n",
@@ -951,13 +979,22 @@ static ram_addr_t find_ram_offset(struct uc_struct *uc, ram_addr_t size)
 
 ram_addr_t last_ram_offset(struct uc_struct *uc)
 {
-    RAMBlock *block;
-    ram_addr_t last = 0;
+    return uc->ram_list.last_offset;
+}
 
-    QTAILQ_FOREACH(block, &uc->ram_list.blocks, next)
-        last = MAX(last, block->offset + block->length);
+/* Account for @block leaving ram_list.blocks.  */
+static void ram_block_removed(struct uc_struct *uc, RAMBlock *block)
+{
+    RAMBlock *b;
+    ram_addr_t last = 0;
 
-    return last;
+    uc->ram_list.used -= block->length;
+    if (block->offset + block->length == uc->ram_list.last_offset) {
+        QTAILQ_FOREACH(b, &uc->ram_list.blocks, next) {
+            last = MAX(last, b->offset + b->length);
+        }
+        uc->ram_list.last_offset = last;
+    }
 }
 
 static void qemu_ram_setup_dump(void *addr, ram_addr_t size)
@@ -996,8 +1033,6 @@ static ram_addr_t ram_block_add(struct uc_struct *uc, RAMBlock *new_block, Error
     RAMBlock *block;
     ram_addr_t old_ram_size, new_ram_size;
 
-    old_ram_size = last_ram_offset(uc) >> TARGET_PAGE_BITS;
-
     new_block->offset = find_ram_offset(uc, new_block->length);
 
     if (!new_block->host) {
@@ -1026,16 +1061,24 @@ static ram_addr_t ram_block_add(struct uc_struct *uc, RAMBlock *new_block, Error
     uc->ram_list.mru_block = NULL;
 
     uc->ram_list.version++;
+    uc->ram_list.used += new_block->length;
+    uc->ram_list.last_offset = MAX(uc->ram_list.last_offset,
+                                   new_block->offset + new_block->length);
 
+    /* Grow the dirty bitmaps geometrically so that mapping many small
+       regions does not reallocate and copy them every time.  */
+    old_ram_size = uc->ram_list.dirty_pages;
     new_ram_size = last_ram_offset(uc) >> TARGET_PAGE_BITS;
 
     if (new_ram_size > old_ram_size) {
         int i;
+        new_ram_size = MAX(new_ram_size, old_ram_size * 2);
         for (i = 0; i < DIRTY_MEMORY_NUM; i++) {
             uc->ram_list.dirty_memory[i] =
                 bitmap_zero_extend(uc->ram_list.dirty_memory[i],
                         old_ram_size, new_ram_size);
         }
+        uc->ram_list.dirty_pages = new_ram_size;
     }
     cpu_physical_memory_set_dirty_range(uc, new_block->offset, new_block->length);
 
@@ -1075,6 +1118,40 @@ ram_addr_t qemu_ram_alloc_from_ptr(ram_addr_t size, void *host,
     return addr;
 }
 
+// return -1 on error
+ram_addr_t qemu_ram_alloc_from_file(ram_addr_t size, int fd, uint64_t offset,
+        MemoryRegion *mr, Error **errp)
+{
+    RAMBlock *new_block;
+    ram_addr_t addr;
+    Error *local_err = NULL;
+
+    size = TARGET_PAGE_ALIGN(size);
+    new_block = g_malloc0(sizeof(*new_block));
+    if (new_block == NULL)
+        return -1;
+
+    new_block->mr = mr;
+    new_block->length = size;
+    new_block->fd = -1;
+    new_block->host = qemu_file_ram_alloc(fd, offset, size);
+    if (new_block->host == NULL) {
+        g_free(new_block);
+        error_setg_errno(errp, errno, "cannot map file for '%s'",
+                memory_region_name(mr));
+        return -1;
+    }
+    new_block->flags |= RAM_FILE;
+    addr = ram_block_add(mr->uc, new_block, &local_err);
+    if (local_err) {
+        qemu_file_ram_free(new_block->host, size);
+        g_free(new_block);
+        error_propagate(errp, local_err);
+        return -1;
+    }
+    return addr;
+}
+
 ram_addr_t qemu_ram_alloc(ram_addr_t size, MemoryRegion *mr, Error **errp)
 {
     return qemu_ram_alloc_from_ptr(size, NULL, mr, errp);
@@ -1087,6 +1164,7 @@ void qemu_ram_free_from_ptr(struct uc_struct *uc, ram_addr_t addr)
     QTAILQ_FOREACH(block, &uc->ram_list.blocks, next) {
         if (addr == block->offset) {
             QTAILQ_REMOVE(&uc->ram_list.blocks, block, next);
+            ram_block_removed(uc, block);
             uc->ram_list.mru_block = NULL;
             uc->ram_list.version++;
             g_free(block);
@@ -1102,10 +1180,13 @@ void qemu_ram_free(struct uc_struct *uc, ram_addr_t addr)
     QTAILQ_FOREACH(block, &uc->ram_list.blocks, next) {
         if (addr == block->offset) {
             QTAILQ_REMOVE(&uc->ram_list.blocks, block, next);
+            ram_block_removed(uc, block);
             uc->ram_list.mru_block = NULL;
             uc->ram_list.version++;
             if (block->flags & RAM_PREALLOC) {
                 ;
+            } else if (block->flags & RAM_FILE) {
+                qemu_file_ram_free(block->host, block->length);
 #ifndef _WIN32
             } else if (block->fd >= 0) {
                 munmap(block->host, block->length);
@@ -1191,10 +1272,56 @@ void *qemu_get_ram_block_host_ptr(struct uc_struct *uc, ram_addr_t addr)
    It should not be used for general purpose DMA.
    Use cpu_physical_memory_map/cpu_physical_memory_rw instead.
    */
+/* Call the page provider of a uc_mem_reserve() block for every page of
+   [offset, offset + len) that has not been touched yet.  */
+static void ram_block_populate(struct uc_struct *uc, RAMBlock *block,
+                               ram_addr_t offset, ram_addr_t len)
+{
+    MemoryRegion *mr = block->mr;
+    ram_addr_t page, last;
+
+    if (len == 0) {
+        return;
+    }
+
+    last = (MIN(offset + len, block->length) - 1) >> TARGET_PAGE_BITS;
+    for (page = offset >> TARGET_PAGE_BITS; page <= last; page++) {
+        if (!test_bit(page, mr->populated)) {
+            /* The block is only reserved address space: like a page the
+               host kernel cannot back, failing to commit one is fatal.  */
+            if (!qemu_anon_ram_commit(block->host + (page << TARGET_PAGE_BITS),
+                                      TARGET_PAGE_SIZE)) {
+                fprintf(stderr, "Could not commit reserved page " RAM_ADDR_FMT "\n",
+                        block->offset + (page << TARGET_PAGE_BITS));
+                abort();
+            }
+            /* Mark first, so a provider reading its own region is not
+               called again for this page.  */
+            set_bit(page, mr->populated);
+            mr->page_provider(uc, mr->addr + (page << TARGET_PAGE_BITS),
+                              block->host + (page << TARGET_PAGE_BITS),
+                              TARGET_PAGE_SIZE, mr->page_provider_data);
+        }
+    }
+}
+
+void qemu_ram_populate(struct uc_struct *uc, ram_addr_t addr, ram_addr_t len)
+{
+    RAMBlock *block = qemu_get_ram_block(uc, addr);
+
+    if (block->mr->page_provider) {
+        ram_block_populate(uc, block, addr - block->offset, len);
+    }
+}
+
 void *qemu_get_ram_ptr(struct uc_struct *uc, ram_addr_t addr)
 {
     RAMBlock *block = qemu_get_ram_block(uc, addr);
 
+    if (unlikely(block->mr->page_provider)) {
+        ram_block_populate(uc, block, addr - block->offset, 1);
+    }
+
     return block->host + (addr - block->offset);
 }
 
@@ -1211,6 +1338,9 @@ static void *qemu_ram_ptr_length(struct uc_struct *uc, ram_addr_t addr, hwaddr *
         if (addr - block->offset < block->length) {
             if (addr - block->offset + *size > block->length)
                 *size = block->length - addr + block->offset;
+            if (unlikely(block->mr->page_provider)) {
+                ram_block_populate(uc, block, addr - block->offset, *size);
+            }
             return block->host + (addr - block->offset);
         }
     }
@@ -1677,6 +1807,9 @@ bool address_space_rw(AddressSpace *as, hwaddr addr, uint8_t *buf,
             } else {
                 addr1 += memory_region_get_ram_addr(mr);
                 /* RAM case */
+                if (unlikely(mr->page_provider)) {
+                    qemu_ram_populate(as->uc, addr1, l);
+                }
                 ptr = qemu_get_ram_ptr(as->uc, addr1);
                 memcpy(ptr, buf, l);
                 invalidate_and_set_dirty(as->uc, addr1, l);
@@ -1712,6 +1845,9 @@ bool address_space_rw(AddressSpace *as, hwaddr addr, uint8_t *buf,
                 }
             } else {
                 /* RAM case */
+                if (unlikely(mr->page_provider)) {
+                    qemu_ram_populate(as->uc, mr->ram_addr + addr1, l);
+                }
                 ptr = qemu_get_ram_ptr(as->uc, mr->ram_addr + addr1);
                 memcpy(buf, ptr, l);
             }
@@ -1765,6 +1901,9 @@ static inline void cpu_physical_memory_write_rom_internal(AddressSpace *as,
         } else {
             addr1 += memory_region_get_ram_addr(mr);
             /* ROM/RAM case */
+            if (unlikely(mr->page_provider)) {
+                qemu_ram_populate(as->uc, addr1, l);
+            }
             ptr = qemu_get_ram_ptr(as->uc, addr1);
             switch (type) {
                 case WRITE_DATA:
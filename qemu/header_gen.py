@@ -18,14 +18,28 @@ symbols = (
     'tb_invalidate_phys_page_fast',
     'phys_mem_clean',
     'tb_cleanup',
+    'tb_cache_open',
+    'tb_cache_load',
+    'tb_cache_store',
+    'tb_cache_close',
     'memory_map',
     'memory_map_ptr',
+    'memory_map_file',
+    'memory_map_lazy',
+    'memory_map_io',
     'memory_unmap',
+    'memory_batch_begin',
+    'memory_batch_end',
     'memory_free',
     'free_code_gen_buffer',
     'helper_raise_exception',
     'tcg_enabled',
     'tcg_exec_init',
+    'tcg_exec_memory',
+    'tb_translate_range',
+    'tb_prof_env_pc',
+    'tb_prof_resolve',
+    'tb_fold_counts',
     'memory_register_types',
     'cpu_exec_init_all',
     'vm_start',
@@ -2048,6 +2062,7 @@ symbols = (
     'memory_region_init_io',
     'memory_region_init_ram',
     'memory_region_init_ram_ptr',
+    'memory_region_init_ram_file',
     'memory_region_init_reservation',
     'memory_region_is_iommu',
     'memory_region_is_logging',
@@ -2371,8 +2386,6 @@ symbols = (
     'qdict_size',
     'qdict_type',
     'qemu_clock_get_us',
-    'qemu_clock_ptr',
-    'qemu_clocks',
     'qemu_get_cpu',
     'qemu_get_guest_memory_mapping',
     'qemu_get_guest_simple_memory_mapping',
@@ -2380,6 +2393,7 @@ symbols = (
     'qemu_get_ram_block_host_ptr',
     'qemu_get_ram_fd',
     'qemu_get_ram_ptr',
+    'qemu_ram_populate',
     'qemu_host_page_mask',
     'qemu_host_page_size',
     'qemu_init_vcpu',
@@ -2395,6 +2409,7 @@ symbols = (
     'qemu_ram_addr_from_host_nofail',
     'qemu_ram_alloc',
     'qemu_ram_alloc_from_ptr',
+    'qemu_ram_alloc_from_file',
     'qemu_ram_foreach_block',
     'qemu_ram_free',
     'qemu_ram_free_from_ptr',
@@ -2658,6 +2673,7 @@ symbols = (
     'tb_flush_jmp_cache',
     'tb_free',
     'tb_gen_code',
+    'tb_gen_hot',
     'tb_hash_remove',
     'tb_invalidate_phys_addr',
     'tb_invalidate_phys_page_range',
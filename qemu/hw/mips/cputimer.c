@@ -26,18 +26,17 @@
 
 #define TIMER_FREQ	100 * 1000 * 1000
 
-/* XXX: do not use a global */
 uint32_t cpu_mips_get_random (CPUMIPSState *env)
 {
-    static uint32_t lfsr = 1;
-    static uint32_t prev_idx = 0;
+    CPUMIPSTLBContext *tlb = env->tlb;
     uint32_t idx;
     /* Don't return same value twice, so get another value */
     do {
-        lfsr = (lfsr >> 1) ^ ((0-(lfsr & 1u)) & 0xd0000001u);
-        idx = lfsr % (env->tlb->nb_tlb - env->CP0_Wired) + env->CP0_Wired;
-    } while (idx == prev_idx);
-    prev_idx = idx;
+        tlb->random_lfsr = (tlb->random_lfsr >> 1) ^
+                           ((0-(tlb->random_lfsr & 1u)) & 0xd0000001u);
+        idx = tlb->random_lfsr % (tlb->nb_tlb - env->CP0_Wired) + env->CP0_Wired;
+    } while (idx == tlb->random_prev_idx);
+    tlb->random_prev_idx = idx;
     return idx;
 }
 
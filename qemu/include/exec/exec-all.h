@@ -83,6 +83,7 @@ void QEMU_NORETURN cpu_io_recompile(CPUState *cpu, uintptr_t retaddr);
 TranslationBlock *tb_gen_code(CPUState *cpu,
                               target_ulong pc, target_ulong cs_base, int flags,
                               int cflags);
+TranslationBlock *tb_gen_hot(CPUState *cpu, TranslationBlock *tb);
 void cpu_exec_init(CPUArchState *env, void *opaque);
 
 void QEMU_NORETURN cpu_loop_exit(CPUState *cpu);
@@ -114,8 +115,12 @@ static inline void tlb_flush(CPUState *cpu, int flush_global)
 
 #define CODE_GEN_ALIGN           16 /* must be >= of the size of a icache line */
 
+/* The physical TB hash starts with uc->tb_hash_bits bits (default
+   CODE_GEN_PHYS_HASH_BITS) and doubles as TBs are added, up to
+   CODE_GEN_PHYS_HASH_MAX_BITS.  tb_flush() shrinks it back.  */
 #define CODE_GEN_PHYS_HASH_BITS     15
-#define CODE_GEN_PHYS_HASH_SIZE     (1 << CODE_GEN_PHYS_HASH_BITS)
+#define CODE_GEN_PHYS_HASH_MIN_BITS 6
+#define CODE_GEN_PHYS_HASH_MAX_BITS 20
 
 /* estimated block size for TB allocation */
 /* XXX: use a per code average code fragment size and modulate it
@@ -140,9 +145,12 @@ struct TranslationBlock {
     uint64_t flags; /* flags defining in which context the code was generated */
     uint16_t size;      /* size of target code for this block (1 <=
                            size <= TARGET_PAGE_SIZE) */
-    uint16_t cflags;    /* compile flags */
+    uint32_t cflags;    /* compile flags */
 #define CF_COUNT_MASK  0x7fff
 #define CF_LAST_IO     0x8000 /* Last insn may be an IO access.  */
+#define CF_COLD        0x10000 /* first tier: unoptimized, never chained to */
+#define CF_SUPERBLOCK  0x20000 /* may follow direct jumps within the page */
+#define CF_QUANTUM     0x40000 /* counts down CPUState.quantum, see uc_sched_start() */
 
     void *tc_ptr;    /* pointer to the translated code */
     /* next matching tb for physical address. */
@@ -167,6 +175,12 @@ struct TranslationBlock {
     struct TranslationBlock *jmp_next[2];
     struct TranslationBlock *jmp_first;
     uint32_t icount;
+    /* Unicorn: executions of a CF_COLD TB, see tb_gen_hot() */
+    uint32_t exec_count;
+    /* Unicorn: all executions, counted by the TB itself with
+       UC_OPT_TB_COUNTS, and the size of its host code */
+    uint64_t counter;
+    uint32_t tc_size;
 };
 
 typedef struct TBContext TBContext;
@@ -174,7 +188,9 @@ typedef struct TBContext TBContext;
 struct TBContext {
 
     TranslationBlock *tbs;
-    TranslationBlock *tb_phys_hash[CODE_GEN_PHYS_HASH_SIZE];
+    TranslationBlock **tb_phys_hash;
+    unsigned int tb_phys_hash_bits;
+    unsigned int tb_phys_hash_init_bits;
     int nb_tbs;
 
     /* statistics */
@@ -199,9 +215,9 @@ static inline unsigned int tb_jmp_cache_hash_func(target_ulong pc)
         | (tmp & TB_JMP_ADDR_MASK));
 }
 
-static inline unsigned int tb_phys_hash_func(tb_page_addr_t pc)
+static inline unsigned int tb_phys_hash_func(tb_page_addr_t pc, unsigned int bits)
 {
-    return (pc >> 2) & (CODE_GEN_PHYS_HASH_SIZE - 1);
+    return (pc >> 2) & ((1u << bits) - 1);
 }
 
 void tb_free(struct uc_struct *uc, TranslationBlock *tb);
@@ -359,6 +375,10 @@ extern int singlestep;
 
 /* cpu-exec.c */
 extern volatile sig_atomic_t exit_request;
+uc_err tb_translate_range(struct uc_struct *uc, uint64_t begin, uint64_t end);
+uint64_t tb_prof_env_pc(struct uc_struct *uc);
+void tb_fold_counts(struct uc_struct *uc);
+bool tb_prof_resolve(struct uc_struct *uc, uintptr_t host_pc, uint64_t *pc);
 
 /**
  * cpu_can_do_io:
@@ -21,6 +21,44 @@ static inline void gen_tb_start(TCGContext *tcg_ctx)
     tcg_gen_brcondi_i32(tcg_ctx, TCG_COND_NE, flag, 0, tcg_ctx->exitreq_label);
     tcg_temp_free_i32(tcg_ctx, flag);
 
+    /* Unicorn: a guest thread whose quantum is used up leaves before the
+       block runs, so the scheduler switches at a TB boundary.  The block
+       is charged in advance; it may overrun the quantum by its own size. */
+    if (tcg_ctx->code_gen_quantum) {
+        TCGv_i32 count;
+
+        tcg_ctx->quantum_label = gen_new_label(tcg_ctx);
+        count = tcg_temp_local_new_i32(tcg_ctx);
+        tcg_gen_ld_i32(tcg_ctx, count, tcg_ctx->cpu_env,
+                       offsetof(CPUState, quantum) - ENV_OFFSET);
+        tcg_gen_brcondi_i32(tcg_ctx, TCG_COND_LE, count, 0, tcg_ctx->quantum_label);
+
+        imm = tcg_temp_new_i32(tcg_ctx);
+        tcg_gen_movi_i32(tcg_ctx, imm, 0xdeadbeef);
+        /* the instruction count is only known at gen_tb_end() */
+        i = tcg_ctx->gen_last_op_idx;
+        i = tcg_ctx->gen_op_buf[i].args;
+        tcg_ctx->quantum_arg = &tcg_ctx->gen_opparam_buf[i + 1];
+
+        tcg_gen_sub_i32(tcg_ctx, count, count, imm);
+        tcg_temp_free_i32(tcg_ctx, imm);
+        tcg_gen_st_i32(tcg_ctx, count, tcg_ctx->cpu_env,
+                       offsetof(CPUState, quantum) - ENV_OFFSET);
+        tcg_temp_free_i32(tcg_ctx, count);
+    }
+
+    /* Unicorn: exact execution count, see uc_tb_counts_read() */
+    if (tcg_ctx->code_gen_counter) {
+        TCGv_ptr ptr = tcg_const_ptr(tcg_ctx, tcg_ctx->code_gen_counter);
+        TCGv_i64 count = tcg_temp_new_i64(tcg_ctx);
+
+        tcg_gen_ld_i64(tcg_ctx, count, ptr, 0);
+        tcg_gen_addi_i64(tcg_ctx, count, count, 1);
+        tcg_gen_st_i64(tcg_ctx, count, ptr, 0);
+        tcg_temp_free_i64(tcg_ctx, count);
+        tcg_temp_free_ptr(tcg_ctx, ptr);
+    }
+
 #if 0
     if (!(tb->cflags & CF_USE_ICOUNT)) {
         return;
@@ -54,6 +92,12 @@ static inline void gen_tb_end(TCGContext *tcg_ctx, TranslationBlock *tb, int num
     gen_set_label(tcg_ctx, tcg_ctx->exitreq_label);
     tcg_gen_exit_tb(tcg_ctx, (uintptr_t)tb + TB_EXIT_REQUESTED);
 
+    if (tcg_ctx->code_gen_quantum) {
+        *tcg_ctx->quantum_arg = num_insns;
+        gen_set_label(tcg_ctx, tcg_ctx->quantum_label);
+        tcg_gen_exit_tb(tcg_ctx, (uintptr_t)tb + TB_EXIT_ICOUNT_EXPIRED);
+    }
+
 #if 0
     if (use_icount) {
         *icount_arg = num_insns;
@@ -20,6 +20,7 @@
 #define DIRTY_MEMORY_NUM       1        /* num of dirty bits */
 
 #include "unicorn/platform.h"
+#include "unicorn/unicorn.h"
 #include "qemu-common.h"
 #include "exec/cpu-common.h"
 #include "exec/hwaddr.h"
@@ -158,6 +159,10 @@ struct MemoryRegion {
     struct uc_struct *uc;
     uint32_t perms;   //all perms, partially redundant with readonly
     uint64_t end;
+    // uc_mem_reserve(): fills each page on first touch
+    uc_cb_page_provider_t page_provider;
+    void *page_provider_data;
+    unsigned long *populated;   // pages already filled by page_provider
 };
 
 /**
@@ -333,6 +338,29 @@ void memory_region_init_ram_ptr(struct uc_struct *uc, MemoryRegion *mr,
                                 uint64_t size,
                                 void *ptr);
 
+/**
+ * memory_region_init_ram_file:  Initialize RAM memory region from a private,
+ *                               copy-on-write mapping of a file.  Guest
+ *                               writes never reach the file.
+ *
+ * @mr: the #MemoryRegion to be initialized.
+ * @owner: the object that tracks the region's reference count
+ * @name: the name of the region.
+ * @size: size of the region; bytes past the end of the file read as zero.
+ * @perms: UC_PROT_* permissions of the region.
+ * @fd: file descriptor to map.
+ * @offset: offset into the file; must be page aligned.
+ * @errp: pointer to Error*, to store an error if it happens.
+ */
+void memory_region_init_ram_file(struct uc_struct *uc, MemoryRegion *mr,
+                                 struct Object *owner,
+                                 const char *name,
+                                 uint64_t size,
+                                 uint32_t perms,
+                                 int fd,
+                                 uint64_t offset,
+                                 Error **errp);
+
 /**
  * memory_region_init_alias: Initialize a memory region that aliases all or a
  *                           part of another memory region.
@@ -856,7 +884,14 @@ void memory_register_types(struct uc_struct *uc);
 
 MemoryRegion *memory_map(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms);
 MemoryRegion *memory_map_ptr(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms, void *ptr);
+MemoryRegion *memory_map_lazy(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms,
+        uc_cb_page_provider_t provider, void *user_data);
+MemoryRegion *memory_map_file(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms, int fd, uint64_t offset);
+MemoryRegion *memory_map_io(struct uc_struct *uc, hwaddr begin, size_t size,
+        uc_cb_mmio_read_t read_cb, uc_cb_mmio_write_t write_cb, void *user_data);
 void memory_unmap(struct uc_struct *uc, MemoryRegion *mr);
+void memory_batch_begin(struct uc_struct *uc);
+void memory_batch_end(struct uc_struct *uc);
 int memory_free(struct uc_struct *uc);
 
 #endif
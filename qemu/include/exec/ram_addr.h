@@ -26,9 +26,12 @@
 ram_addr_t qemu_ram_alloc_from_ptr(ram_addr_t size, void *host,
                                    MemoryRegion *mr, Error **errp);
 ram_addr_t qemu_ram_alloc(ram_addr_t size, MemoryRegion *mr, Error **errp);
+ram_addr_t qemu_ram_alloc_from_file(ram_addr_t size, int fd, uint64_t offset,
+                                    MemoryRegion *mr, Error **errp);
 int qemu_get_ram_fd(struct uc_struct *uc, ram_addr_t addr);
 void *qemu_get_ram_block_host_ptr(struct uc_struct *uc, ram_addr_t addr);
 void *qemu_get_ram_ptr(struct uc_struct *uc, ram_addr_t addr);
+void qemu_ram_populate(struct uc_struct *uc, ram_addr_t addr, ram_addr_t len);
 void qemu_ram_free(struct uc_struct *c, ram_addr_t addr);
 void qemu_ram_free_from_ptr(struct uc_struct *uc, ram_addr_t addr);
 
@@ -166,6 +166,7 @@ void *qemu_oom_check(void *ptr);
 /* Error handling.  */
 
 void tcg_exec_init(struct uc_struct *uc, unsigned long tb_size);
+size_t tcg_exec_memory(struct uc_struct *uc);
 bool tcg_enabled(struct uc_struct *uc);
 
 struct uc_struct;
@@ -26,6 +26,7 @@
  * Note that nbits should be always a compile time evaluable constant.
  * Otherwise many inlines will generate horrible code.
  *
+ * bitmap_zero(dst, nbits)			*dst = 0UL
  * bitmap_set(dst, pos, nbits)			Set specified bit area
  * bitmap_clear(dst, pos, nbits)		Clear specified bit area
  */
@@ -46,6 +47,11 @@
 #define DECLARE_BITMAP(name,bits)                  \
         unsigned long name[BITS_TO_LONGS(bits)]
 
+static inline void bitmap_zero(unsigned long *dst, long nbits)
+{
+    memset(dst, 0, BITS_TO_LONGS(nbits) * sizeof(unsigned long));
+}
+
 void bitmap_set(unsigned long *map, long i, long len);
 void bitmap_clear(unsigned long *map, long start, long nr);
 
@@ -0,0 +1,69 @@
+/*
+ * Host CPU acceleration for guest crypto instructions
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_HOST_CRYPTO_H
+#define QEMU_HOST_CRYPTO_H
+
+#include "qemu-common.h"
+
+/* AES-NI, PCLMULQDQ and SSE4.2 are only reachable through <cpuid.h> and
+   target-specific intrinsics, which need GCC >= 4.9 or clang.  Everything
+   else keeps using the table-driven code in util/aes.c and util/crc32c.c.  */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(CONFIG_CPUID_H) && \
+    (defined(__clang__) || QEMU_GNUC_PREREQ(4, 9))
+#define CONFIG_HOST_CRYPTO 1
+#endif
+
+#define HOST_CRYPTO_PROBED  (1u << 0)
+#define HOST_CRYPTO_AES     (1u << 1)   /* AES-NI */
+#define HOST_CRYPTO_CLMUL   (1u << 2)   /* PCLMULQDQ */
+#define HOST_CRYPTO_CRC32C  (1u << 3)   /* SSE4.2 CRC32 */
+
+#ifdef CONFIG_HOST_CRYPTO
+/* Probed once; every engine sees the same value afterwards. */
+extern unsigned int host_crypto_flags;
+void host_crypto_probe(void);
+
+static inline bool host_crypto_has(unsigned int feature)
+{
+    if (unlikely(!(host_crypto_flags & HOST_CRYPTO_PROBED))) {
+        host_crypto_probe();
+    }
+    return (host_crypto_flags & feature) != 0;
+}
+#else
+static inline bool host_crypto_has(unsigned int feature)
+{
+    return false;
+}
+#endif
+
+/* All 128-bit operands are 16 bytes in AES (FIPS-197) byte order, which is
+   also the in-memory order of an x86 XMM register and of an ARM Q register
+   on a little-endian host.  Callers must check host_crypto_has() first.  */
+
+/* One full AES round, as done by x86 AESENC/AESDEC. */
+void host_aes_enc(void *d, const void *st, const void *rk);
+void host_aes_dec(void *d, const void *st, const void *rk);
+/* Final AES round without (Inv)MixColumns: AESENCLAST/AESDECLAST. */
+void host_aes_enclast(void *d, const void *st, const void *rk);
+void host_aes_declast(void *d, const void *st, const void *rk);
+/* (Inv)MixColumns only: ARM AESMC/AESIMC and x86 AESIMC. */
+void host_aes_mc(void *d, const void *st);
+void host_aes_imc(void *d, const void *st);
+
+/* Carry-less 64x64->128 multiply: x86 PCLMULQDQ, ARM PMULL.P64. */
+void host_clmul(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi);
+
+/* Raw CRC32C step (no pre/post inversion) over the low @bytes of @val,
+   exactly as the x86 CRC32 instruction computes it. */
+uint32_t host_crc32c_le(uint32_t crc, uint64_t val, unsigned int bytes);
+/* CRC32C over a buffer, without pre/post inversion. */
+uint32_t host_crc32c_buf(uint32_t crc, const uint8_t *data,
+                         unsigned int length);
+
+#endif
@@ -107,6 +107,11 @@ void *qemu_memalign(size_t alignment, size_t size);
 void *qemu_anon_ram_alloc(size_t size, uint64_t *align);
 void qemu_vfree(void *ptr);
 void qemu_anon_ram_free(void *ptr, size_t size);
+void *qemu_anon_ram_reserve(size_t size);
+bool qemu_anon_ram_commit(void *ptr, size_t size);
+void *qemu_file_ram_alloc(int fd, uint64_t offset, size_t size);
+size_t qemu_file_ram_align(void);
+void qemu_file_ram_free(void *ptr, size_t size);
 
 #if defined(__HAIKU__) && defined(__i386__)
 #define FMT_pid "%ld"
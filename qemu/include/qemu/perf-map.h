@@ -0,0 +1,26 @@
+/*
+ * Symbols for translated code in Linux perf
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_PERF_MAP_H
+#define QEMU_PERF_MAP_H
+
+#include "qemu-common.h"
+
+#define PERF_MAP_SYMBOLS    (1u << 0)   /* /tmp/perf-<pid>.map */
+#define PERF_MAP_JITDUMP    (1u << 1)   /* jit-<pid>.dump, for perf inject */
+
+/* Both outputs are per process and shared by all engines.  Open returns
+   the subset of @outputs that could be opened, which must be given back
+   to perf_map_close().  Everywhere but Linux nothing is ever opened.  */
+unsigned int perf_map_open(unsigned int outputs);
+void perf_map_close(unsigned int outputs);
+
+/* Name the host code at [@code, @code + @size) "guest:<@arch>:0x<@pc>" */
+void perf_map_add(unsigned int outputs, const char *arch,
+                  const void *code, size_t size, uint64_t pc);
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Static tracepoints at engine events
+ *
+ * When configure finds <sys/sdt.h> (systemtap-sdt-dev on Debian, systemtap-
+ * sdt-devel on Fedora), each probe below is a single nop plus an ELF note
+ * naming it, so bpftrace, perf or systemtap can attach to a running engine
+ * without a rebuild:
+ *
+ *   bpftrace -e 'usdt:./libunicorn.so:unicorn:tb_translate_done
+ *                { @ns = hist(arg3); }'
+ *
+ * Nothing is evaluated beyond the arguments, which are values the code at
+ * each site already has.  Latencies that are not measured anyway come from
+ * a pair of probes.  Without the header the probes compile to nothing.
+ *
+ * Probes and their arguments:
+ *
+ *   cpu_exec_enter(pc)                  cpu_exec() starts running the guest
+ *   cpu_exec_exit(ret, ns)              ... and returns EXCP_* after @ns
+ *   tb_translate_start(pc, flags)       tb_gen_code() starts translating
+ *   tb_translate_done(pc, size, host_size, ns)
+ *   tb_flush(tbs, code_bytes)           every translation is dropped
+ *   tb_invalidate(pc, size)             one translation is dropped
+ *   tlb_fill(vaddr, paddr, prot)        a TLB miss installed an entry
+ *   mem_hook_enter(type, addr, size)    a UC_HOOK_MEM_READ, _READ_AFTER or
+ *   mem_hook_return(type, addr)         _WRITE callback is called, returned
+ *   mem_map(address, size, perms)       uc_mem_map() and its variants
+ *   mem_unmap(address, size)            uc_mem_unmap()
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#ifndef QEMU_PROBES_H
+#define QEMU_PROBES_H
+
+#ifdef CONFIG_SDT_H
+
+#include <sys/sdt.h>
+
+#define UC_PROBE1(name, a)          DTRACE_PROBE1(unicorn, name, a)
+#define UC_PROBE2(name, a, b)       DTRACE_PROBE2(unicorn, name, a, b)
+#define UC_PROBE3(name, a, b, c)    DTRACE_PROBE3(unicorn, name, a, b, c)
+#define UC_PROBE4(name, a, b, c, d) DTRACE_PROBE4(unicorn, name, a, b, c, d)
+
+#else
+
+#define UC_PROBE1(name, a)          do { } while (0)
+#define UC_PROBE2(name, a, b)       do { } while (0)
+#define UC_PROBE3(name, a, b, c)    do { } while (0)
+#define UC_PROBE4(name, a, b, c, d) do { } while (0)
+
+#endif
+
+#endif
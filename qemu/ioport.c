@@ -70,8 +70,10 @@ void cpu_outb(struct uc_struct *uc, pio_addr_t addr, uint8_t val)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_OUT)
+        if (hook->insn == UC_X86_INS_OUT) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             ((uc_cb_insn_out_t)hook->callback)(uc, addr, 1, val, hook->user_data);
+        }
     }
 }
 
@@ -82,8 +84,10 @@ void cpu_outw(struct uc_struct *uc, pio_addr_t addr, uint16_t val)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_OUT)
+        if (hook->insn == UC_X86_INS_OUT) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             ((uc_cb_insn_out_t)hook->callback)(uc, addr, 2, val, hook->user_data);
+        }
     }
 }
 
@@ -94,8 +98,10 @@ void cpu_outl(struct uc_struct *uc, pio_addr_t addr, uint32_t val)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_OUT)
+        if (hook->insn == UC_X86_INS_OUT) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             ((uc_cb_insn_out_t)hook->callback)(uc, addr, 4, val, hook->user_data);
+        }
     }
 }
 
@@ -106,8 +112,10 @@ uint8_t cpu_inb(struct uc_struct *uc, pio_addr_t addr)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_IN)
+        if (hook->insn == UC_X86_INS_IN) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             return ((uc_cb_insn_in_t)hook->callback)(uc, addr, 1, hook->user_data);
+        }
     }
 
     return 0;
@@ -120,8 +128,10 @@ uint16_t cpu_inw(struct uc_struct *uc, pio_addr_t addr)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_IN)
+        if (hook->insn == UC_X86_INS_IN) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             return ((uc_cb_insn_in_t)hook->callback)(uc, addr, 2, hook->user_data);
+        }
     }
 
     return 0;
@@ -134,8 +144,10 @@ uint32_t cpu_inl(struct uc_struct *uc, pio_addr_t addr)
     struct hook *hook;
     HOOK_FOREACH_VAR_DECLARE;
     HOOK_FOREACH(uc, hook, UC_HOOK_INSN) {
-        if (hook->insn == UC_X86_INS_IN)
+        if (hook->insn == UC_X86_INS_IN) {
+            HOOK_COUNT(uc, UC_HOOK_INSN);
             return ((uc_cb_insn_in_t)hook->callback)(uc, addr, 4, hook->user_data);
+        }
     }
 
     return 0;
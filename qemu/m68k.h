@@ -12,14 +12,28 @@
 #define tb_invalidate_phys_page_fast tb_invalidate_phys_page_fast_m68k
 #define phys_mem_clean phys_mem_clean_m68k
 #define tb_cleanup tb_cleanup_m68k
+#define tb_cache_open tb_cache_open_m68k
+#define tb_cache_load tb_cache_load_m68k
+#define tb_cache_store tb_cache_store_m68k
+#define tb_cache_close tb_cache_close_m68k
 #define memory_map memory_map_m68k
 #define memory_map_ptr memory_map_ptr_m68k
+#define memory_map_file memory_map_file_m68k
+#define memory_map_lazy memory_map_lazy_m68k
+#define memory_map_io memory_map_io_m68k
 #define memory_unmap memory_unmap_m68k
+#define memory_batch_begin memory_batch_begin_m68k
+#define memory_batch_end memory_batch_end_m68k
 #define memory_free memory_free_m68k
 #define free_code_gen_buffer free_code_gen_buffer_m68k
 #define helper_raise_exception helper_raise_exception_m68k
 #define tcg_enabled tcg_enabled_m68k
 #define tcg_exec_init tcg_exec_init_m68k
+#define tcg_exec_memory tcg_exec_memory_m68k
+#define tb_translate_range tb_translate_range_m68k
+#define tb_prof_env_pc tb_prof_env_pc_m68k
+#define tb_prof_resolve tb_prof_resolve_m68k
+#define tb_fold_counts tb_fold_counts_m68k
 #define memory_register_types memory_register_types_m68k
 #define cpu_exec_init_all cpu_exec_init_all_m68k
 #define vm_start vm_start_m68k
@@ -2042,6 +2056,7 @@
 #define memory_region_init_io memory_region_init_io_m68k
 #define memory_region_init_ram memory_region_init_ram_m68k
 #define memory_region_init_ram_ptr memory_region_init_ram_ptr_m68k
+#define memory_region_init_ram_file memory_region_init_ram_file_m68k
 #define memory_region_init_reservation memory_region_init_reservation_m68k
 #define memory_region_is_iommu memory_region_is_iommu_m68k
 #define memory_region_is_logging memory_region_is_logging_m68k
@@ -2365,8 +2380,6 @@
 #define qdict_size qdict_size_m68k
 #define qdict_type qdict_type_m68k
 #define qemu_clock_get_us qemu_clock_get_us_m68k
-#define qemu_clock_ptr qemu_clock_ptr_m68k
-#define qemu_clocks qemu_clocks_m68k
 #define qemu_get_cpu qemu_get_cpu_m68k
 #define qemu_get_guest_memory_mapping qemu_get_guest_memory_mapping_m68k
 #define qemu_get_guest_simple_memory_mapping qemu_get_guest_simple_memory_mapping_m68k
@@ -2374,6 +2387,7 @@
 #define qemu_get_ram_block_host_ptr qemu_get_ram_block_host_ptr_m68k
 #define qemu_get_ram_fd qemu_get_ram_fd_m68k
 #define qemu_get_ram_ptr qemu_get_ram_ptr_m68k
+#define qemu_ram_populate qemu_ram_populate_m68k
 #define qemu_host_page_mask qemu_host_page_mask_m68k
 #define qemu_host_page_size qemu_host_page_size_m68k
 #define qemu_init_vcpu qemu_init_vcpu_m68k
@@ -2389,6 +2403,7 @@
 #define qemu_ram_addr_from_host_nofail qemu_ram_addr_from_host_nofail_m68k
 #define qemu_ram_alloc qemu_ram_alloc_m68k
 #define qemu_ram_alloc_from_ptr qemu_ram_alloc_from_ptr_m68k
+#define qemu_ram_alloc_from_file qemu_ram_alloc_from_file_m68k
 #define qemu_ram_foreach_block qemu_ram_foreach_block_m68k
 #define qemu_ram_free qemu_ram_free_m68k
 #define qemu_ram_free_from_ptr qemu_ram_free_from_ptr_m68k
@@ -2652,6 +2667,7 @@
 #define tb_flush_jmp_cache tb_flush_jmp_cache_m68k
 #define tb_free tb_free_m68k
 #define tb_gen_code tb_gen_code_m68k
+#define tb_gen_hot tb_gen_hot_m68k
 #define tb_hash_remove tb_hash_remove_m68k
 #define tb_invalidate_phys_addr tb_invalidate_phys_addr_m68k
 #define tb_invalidate_phys_page_range tb_invalidate_phys_page_range_m68k
@@ -42,7 +42,8 @@ MemoryRegion *memory_map(struct uc_struct *uc, hwaddr begin, size_t size, uint32
 
     memory_region_add_subregion(get_system_memory(uc), begin, ram);
 
-    if (uc->current_cpu)
+    // a batch flushes once in memory_batch_end()
+    if (uc->current_cpu && !uc->memory_region_transaction_depth)
         tlb_flush(uc->current_cpu, 1);
 
     return ram;
@@ -60,23 +61,161 @@ MemoryRegion *memory_map_ptr(struct uc_struct *uc, hwaddr begin, size_t size, ui
 
     memory_region_add_subregion(get_system_memory(uc), begin, ram);
 
-    if (uc->current_cpu)
+    // a batch flushes once in memory_batch_end()
+    if (uc->current_cpu && !uc->memory_region_transaction_depth)
+        tlb_flush(uc->current_cpu, 1);
+
+    return ram;
+}
+
+MemoryRegion *memory_map_file(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms, int fd, uint64_t offset)
+{
+    MemoryRegion *ram = g_new(MemoryRegion, 1);
+    Error *err = NULL;
+
+    memory_region_init_ram_file(uc, ram, NULL, "pc.ram", size, perms, fd, offset, &err);
+    if (ram->ram_addr == -1) {
+        // could not map the file
+        error_free(err);
+        return NULL;
+    }
+
+    memory_region_add_subregion(get_system_memory(uc), begin, ram);
+
+    if (uc->current_cpu && !uc->memory_region_transaction_depth)
         tlb_flush(uc->current_cpu, 1);
 
     return ram;
 }
 
+static void memory_region_destructor_ram_lazy(MemoryRegion *mr)
+{
+    void *host = qemu_get_ram_block_host_ptr(mr->uc, mr->ram_addr);
+
+    g_free(mr->populated);
+    // the block does not own the reservation
+    qemu_ram_free(mr->uc, mr->ram_addr);
+    qemu_anon_ram_free(host, int128_get64(mr->size));
+}
+
+MemoryRegion *memory_map_lazy(struct uc_struct *uc, hwaddr begin, size_t size, uint32_t perms,
+        uc_cb_page_provider_t provider, void *user_data)
+{
+    // address space only: pages are committed as the provider fills them,
+    // so pages it never fills cost nothing, overcommit or not
+    void *host = qemu_anon_ram_reserve(size);
+    MemoryRegion *ram;
+
+    if (host == NULL)
+        return NULL;
+
+    ram = g_new(MemoryRegion, 1);
+    memory_region_init_ram_ptr(uc, ram, NULL, "pc.ram", size, host);
+    if (!(perms & UC_PROT_WRITE))
+        ram->readonly = true;
+    ram->perms = perms;
+
+    ram->destructor = memory_region_destructor_ram_lazy;
+    ram->page_provider = provider;
+    ram->page_provider_data = user_data;
+    ram->populated = g_new0(unsigned long, BITS_TO_LONGS(size >> TARGET_PAGE_BITS));
+
+    memory_region_add_subregion(get_system_memory(uc), begin, ram);
+
+    if (uc->current_cpu && !uc->memory_region_transaction_depth)
+        tlb_flush(uc->current_cpu, 1);
+
+    return ram;
+}
+
+// callbacks of a uc_mmio_map() region, kept in MemoryRegion::opaque
+typedef struct mmio_cbs {
+    uc_cb_mmio_read_t read;
+    uc_cb_mmio_write_t write;
+    void *user_data;
+} mmio_cbs;
+
+static uint64_t mmio_read_wrapper(struct uc_struct *uc, void *opaque, hwaddr addr, unsigned size)
+{
+    mmio_cbs *cbs = (mmio_cbs *)opaque;
+
+    if (cbs->read)
+        return cbs->read(uc, addr, size, cbs->user_data);
+
+    return 0;
+}
+
+static void mmio_write_wrapper(struct uc_struct *uc, void *opaque, hwaddr addr, uint64_t data, unsigned size)
+{
+    mmio_cbs *cbs = (mmio_cbs *)opaque;
+
+    if (cbs->write)
+        cbs->write(uc, addr, size, data, cbs->user_data);
+}
+
+static const MemoryRegionOps mmio_ops = {
+    mmio_read_wrapper,
+    mmio_write_wrapper,
+    DEVICE_NATIVE_ENDIAN,
+    {1, 8, false, NULL},    // valid
+    {1, 8, false},          // impl
+};
+
+static void memory_region_destructor_mmio(MemoryRegion *mr)
+{
+    g_free(mr->opaque);
+}
+
+MemoryRegion *memory_map_io(struct uc_struct *uc, hwaddr begin, size_t size,
+        uc_cb_mmio_read_t read_cb, uc_cb_mmio_write_t write_cb, void *user_data)
+{
+    MemoryRegion *mmio = g_new(MemoryRegion, 1);
+    mmio_cbs *cbs = g_new(mmio_cbs, 1);
+
+    cbs->read = read_cb;
+    cbs->write = write_cb;
+    cbs->user_data = user_data;
+
+    memory_region_init_io(uc, mmio, NULL, &mmio_ops, cbs, "pc.mmio", size);
+    mmio->destructor = memory_region_destructor_mmio;
+    mmio->perms = 0;
+    if (read_cb)
+        mmio->perms |= UC_PROT_READ;
+    if (write_cb)
+        mmio->perms |= UC_PROT_WRITE;
+
+    memory_region_add_subregion(get_system_memory(uc), begin, mmio);
+
+    if (uc->current_cpu && !uc->memory_region_transaction_depth)
+        tlb_flush(uc->current_cpu, 1);
+
+    return mmio;
+}
+
 static void memory_region_update_container_subregions(MemoryRegion *subregion);
 
+static void memory_region_free_unmapped(MemoryRegion *mr)
+{
+    Object *obj;
+
+    mr->destructor(mr);
+    obj = OBJECT(mr);
+    obj->ref = 1;
+    obj->free = g_free;
+    g_free((char *)mr->name);
+    mr->name = NULL;
+    object_property_del_child(mr->uc, qdev_get_machine(mr->uc), obj, &error_abort);
+}
+
 void memory_unmap(struct uc_struct *uc, MemoryRegion *mr)
 {
     int i;
     target_ulong addr;
-    Object *obj;
 
     // Make sure all pages associated with the MemoryRegion are flushed
     // Only need to do this if we are in a running state
-    if (uc->current_cpu) {
+    // (a batch flushes the whole TLB once in memory_batch_end())
+    if (uc->current_cpu && !uc->memory_region_transaction_depth) {
         for (addr = mr->addr; addr < mr->end; addr += uc->target_page_size) {
            tlb_flush_page(uc->current_cpu, addr);
         }
@@ -88,18 +227,40 @@ void memory_unmap(struct uc_struct *uc, MemoryRegion *mr)
             uc->mapped_block_count--;
             //shift remainder of array down over deleted pointer
             memmove(&uc->mapped_blocks[i], &uc->mapped_blocks[i + 1], sizeof(MemoryRegion*) * (uc->mapped_block_count - i));
-            mr->destructor(mr);
-            obj = OBJECT(mr);
-            obj->ref = 1;
-            obj->free = g_free;
-            g_free((char *)mr->name);
-            mr->name = NULL;
-            object_property_del_child(mr->uc, qdev_get_machine(mr->uc), obj, &error_abort);
+            // the current FlatView still points at mr until the batch
+            // commits, so it can only be freed after that
+            if (uc->memory_region_transaction_depth)
+                list_append(&uc->unmapped_blocks, mr);
+            else
+                memory_region_free_unmapped(mr);
             break;
         }
     }
 }
 
+// Start a batch of memory_map*()/memory_unmap() calls: the address space
+// is rebuilt and the TLB flushed once, in memory_batch_end().
+void memory_batch_begin(struct uc_struct *uc)
+{
+    memory_region_transaction_begin(uc);
+}
+
+void memory_batch_end(struct uc_struct *uc)
+{
+    struct list_item *cur;
+
+    memory_region_transaction_commit(uc);
+    if (uc->memory_region_transaction_depth)
+        return;
+
+    for (cur = uc->unmapped_blocks.head; cur != NULL; cur = cur->next)
+        memory_region_free_unmapped((MemoryRegion *)cur->data);
+    list_clear(&uc->unmapped_blocks);
+
+    if (uc->current_cpu)
+        tlb_flush(uc->current_cpu, 1);
+}
+
 int memory_free(struct uc_struct *uc)
 {
     MemoryRegion *mr;
@@ -1077,6 +1238,26 @@ void memory_region_init_ram(struct uc_struct *uc, MemoryRegion *mr,
     mr->ram_addr = qemu_ram_alloc(size, mr, errp);
 }
 
+void memory_region_init_ram_file(struct uc_struct *uc, MemoryRegion *mr,
+                                 Object *owner,
+                                 const char *name,
+                                 uint64_t size,
+                                 uint32_t perms,
+                                 int fd,
+                                 uint64_t offset,
+                                 Error **errp)
+{
+    memory_region_init(uc, mr, owner, name, size);
+    mr->ram = true;
+    if (!(perms & UC_PROT_WRITE)) {
+        mr->readonly = true;
+    }
+    mr->perms = perms;
+    mr->terminates = true;
+    mr->destructor = memory_region_destructor_ram;
+    mr->ram_addr = qemu_ram_alloc_from_file(size, fd, offset, mr, errp);
+}
+
 void memory_region_init_ram_ptr(struct uc_struct *uc, MemoryRegion *mr,
                                 Object *owner,
                                 const char *name,
@@ -1247,7 +1428,9 @@ void *memory_region_get_ram_ptr(MemoryRegion *mr)
 
     assert(mr->terminates);
 
-    return qemu_get_ram_ptr(mr->uc, mr->ram_addr & TARGET_PAGE_MASK);
+    /* Only the base of the block: callers that touch a page of a
+       uc_mem_reserve() region populate it themselves.  */
+    return qemu_get_ram_block_host_ptr(mr->uc, mr->ram_addr & TARGET_PAGE_MASK);
 }
 
 static void memory_region_update_container_subregions(MemoryRegion *subregion)
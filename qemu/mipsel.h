@@ -12,14 +12,28 @@
 #define tb_invalidate_phys_page_fast tb_invalidate_phys_page_fast_mipsel
 #define phys_mem_clean phys_mem_clean_mipsel
 #define tb_cleanup tb_cleanup_mipsel
+#define tb_cache_open tb_cache_open_mipsel
+#define tb_cache_load tb_cache_load_mipsel
+#define tb_cache_store tb_cache_store_mipsel
+#define tb_cache_close tb_cache_close_mipsel
 #define memory_map memory_map_mipsel
 #define memory_map_ptr memory_map_ptr_mipsel
+#define memory_map_file memory_map_file_mipsel
+#define memory_map_lazy memory_map_lazy_mipsel
+#define memory_map_io memory_map_io_mipsel
 #define memory_unmap memory_unmap_mipsel
+#define memory_batch_begin memory_batch_begin_mipsel
+#define memory_batch_end memory_batch_end_mipsel
 #define memory_free memory_free_mipsel
 #define free_code_gen_buffer free_code_gen_buffer_mipsel
 #define helper_raise_exception helper_raise_exception_mipsel
 #define tcg_enabled tcg_enabled_mipsel
 #define tcg_exec_init tcg_exec_init_mipsel
+#define tcg_exec_memory tcg_exec_memory_mipsel
+#define tb_translate_range tb_translate_range_mipsel
+#define tb_prof_env_pc tb_prof_env_pc_mipsel
+#define tb_prof_resolve tb_prof_resolve_mipsel
+#define tb_fold_counts tb_fold_counts_mipsel
 #define memory_register_types memory_register_types_mipsel
 #define cpu_exec_init_all cpu_exec_init_all_mipsel
 #define vm_start vm_start_mipsel
@@ -2042,6 +2056,7 @@
 #define memory_region_init_io memory_region_init_io_mipsel
 #define memory_region_init_ram memory_region_init_ram_mipsel
 #define memory_region_init_ram_ptr memory_region_init_ram_ptr_mipsel
+#define memory_region_init_ram_file memory_region_init_ram_file_mipsel
 #define memory_region_init_reservation memory_region_init_reservation_mipsel
 #define memory_region_is_iommu memory_region_is_iommu_mipsel
 #define memory_region_is_logging memory_region_is_logging_mipsel
@@ -2365,8 +2380,6 @@
 #define qdict_size qdict_size_mipsel
 #define qdict_type qdict_type_mipsel
 #define qemu_clock_get_us qemu_clock_get_us_mipsel
-#define qemu_clock_ptr qemu_clock_ptr_mipsel
-#define qemu_clocks qemu_clocks_mipsel
 #define qemu_get_cpu qemu_get_cpu_mipsel
 #define qemu_get_guest_memory_mapping qemu_get_guest_memory_mapping_mipsel
 #define qemu_get_guest_simple_memory_mapping qemu_get_guest_simple_memory_mapping_mipsel
@@ -2374,6 +2387,7 @@
 #define qemu_get_ram_block_host_ptr qemu_get_ram_block_host_ptr_mipsel
 #define qemu_get_ram_fd qemu_get_ram_fd_mipsel
 #define qemu_get_ram_ptr qemu_get_ram_ptr_mipsel
+#define qemu_ram_populate qemu_ram_populate_mipsel
 #define qemu_host_page_mask qemu_host_page_mask_mipsel
 #define qemu_host_page_size qemu_host_page_size_mipsel
 #define qemu_init_vcpu qemu_init_vcpu_mipsel
@@ -2389,6 +2403,7 @@
 #define qemu_ram_addr_from_host_nofail qemu_ram_addr_from_host_nofail_mipsel
 #define qemu_ram_alloc qemu_ram_alloc_mipsel
 #define qemu_ram_alloc_from_ptr qemu_ram_alloc_from_ptr_mipsel
+#define qemu_ram_alloc_from_file qemu_ram_alloc_from_file_mipsel
 #define qemu_ram_foreach_block qemu_ram_foreach_block_mipsel
 #define qemu_ram_free qemu_ram_free_mipsel
 #define qemu_ram_free_from_ptr qemu_ram_free_from_ptr_mipsel
@@ -2652,6 +2667,7 @@
 #define tb_flush_jmp_cache tb_flush_jmp_cache_mipsel
 #define tb_free tb_free_mipsel
 #define tb_gen_code tb_gen_code_mipsel
+#define tb_gen_hot tb_gen_hot_mipsel
 #define tb_hash_remove tb_hash_remove_mipsel
 #define tb_invalidate_phys_addr tb_invalidate_phys_addr_mipsel
 #define tb_invalidate_phys_page_range tb_invalidate_phys_page_range_mipsel
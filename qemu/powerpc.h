@@ -12,14 +12,28 @@
 #define tb_invalidate_phys_page_fast tb_invalidate_phys_page_fast_powerpc
 #define phys_mem_clean phys_mem_clean_powerpc
 #define tb_cleanup tb_cleanup_powerpc
+#define tb_cache_open tb_cache_open_powerpc
+#define tb_cache_load tb_cache_load_powerpc
+#define tb_cache_store tb_cache_store_powerpc
+#define tb_cache_close tb_cache_close_powerpc
 #define memory_map memory_map_powerpc
 #define memory_map_ptr memory_map_ptr_powerpc
+#define memory_map_file memory_map_file_powerpc
+#define memory_map_lazy memory_map_lazy_powerpc
+#define memory_map_io memory_map_io_powerpc
 #define memory_unmap memory_unmap_powerpc
+#define memory_batch_begin memory_batch_begin_powerpc
+#define memory_batch_end memory_batch_end_powerpc
 #define memory_free memory_free_powerpc
 #define free_code_gen_buffer free_code_gen_buffer_powerpc
 #define helper_raise_exception helper_raise_exception_powerpc
 #define tcg_enabled tcg_enabled_powerpc
 #define tcg_exec_init tcg_exec_init_powerpc
+#define tcg_exec_memory tcg_exec_memory_powerpc
+#define tb_translate_range tb_translate_range_powerpc
+#define tb_prof_env_pc tb_prof_env_pc_powerpc
+#define tb_prof_resolve tb_prof_resolve_powerpc
+#define tb_fold_counts tb_fold_counts_powerpc
 #define memory_register_types memory_register_types_powerpc
 #define cpu_exec_init_all cpu_exec_init_all_powerpc
 #define vm_start vm_start_powerpc
@@ -2042,6 +2056,7 @@
 #define memory_region_init_io memory_region_init_io_powerpc
 #define memory_region_init_ram memory_region_init_ram_powerpc
 #define memory_region_init_ram_ptr memory_region_init_ram_ptr_powerpc
+#define memory_region_init_ram_file memory_region_init_ram_file_powerpc
 #define memory_region_init_reservation memory_region_init_reservation_powerpc
 #define memory_region_is_iommu memory_region_is_iommu_powerpc
 #define memory_region_is_logging memory_region_is_logging_powerpc
@@ -2365,8 +2380,6 @@
 #define qdict_size qdict_size_powerpc
 #define qdict_type qdict_type_powerpc
 #define qemu_clock_get_us qemu_clock_get_us_powerpc
-#define qemu_clock_ptr qemu_clock_ptr_powerpc
-#define qemu_clocks qemu_clocks_powerpc
 #define qemu_get_cpu qemu_get_cpu_powerpc
 #define qemu_get_guest_memory_mapping qemu_get_guest_memory_mapping_powerpc
 #define qemu_get_guest_simple_memory_mapping qemu_get_guest_simple_memory_mapping_powerpc
@@ -2374,6 +2387,7 @@
 #define qemu_get_ram_block_host_ptr qemu_get_ram_block_host_ptr_powerpc
 #define qemu_get_ram_fd qemu_get_ram_fd_powerpc
 #define qemu_get_ram_ptr qemu_get_ram_ptr_powerpc
+#define qemu_ram_populate qemu_ram_populate_powerpc
 #define qemu_host_page_mask qemu_host_page_mask_powerpc
 #define qemu_host_page_size qemu_host_page_size_powerpc
 #define qemu_init_vcpu qemu_init_vcpu_powerpc
@@ -2389,6 +2403,7 @@
 #define qemu_ram_addr_from_host_nofail qemu_ram_addr_from_host_nofail_powerpc
 #define qemu_ram_alloc qemu_ram_alloc_powerpc
 #define qemu_ram_alloc_from_ptr qemu_ram_alloc_from_ptr_powerpc
+#define qemu_ram_alloc_from_file qemu_ram_alloc_from_file_powerpc
 #define qemu_ram_foreach_block qemu_ram_foreach_block_powerpc
 #define qemu_ram_free qemu_ram_free_powerpc
 #define qemu_ram_free_from_ptr qemu_ram_free_from_ptr_powerpc
@@ -2652,6 +2667,7 @@
 #define tb_flush_jmp_cache tb_flush_jmp_cache_powerpc
 #define tb_free tb_free_powerpc
 #define tb_gen_code tb_gen_code_powerpc
+#define tb_gen_hot tb_gen_hot_powerpc
 #define tb_hash_remove tb_hash_remove_powerpc
 #define tb_invalidate_phys_addr tb_invalidate_phys_addr_powerpc
 #define tb_invalidate_phys_page_range tb_invalidate_phys_page_range_powerpc
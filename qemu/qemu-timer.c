@@ -43,31 +43,6 @@
 /***********************************************************/
 /* timers */
 
-typedef struct QEMUClock {
-    /* We rely on BQL to protect the timerlists */
-    QLIST_HEAD(, QEMUTimerList) timerlists;
-
-    int64_t last;
-
-    QEMUClockType type;
-    bool enabled;
-} QEMUClock;
-
-static QEMUClock qemu_clocks[QEMU_CLOCK_MAX];
-
-/**
- * qemu_clock_ptr:
- * @type: type of clock
- *
- * Translate a clock type into a pointer to QEMUClock object.
- *
- * Returns: a pointer to the QEMUClock object
- */
-static inline QEMUClock *qemu_clock_ptr(QEMUClockType type)
-{
-    return &qemu_clocks[type];
-}
-
 /* return the host CPU cycle counter and handle stop/restart */
 int64_t cpu_get_ticks(void)
 {
@@ -82,9 +57,7 @@ int64_t cpu_get_clock(void)
 
 int64_t qemu_clock_get_ns(QEMUClockType type)
 {
-    int64_t now, last;
-    QEMUClock *clock = qemu_clock_ptr(type);
-
+    /* No per-clock state: engines on different threads share this file. */
     switch (type) {
         case QEMU_CLOCK_REALTIME:
             return get_clock();
@@ -92,12 +65,6 @@ int64_t qemu_clock_get_ns(QEMUClockType type)
         case QEMU_CLOCK_VIRTUAL:
             return cpu_get_clock();
         case QEMU_CLOCK_HOST:
-            now = get_clock_realtime();
-            last = clock->last;
-            clock->last = now;
-            if (now < last) {
-                // notifier_list_notify(&clock->reset_notifiers, &now); // FIXME
-            }
-            return now;
+            return get_clock_realtime();
     }
 }
@@ -24,6 +24,7 @@
 /* Modified for Unicorn Engine by Nguyen Anh Quynh, 2015 */
 
 #include "qemu/timer.h"
+#include "qemu/probes.h"
 #include "exec/address-spaces.h"
 #include "exec/memory.h"
 #include "uc_priv.h"
@@ -196,6 +197,8 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
     struct uc_struct *uc = env->uc;
     MemoryRegion *mr = memory_mapping(uc, addr);
 
+    uc->stats.mem_slow_path++;
+
     // memory might be still unmapped while reading or fetching
     if (mr == NULL) {
         handled = false;
@@ -204,6 +207,7 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_FETCH_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_FETCH_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_FETCH_UNMAPPED, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -212,6 +216,7 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_READ_UNMAPPED, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -235,6 +240,7 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_FETCH_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_FETCH_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_FETCH_PROT, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -260,7 +266,10 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ);
+            UC_PROBE3(mem_hook_enter, UC_MEM_READ, (uint64_t)addr, DATA_SIZE);
             ((uc_cb_hookmem_t)hook->callback)(env->uc, UC_MEM_READ, addr, DATA_SIZE, 0, hook->user_data);
+            UC_PROBE2(mem_hook_return, UC_MEM_READ, (uint64_t)addr);
         }
     }
 
@@ -270,6 +279,7 @@ WORD_TYPE helper_le_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_READ_PROT, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -398,7 +408,10 @@ _out:
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_AFTER) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_AFTER);
+            UC_PROBE3(mem_hook_enter, UC_MEM_READ_AFTER, (uint64_t)addr, DATA_SIZE);
             ((uc_cb_hookmem_t)hook->callback)(env->uc, UC_MEM_READ_AFTER, addr, DATA_SIZE, res, hook->user_data);
+            UC_PROBE2(mem_hook_return, UC_MEM_READ_AFTER, (uint64_t)addr);
         }
     }
 
@@ -424,6 +437,8 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
     struct uc_struct *uc = env->uc;
     MemoryRegion *mr = memory_mapping(uc, addr);
 
+    uc->stats.mem_slow_path++;
+
     // memory can be unmapped while reading or fetching
     if (mr == NULL) {
         handled = false;
@@ -432,6 +447,7 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_FETCH_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_FETCH_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_FETCH_UNMAPPED, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -440,6 +456,7 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_READ_UNMAPPED, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -463,6 +480,7 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_FETCH_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_FETCH_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_FETCH_PROT, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -488,7 +506,10 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ);
+            UC_PROBE3(mem_hook_enter, UC_MEM_READ, (uint64_t)addr, DATA_SIZE);
             ((uc_cb_hookmem_t)hook->callback)(env->uc, UC_MEM_READ, addr, DATA_SIZE, 0, hook->user_data);
+            UC_PROBE2(mem_hook_return, UC_MEM_READ, (uint64_t)addr);
         }
     }
 
@@ -498,6 +519,7 @@ WORD_TYPE helper_be_ld_name(CPUArchState *env, target_ulong addr, int mmu_idx,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_READ_PROT, addr, DATA_SIZE, 0, hook->user_data)))
                 break;
         }
@@ -621,7 +643,10 @@ _out:
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_READ_AFTER) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_READ_AFTER);
+            UC_PROBE3(mem_hook_enter, UC_MEM_READ_AFTER, (uint64_t)addr, DATA_SIZE);
             ((uc_cb_hookmem_t)hook->callback)(env->uc, UC_MEM_READ_AFTER, addr, DATA_SIZE, res, hook->user_data);
+            UC_PROBE2(mem_hook_return, UC_MEM_READ_AFTER, (uint64_t)addr);
         }
     }
 
@@ -689,11 +714,16 @@ void helper_le_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
     struct uc_struct *uc = env->uc;
     MemoryRegion *mr = memory_mapping(uc, addr);
 
+    uc->stats.mem_slow_path++;
+
     // Unicorn: callback on memory write
     HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+        HOOK_COUNT(uc, UC_HOOK_MEM_WRITE);
+        UC_PROBE3(mem_hook_enter, UC_MEM_WRITE, (uint64_t)addr, DATA_SIZE);
         ((uc_cb_hookmem_t)hook->callback)(uc, UC_MEM_WRITE, addr, DATA_SIZE, val, hook->user_data);
+        UC_PROBE2(mem_hook_return, UC_MEM_WRITE, (uint64_t)addr);
     }
 
     // Unicorn: callback on invalid memory
@@ -702,6 +732,7 @@ void helper_le_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_WRITE_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_WRITE_UNMAPPED, addr, DATA_SIZE, val, hook->user_data)))
                 break;
         }
@@ -725,6 +756,7 @@ void helper_le_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_WRITE_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_WRITE_PROT, addr, DATA_SIZE, val, hook->user_data)))
                 break;
         }
@@ -848,11 +880,16 @@ void helper_be_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
     struct uc_struct *uc = env->uc;
     MemoryRegion *mr = memory_mapping(uc, addr);
 
+    uc->stats.mem_slow_path++;
+
     // Unicorn: callback on memory write
     HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE) {
         if (!HOOK_BOUND_CHECK(hook, addr))
             continue;
+        HOOK_COUNT(uc, UC_HOOK_MEM_WRITE);
+        UC_PROBE3(mem_hook_enter, UC_MEM_WRITE, (uint64_t)addr, DATA_SIZE);
         ((uc_cb_hookmem_t)hook->callback)(uc, UC_MEM_WRITE, addr, DATA_SIZE, val, hook->user_data);
+        UC_PROBE2(mem_hook_return, UC_MEM_WRITE, (uint64_t)addr);
     }
 
     // Unicorn: callback on invalid memory
@@ -861,6 +898,7 @@ void helper_be_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE_UNMAPPED) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_WRITE_UNMAPPED);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_WRITE_UNMAPPED, addr, DATA_SIZE, val, hook->user_data)))
                 break;
         }
@@ -884,6 +922,7 @@ void helper_be_st_name(CPUArchState *env, target_ulong addr, DATA_TYPE val,
         HOOK_FOREACH(uc, hook, UC_HOOK_MEM_WRITE_PROT) {
             if (!HOOK_BOUND_CHECK(hook, addr))
                 continue;
+            HOOK_COUNT(uc, UC_HOOK_MEM_WRITE_PROT);
             if ((handled = ((uc_cb_eventmem_t)hook->callback)(uc, UC_MEM_WRITE_PROT, addr, DATA_SIZE, val, hook->user_data)))
                 break;
         }
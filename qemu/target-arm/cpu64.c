@@ -205,7 +205,7 @@ void aarch64_cpu_register_types(void *opaque)
 {
     const ARMCPUInfo *info = aarch64_cpus;
 
-    static TypeInfo aarch64_cpu_type_info = { 0 };
+    TypeInfo aarch64_cpu_type_info = { 0 };
     aarch64_cpu_type_info.name = TYPE_AARCH64_CPU;
     aarch64_cpu_type_info.parent = TYPE_ARM_CPU;
     aarch64_cpu_type_info.instance_size = sizeof(ARMCPU);
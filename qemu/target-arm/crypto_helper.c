@@ -15,6 +15,7 @@
 #include "exec/exec-all.h"
 #include "exec/helper-proto.h"
 #include "qemu/aes.h"
+#include "qemu/host-crypto.h"
 
 union CRYPTO_STATE {
     uint8_t    bytes[16];
@@ -43,9 +44,21 @@ void HELPER(crypto_aese)(CPUARMState *env, uint32_t rd, uint32_t rm,
     rk.l[0] ^= st.l[0];
     rk.l[1] ^= st.l[1];
 
-    /* combine ShiftRows operation and sbox substitution */
-    for (i = 0; i < 16; i++) {
-        st.bytes[i] = sbox[decrypt][rk.bytes[shift[decrypt][i]]];
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        /* AES[ED]LAST with a zero round key is exactly (Inv)SubBytes
+           combined with (Inv)ShiftRows */
+        static const union CRYPTO_STATE zero;
+
+        if (decrypt) {
+            host_aes_declast(&st, &rk, &zero);
+        } else {
+            host_aes_enclast(&st, &rk, &zero);
+        }
+    } else {
+        /* combine ShiftRows operation and sbox substitution */
+        for (i = 0; i < 16; i++) {
+            st.bytes[i] = sbox[decrypt][rk.bytes[shift[decrypt][i]]];
+        }
     }
 
     env->vfp.regs[rd] = make_float64(st.l[0]);
@@ -195,12 +208,20 @@ void HELPER(crypto_aesmc)(CPUARMState *env, uint32_t rd, uint32_t rm,
 
     assert(decrypt < 2);
 
-    for (i = 0; i < 16; i += 4) {
-        st.words[i >> 2] = cpu_to_le32(
-            mc[decrypt][st.bytes[i]] ^
-            rol32(mc[decrypt][st.bytes[i + 1]], 8) ^
-            rol32(mc[decrypt][st.bytes[i + 2]], 16) ^
-            rol32(mc[decrypt][st.bytes[i + 3]], 24));
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        if (decrypt) {
+            host_aes_imc(&st, &st);
+        } else {
+            host_aes_mc(&st, &st);
+        }
+    } else {
+        for (i = 0; i < 16; i += 4) {
+            st.words[i >> 2] = cpu_to_le32(
+                mc[decrypt][st.bytes[i]] ^
+                rol32(mc[decrypt][st.bytes[i + 1]], 8) ^
+                rol32(mc[decrypt][st.bytes[i + 2]], 16) ^
+                rol32(mc[decrypt][st.bytes[i + 3]], 24));
+        }
     }
 
     env->vfp.regs[rd] = make_float64(st.l[0]);
@@ -1,4 +1,5 @@
 DEF_HELPER_4(uc_tracecode, void, i32, i32, ptr, i64)
+DEF_HELPER_2(uc_intr, i32, ptr, i32)
 
 DEF_HELPER_FLAGS_1(clz_arm, TCG_CALL_NO_RWG_SE, i32, i32)
 
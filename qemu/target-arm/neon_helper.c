@@ -12,6 +12,7 @@
 #include "cpu.h"
 #include "exec/exec-all.h"
 #include "exec/helper-proto.h"
+#include "qemu/host-crypto.h"
 
 #define SIGNBIT (uint32_t)0x80000000
 #define SIGNBIT64 ((uint64_t)1 << 63)
@@ -2221,6 +2222,12 @@ uint64_t HELPER(neon_pmull_64_lo)(uint64_t op1, uint64_t op2)
     int bitnum;
     uint64_t res = 0;
 
+    if (host_crypto_has(HOST_CRYPTO_CLMUL)) {
+        uint64_t hi;
+        host_clmul(op1, op2, &res, &hi);
+        return res;
+    }
+
     for (bitnum = 0; bitnum < 64; bitnum++) {
         if (op1 & (1ULL << bitnum)) {
             res ^= op2 << bitnum;
@@ -2233,6 +2240,12 @@ uint64_t HELPER(neon_pmull_64_hi)(uint64_t op1, uint64_t op2)
     int bitnum;
     uint64_t res = 0;
 
+    if (host_crypto_has(HOST_CRYPTO_CLMUL)) {
+        uint64_t lo;
+        host_clmul(op1, op2, &lo, &res);
+        return res;
+    }
+
     /* bit 0 of op1 can't influence the high 64 bits at all */
     for (bitnum = 1; bitnum < 64; bitnum++) {
         if (op1 & (1ULL << bitnum)) {
@@ -270,6 +270,23 @@ static inline void gen_goto_tb(DisasContext *s, int n, uint64_t dest)
     }
 }
 
+/* Unicorn: run the interrupt hooks for SVC in place, then leave the TB
+ * without chaining: the main loop looks the next block up for the state
+ * the hooks left, including a moved PC or a stop request.
+ */
+static void gen_svc_hooked(DisasContext *s)
+{
+    TCGContext *tcg_ctx = s->uc->tcg_ctx;
+    TCGv_i32 handled = tcg_temp_new_i32(tcg_ctx);
+
+    gen_a64_set_pc_im(s, s->pc);
+    gen_helper_uc_intr(tcg_ctx, handled, tcg_const_ptr(tcg_ctx, s->uc),
+                       tcg_const_i32(tcg_ctx, EXCP_SWI));
+    tcg_temp_free_i32(tcg_ctx, handled);
+    tcg_gen_exit_tb(tcg_ctx, 0);
+    s->is_jmp = DISAS_TB_JUMP;
+}
+
 static void unallocated_encoding(DisasContext *s)
 {
     /* Unallocated and reserved encodings are uncategorized */
@@ -1503,6 +1520,11 @@ static void disas_exc(DisasContext *s, uint32_t insn)
          */
         switch (op2_ll) {
         case 1:
+            if (!s->ss_active && !s->singlestep_enabled &&
+                HOOK_EXISTS(s->uc, UC_HOOK_INTR)) {
+                gen_svc_hooked(s);
+                break;
+            }
             gen_ss_advance(s);
             gen_exception_insn(s, 0, EXCP_SWI, syn_aa64_svc(imm16));
             break;
@@ -4033,6 +4033,21 @@ static inline void gen_goto_tb(DisasContext *s, int n, target_ulong dest)
     }
 }
 
+/* Unicorn: run the interrupt hooks for SVC in place, then leave the TB
+   without chaining: the main loop looks the next block up for the state
+   the hooks left (e.g. Thumb mode), including a moved PC or a stop
+   request.  The PC already points past the SVC.  */
+static void gen_swi_hooked(DisasContext *s)
+{
+    TCGContext *tcg_ctx = s->uc->tcg_ctx;
+    TCGv_i32 handled = tcg_temp_new_i32(tcg_ctx);
+
+    gen_helper_uc_intr(tcg_ctx, handled, tcg_const_ptr(tcg_ctx, s->uc),
+                       tcg_const_i32(tcg_ctx, EXCP_SWI));
+    tcg_temp_free_i32(tcg_ctx, handled);
+    tcg_gen_exit_tb(tcg_ctx, 0);
+}
+
 static inline void gen_jmp(DisasContext *s, uint32_t dest)
 {
     if (unlikely(s->singlestep_enabled || s->ss_active)) {
@@ -4046,6 +4061,20 @@ static inline void gen_jmp(DisasContext *s, uint32_t dest)
     }
 }
 
+/* Unicorn: a superblock goes on translating at the target of an
+   unconditional direct branch forward within its page instead of ending
+   there, so the extra code stays inside [tb->pc, tb->pc + tb->size).  */
+static inline bool gen_jmp_follow(DisasContext *s, uint32_t dest)
+{
+    if (!(s->tb->cflags & CF_SUPERBLOCK) || s->condjmp ||
+        s->singlestep_enabled || s->ss_active || dest < s->pc ||
+        (dest & TARGET_PAGE_MASK) != (s->tb->pc & TARGET_PAGE_MASK)) {
+        return false;
+    }
+    s->pc = dest;
+    return true;
+}
+
 static inline void gen_mulxy(DisasContext *s, TCGv_i32 t0, TCGv_i32 t1, int x, int y)
 {
     TCGContext *tcg_ctx = s->uc->tcg_ctx;
@@ -9103,7 +9132,9 @@ static void disas_arm_insn(DisasContext *s, unsigned int insn)  // qq
                 }
                 offset = sextract32(insn << 2, 0, 26);
                 val += offset + 4;
-                gen_jmp(s, val);
+                if (!gen_jmp_follow(s, val)) {
+                    gen_jmp(s, val);
+                }
             }
             break;
         case 0xc:
@@ -11518,7 +11549,11 @@ tb_end:
             gen_helper_wfe(tcg_ctx, tcg_ctx->cpu_env);
             break;
         case DISAS_SWI:
-            gen_exception(dc, EXCP_SWI, syn_aa32_svc(dc->svc_imm, dc->thumb));
+            if (HOOK_EXISTS(env->uc, UC_HOOK_INTR)) {
+                gen_swi_hooked(dc);
+            } else {
+                gen_exception(dc, EXCP_SWI, syn_aa32_svc(dc->svc_imm, dc->thumb));
+            }
             break;
         case DISAS_HVC:
             gen_exception(dc, EXCP_HVC, syn_aa32_hvc(dc->svc_imm));
@@ -44,6 +44,33 @@ void arm64_reg_reset(struct uc_struct *uc)
     env->pc = 0;
 }
 
+// uc_reg_ptr(): X0-X30, SP and PC, and W0-W30 as the low half of X0-X30
+static void *arm64_reg_ptr(struct uc_struct *uc, unsigned int regid, size_t *size)
+{
+    CPUARMState *env = uc->cpu->env_ptr;
+
+    *size = 8;
+    if (regid >= UC_ARM64_REG_X0 && regid <= UC_ARM64_REG_X28)
+        return &env->xregs[regid - UC_ARM64_REG_X0];
+
+    if (regid >= UC_ARM64_REG_W0 && regid <= UC_ARM64_REG_W30) {
+        *size = 4;
+#ifdef HOST_WORDS_BIGENDIAN
+        return (uint32_t *)&env->xregs[regid - UC_ARM64_REG_W0] + 1;
+#else
+        return &env->xregs[regid - UC_ARM64_REG_W0];
+#endif
+    }
+
+    switch(regid) {
+        default: return NULL;
+        case UC_ARM64_REG_X29: return &env->xregs[29];
+        case UC_ARM64_REG_X30: return &env->xregs[30];
+        case UC_ARM64_REG_SP: return &env->xregs[31];
+        case UC_ARM64_REG_PC: return &env->pc;
+    }
+}
+
 int arm64_reg_read(struct uc_struct *uc, unsigned int *regs, void **vals, int count)
 {
     CPUState *mycpu = uc->cpu;
@@ -192,6 +219,7 @@ void arm64_uc_init(struct uc_struct* uc)
     uc->reg_read = arm64_reg_read;
     uc->reg_write = arm64_reg_write;
     uc->reg_reset = arm64_reg_reset;
+    uc->reg_ptr = arm64_reg_ptr;
     uc->set_pc = arm64_set_pc;
     uc->release = arm64_release;
     uc_common_init(uc);
@@ -47,6 +47,23 @@ void arm_reg_reset(struct uc_struct *uc)
     env->pc = 0;
 }
 
+// uc_reg_ptr(): R0-R15. R15 is the PC of the current instruction.
+static void *arm_reg_ptr(struct uc_struct *uc, unsigned int regid, size_t *size)
+{
+    CPUARMState *env = uc->cpu->env_ptr;
+
+    *size = 4;
+    if (regid >= UC_ARM_REG_R0 && regid <= UC_ARM_REG_R12)
+        return &env->regs[regid - UC_ARM_REG_R0];
+
+    switch(regid) {
+        default: return NULL;
+        case UC_ARM_REG_R13: return &env->regs[13];
+        case UC_ARM_REG_R14: return &env->regs[14];
+        case UC_ARM_REG_R15: return &env->regs[15];
+    }
+}
+
 int arm_reg_read(struct uc_struct *uc, unsigned int *regs, void **vals, int count)
 {
     CPUState *mycpu;
@@ -194,6 +211,7 @@ void arm_uc_init(struct uc_struct* uc)
     uc->reg_read = arm_reg_read;
     uc->reg_write = arm_reg_write;
     uc->reg_reset = arm_reg_reset;
+    uc->reg_ptr = arm_reg_ptr;
     uc->set_pc = arm_set_pc;
     uc->stop_interrupt = arm_stop_interrupt;
     uc->release = arm_release;
@@ -19,6 +19,7 @@
  */
 
 #include "qemu/aes.h"
+#include "qemu/host-crypto.h"
 
 #if SHIFT == 0
 #define Reg MMXReg
@@ -2147,9 +2148,13 @@ void glue(helper_pcmpistrm, SUFFIX)(CPUX86State *env, Reg *d, Reg *s,
 #define CRCPOLY_BITREV 0x82f63b78
 target_ulong helper_crc32(uint32_t crc1, target_ulong msg, uint32_t len)
 {
-    target_ulong crc = (msg & ((target_ulong) -1 >>
-                               (TARGET_LONG_BITS - len))) ^ crc1;
+    target_ulong crc;
 
+    if (host_crypto_has(HOST_CRYPTO_CRC32C)) {
+        return host_crc32c_le(crc1, msg, len / 8);
+    }
+
+    crc = (msg & ((target_ulong) -1 >> (TARGET_LONG_BITS - len))) ^ crc1;
     while (len--) {
         crc = (crc >> 1) ^ ((crc & 1) ? CRCPOLY_BITREV : 0);
     }
@@ -2191,6 +2196,12 @@ void glue(helper_pclmulqdq, SUFFIX)(CPUX86State *env, Reg *d, Reg *s,
     ah = 0;
     al = d->Q((ctrl & 1) != 0);
     b = s->Q((ctrl & 16) != 0);
+
+    if (host_crypto_has(HOST_CRYPTO_CLMUL)) {
+        host_clmul(al, b, &d->Q(0), &d->Q(1));
+        return;
+    }
+
     resh = resl = 0;
 
     while (b) {
@@ -2213,6 +2224,11 @@ void glue(helper_aesdec, SUFFIX)(CPUX86State *env, Reg *d, Reg *s)
     Reg st = *d;
     Reg rk = *s;
 
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        host_aes_dec(d, &st, &rk);
+        return;
+    }
+
     for (i = 0 ; i < 4 ; i++) {
         d->L(i) = rk.L(i) ^ bswap32(AES_Td0[st.B(AES_ishifts[4*i+0])] ^
                                     AES_Td1[st.B(AES_ishifts[4*i+1])] ^
@@ -2227,6 +2243,11 @@ void glue(helper_aesdeclast, SUFFIX)(CPUX86State *env, Reg *d, Reg *s)
     Reg st = *d;
     Reg rk = *s;
 
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        host_aes_declast(d, &st, &rk);
+        return;
+    }
+
     for (i = 0; i < 16; i++) {
         d->B(i) = rk.B(i) ^ (AES_Td4[st.B(AES_ishifts[i])] & 0xff);
     }
@@ -2238,6 +2259,11 @@ void glue(helper_aesenc, SUFFIX)(CPUX86State *env, Reg *d, Reg *s)
     Reg st = *d;
     Reg rk = *s;
 
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        host_aes_enc(d, &st, &rk);
+        return;
+    }
+
     for (i = 0 ; i < 4 ; i++) {
         d->L(i) = rk.L(i) ^ bswap32(AES_Te0[st.B(AES_shifts[4*i+0])] ^
                                     AES_Te1[st.B(AES_shifts[4*i+1])] ^
@@ -2252,6 +2278,11 @@ void glue(helper_aesenclast, SUFFIX)(CPUX86State *env, Reg *d, Reg *s)
     Reg st = *d;
     Reg rk = *s;
 
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        host_aes_enclast(d, &st, &rk);
+        return;
+    }
+
     for (i = 0; i < 16; i++) {
         d->B(i) = rk.B(i) ^ (AES_Te4[st.B(AES_shifts[i])] & 0xff);
     }
@@ -2263,6 +2294,11 @@ void glue(helper_aesimc, SUFFIX)(CPUX86State *env, Reg *d, Reg *s)
     int i;
     Reg tmp = *s;
 
+    if (host_crypto_has(HOST_CRYPTO_AES)) {
+        host_aes_imc(d, &tmp);
+        return;
+    }
+
     for (i = 0 ; i < 4 ; i++) {
         d->L(i) = bswap32(AES_Td0[AES_Te4[tmp.B(4*i+0)] & 0xff] ^
                           AES_Td1[AES_Te4[tmp.B(4*i+1)] & 0xff] ^
@@ -951,8 +951,10 @@ void helper_syscall(CPUX86State *env, int next_eip_addend)
     HOOK_FOREACH(env->uc, hook, UC_HOOK_INSN) {
         if (!HOOK_BOUND_CHECK(hook, env->eip))
             continue;
-        if (hook->insn == UC_X86_INS_SYSCALL)
+        if (hook->insn == UC_X86_INS_SYSCALL) {
+            HOOK_COUNT(env->uc, UC_HOOK_INSN);
             ((uc_cb_insn_syscall_t)hook->callback)(env->uc, hook->user_data);
+        }
     }
 
     env->eip += next_eip_addend;
@@ -2313,8 +2315,10 @@ void helper_sysenter(CPUX86State *env, int next_eip_addend)
     HOOK_FOREACH(env->uc, hook, UC_HOOK_INSN) {
         if (!HOOK_BOUND_CHECK(hook, env->eip))
             continue;
-        if (hook->insn == UC_X86_INS_SYSENTER)
+        if (hook->insn == UC_X86_INS_SYSENTER) {
+            HOOK_COUNT(env->uc, UC_HOOK_INSN);
             ((uc_cb_insn_syscall_t)hook->callback)(env->uc, hook->user_data);
+        }
     }
 
     env->eip += next_eip_addend;
@@ -106,6 +106,7 @@ typedef struct DisasContext {
 
     // Unicorn
     target_ulong prev_pc; /* save address of the previous instruction */
+    target_ulong follow_pc; /* superblock: continue here after this insn */
 } DisasContext;
 
 static void gen_eob(DisasContext *s);
@@ -2860,6 +2861,28 @@ static void gen_interrupt(DisasContext *s, int intno,
     s->is_jmp = DISAS_TB_JUMP;
 }
 
+// Unicorn: run the interrupt hooks in place, and go on with the next
+// instruction when one of them handled the interrupt. The TB ends either
+// way: a hook may have changed the flags the next block is looked up by.
+static void gen_interrupt_hooked(DisasContext *s, int intno,
+                                 target_ulong cur_eip, target_ulong next_eip)
+{
+    TCGContext *tcg_ctx = s->uc->tcg_ctx;
+    TCGv_i32 handled = tcg_temp_new_i32(tcg_ctx);
+    int l1 = gen_new_label(tcg_ctx);
+
+    gen_update_cc_op(s);
+    gen_jmp_im(s, cur_eip);
+    gen_helper_uc_intr(tcg_ctx, handled, tcg_const_ptr(tcg_ctx, s->uc),
+                       tcg_const_i32(tcg_ctx, intno));
+    tcg_gen_brcondi_i32(tcg_ctx, TCG_COND_EQ, handled, 0, l1);
+    tcg_temp_free_i32(tcg_ctx, handled);
+    // cpu_exec() resumes after the instruction even if a hook moved EIP
+    gen_jmp_im(s, next_eip);
+    gen_set_label(tcg_ctx, l1);
+    gen_eob(s);
+}
+
 static void gen_debug(DisasContext *s, target_ulong cur_eip)
 {
     TCGContext *tcg_ctx = s->uc->tcg_ctx;
@@ -2913,6 +2936,21 @@ static void gen_jmp(DisasContext *s, target_ulong eip)
     gen_jmp_tb(s, eip, 0);
 }
 
+/* Unicorn: a superblock goes on translating at the target of a direct jump
+   forward within its page instead of ending there, so the extra code stays
+   inside [tb->pc, tb->pc + tb->size).  */
+static bool gen_jmp_follow(DisasContext *s, target_ulong eip)
+{
+    target_ulong pc = s->cs_base + eip;
+
+    if (!(s->tb->cflags & CF_SUPERBLOCK) || !s->jmp_opt || pc < s->pc ||
+        (pc & TARGET_PAGE_MASK) != (s->tb->pc & TARGET_PAGE_MASK)) {
+        return false;
+    }
+    s->follow_pc = pc;
+    return true;
+}
+
 static inline void gen_ldq_env_A0(DisasContext *s, int offset)
 {
     TCGContext *tcg_ctx = s->uc->tcg_ctx;
@@ -7132,7 +7170,9 @@ static target_ulong disas_insn(CPUX86State *env, DisasContext *s,
         } else if (!CODE64(s)) {
             tval &= 0xffffffff;
         }
-        gen_jmp(s, tval);
+        if (!gen_jmp_follow(s, tval)) {
+            gen_jmp(s, tval);
+        }
         break;
     case 0xea: /* ljmp im */
         {
@@ -7154,7 +7194,9 @@ static target_ulong disas_insn(CPUX86State *env, DisasContext *s,
         if (dflag == MO_16) {
             tval &= 0xffff;
         }
-        gen_jmp(s, tval);
+        if (!gen_jmp_follow(s, tval)) {
+            gen_jmp(s, tval);
+        }
         break;
     //case 0x70 ... 0x7f: /* jcc Jb */
     case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x76: case 0x77:
@@ -7553,6 +7595,8 @@ static target_ulong disas_insn(CPUX86State *env, DisasContext *s,
         val = cpu_ldub_code(env, s->pc++);
         if (s->vm86 && s->iopl != 3) {
             gen_exception(s, EXCP0D_GPF, pc_start - s->cs_base);
+        } else if (s->jmp_opt && HOOK_EXISTS(env->uc, UC_HOOK_INTR)) {
+            gen_interrupt_hooked(s, val, pc_start - s->cs_base, s->pc - s->cs_base);
         } else {
             gen_interrupt(s, val, pc_start - s->cs_base, s->pc - s->cs_base);
         }
@@ -8638,6 +8682,7 @@ static inline void gen_intermediate_code_internal(uint8_t *gen_opc_cc_op,
     dc->code64 = (flags >> HF_CS64_SHIFT) & 1;
 #endif
     dc->flags = flags;
+    dc->follow_pc = 0;
     dc->jmp_opt = !(dc->tf || cs->singlestep_enabled ||
                     (flags & HF_INHIBIT_IRQ_MASK)
 #ifndef CONFIG_SOFTMMU
@@ -8746,6 +8791,10 @@ static inline void gen_intermediate_code_internal(uint8_t *gen_opc_cc_op,
         /* stop translation if indicated */
         if (dc->is_jmp)
             break;
+        if (dc->follow_pc) {
+            pc_ptr = dc->follow_pc;
+            dc->follow_pc = 0;
+        }
         /* if single step mode, we generate only one instruction and
            generate an exception */
         /* if irq were inhibited with HF_INHIBIT_IRQ_MASK, we clear
@@ -1349,6 +1349,66 @@ static bool x86_insn_hook_validate(uint32_t insn_enum)
     return true;
 }
 
+// uc_reg_ptr(): general purpose registers and the instruction pointer, in
+// the width of the mode. 32-bit registers are the low half of their slot.
+static void *x86_reg_ptr(struct uc_struct *uc, unsigned int regid, size_t *size)
+{
+    CPUX86State *env = uc->cpu->env_ptr;
+    target_ulong *reg;
+
+    switch(uc->mode) {
+        default:
+            return NULL;
+        case UC_MODE_32:
+            switch(regid) {
+                default: return NULL;
+                case UC_X86_REG_EAX: reg = &env->regs[R_EAX]; break;
+                case UC_X86_REG_EBX: reg = &env->regs[R_EBX]; break;
+                case UC_X86_REG_ECX: reg = &env->regs[R_ECX]; break;
+                case UC_X86_REG_EDX: reg = &env->regs[R_EDX]; break;
+                case UC_X86_REG_ESI: reg = &env->regs[R_ESI]; break;
+                case UC_X86_REG_EDI: reg = &env->regs[R_EDI]; break;
+                case UC_X86_REG_EBP: reg = &env->regs[R_EBP]; break;
+                case UC_X86_REG_ESP: reg = &env->regs[R_ESP]; break;
+                case UC_X86_REG_EIP: reg = &env->eip; break;
+            }
+            *size = 4;
+#ifdef HOST_WORDS_BIGENDIAN
+            return (uint32_t *)reg + 1;
+#else
+            return reg;
+#endif
+        case UC_MODE_64:
+            if (regid >= UC_X86_REG_R8 && regid <= UC_X86_REG_R15) {
+                reg = &env->regs[8 + regid - UC_X86_REG_R8];
+            } else {
+                switch(regid) {
+                    default: return NULL;
+                    case UC_X86_REG_RAX: reg = &env->regs[R_EAX]; break;
+                    case UC_X86_REG_RBX: reg = &env->regs[R_EBX]; break;
+                    case UC_X86_REG_RCX: reg = &env->regs[R_ECX]; break;
+                    case UC_X86_REG_RDX: reg = &env->regs[R_EDX]; break;
+                    case UC_X86_REG_RSI: reg = &env->regs[R_ESI]; break;
+                    case UC_X86_REG_RDI: reg = &env->regs[R_EDI]; break;
+                    case UC_X86_REG_RBP: reg = &env->regs[R_EBP]; break;
+                    case UC_X86_REG_RSP: reg = &env->regs[R_ESP]; break;
+                    case UC_X86_REG_RIP: reg = &env->eip; break;
+                }
+            }
+            *size = 8;
+            return reg;
+    }
+}
+
+// registers switched between guest threads by uc_sched_start(): the
+// general, segment, x87/MMX and SSE/AVX state.  Control registers, descriptor
+// tables and MSRs are system state the threads share.
+static const struct uc_span x86_thread_regs[] = {
+    { offsetof(CPUX86State, regs), offsetof(CPUX86State, ldt) - offsetof(CPUX86State, regs) },
+    { offsetof(CPUX86State, fpstt), offsetof(CPUX86State, sysenter_cs) - offsetof(CPUX86State, fpstt) },
+    { 0, 0 },
+};
+
 DEFAULT_VISIBILITY
 void x86_uc_init(struct uc_struct* uc)
 {
@@ -1361,10 +1421,12 @@ void x86_uc_init(struct uc_struct* uc)
     uc->reg_read = x86_reg_read;
     uc->reg_write = x86_reg_write;
     uc->reg_reset = x86_reg_reset;
+    uc->reg_ptr = x86_reg_ptr;
     uc->release = x86_release;
     uc->set_pc = x86_set_pc;
     uc->stop_interrupt = x86_stop_interrupt;
     uc->insn_hook_validate = x86_insn_hook_validate;
+    uc->thread_regs = x86_thread_regs;
     uc_common_init(uc);
 }
 
@@ -54,6 +54,22 @@ void m68k_reg_reset(struct uc_struct *uc)
     env->pc = 0;
 }
 
+// uc_reg_ptr(): A0-A7, D0-D7 and PC
+static void *m68k_reg_ptr(struct uc_struct *uc, unsigned int regid, size_t *size)
+{
+    CPUM68KState *env = uc->cpu->env_ptr;
+
+    *size = 4;
+    if (regid >= UC_M68K_REG_A0 && regid <= UC_M68K_REG_A7)
+        return &env->aregs[regid - UC_M68K_REG_A0];
+    if (regid >= UC_M68K_REG_D0 && regid <= UC_M68K_REG_D7)
+        return &env->dregs[regid - UC_M68K_REG_D0];
+    if (regid == UC_M68K_REG_PC)
+        return &env->pc;
+
+    return NULL;
+}
+
 int m68k_reg_read(struct uc_struct *uc, unsigned int *regs, void **vals, int count)
 {
     CPUState *mycpu = uc->cpu;
@@ -117,6 +133,7 @@ void m68k_uc_init(struct uc_struct* uc)
     uc->reg_read = m68k_reg_read;
     uc->reg_write = m68k_reg_write;
     uc->reg_reset = m68k_reg_reset;
+    uc->reg_ptr = m68k_reg_ptr;
     uc->set_pc = m68k_set_pc;
     uc_common_init(uc);
 }
@@ -4436,6 +4436,37 @@ static inline void gen_goto_tb(DisasContext *ctx, int n, target_ulong dest)
     }
 }
 
+/* SYSCALL.  Unicorn: with interrupt hooks, run them in place and go on
+   with the next instruction when one of them handled the trap.  The TB
+   ends either way: a hook may have changed the flags the next block is
+   looked up by.  */
+static void gen_syscall(DisasContext *ctx)
+{
+    TCGContext *tcg_ctx = ctx->uc->tcg_ctx;
+    TCGv_i32 handled;
+    int l1;
+
+    if (ctx->singlestep_enabled || (ctx->hflags & MIPS_HFLAG_BMASK) ||
+        !HOOK_EXISTS(ctx->uc, UC_HOOK_INTR)) {
+        generate_exception(ctx, EXCP_SYSCALL);
+        ctx->bstate = BS_STOP;
+        return;
+    }
+
+    handled = tcg_temp_new_i32(tcg_ctx);
+    l1 = gen_new_label(tcg_ctx);
+    save_cpu_state(ctx, 1);
+    gen_helper_uc_intr(tcg_ctx, handled, tcg_const_ptr(tcg_ctx, ctx->uc),
+                       tcg_const_i32(tcg_ctx, EXCP_SYSCALL));
+    tcg_gen_brcondi_i32(tcg_ctx, TCG_COND_EQ, handled, 0, l1);
+    tcg_temp_free_i32(tcg_ctx, handled);
+    /* cpu_exec() resumes after the instruction even if a hook moved the PC */
+    gen_save_pc(ctx, ctx->pc + 4);
+    gen_set_label(tcg_ctx, l1);
+    tcg_gen_exit_tb(tcg_ctx, 0);
+    ctx->bstate = BS_BRANCH;
+}
+
 /* Branches (before delay slot) */
 static void gen_compute_branch (DisasContext *ctx, uint32_t opc,
                                 int insn_bytes,
@@ -12835,8 +12866,7 @@ static void gen_pool32axf (CPUMIPSState *env, DisasContext *ctx, int rt, int rs)
             /* NOP */
             break;
         case SYSCALL:
-            generate_exception(ctx, EXCP_SYSCALL);
-            ctx->bstate = BS_STOP;
+            gen_syscall(ctx);
             break;
         case SDBBP:
             check_insn(ctx, ISA_MIPS32);
@@ -16477,8 +16507,7 @@ static void decode_opc_special(CPUMIPSState *env, DisasContext *ctx)
         }
         break;
     case OPC_SYSCALL:
-        generate_exception(ctx, EXCP_SYSCALL);
-        ctx->bstate = BS_STOP;
+        gen_syscall(ctx);
         break;
     case OPC_BREAK:
         generate_exception(ctx, EXCP_BREAK);
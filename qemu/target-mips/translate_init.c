@@ -858,6 +858,7 @@ static void mmu_init (CPUMIPSState *env, const mips_def_t *def)
     MIPSCPU *cpu = mips_env_get_cpu(env);
 
     env->tlb = g_malloc0(sizeof(CPUMIPSTLBContext));
+    env->tlb->random_lfsr = 1;
 
     switch (def->mmu_type) {
         case MMU_TYPE_NONE:
@@ -80,6 +80,20 @@ void mips_reg_reset(struct uc_struct *uc)
     env->active_tc.PC = 0;
 }
 
+// uc_reg_ptr(): $0-$31 and PC
+static void *mips_reg_ptr(struct uc_struct *uc, unsigned int regid, size_t *size)
+{
+    CPUMIPSState *env = uc->cpu->env_ptr;
+
+    *size = sizeof(target_ulong);
+    if (regid >= UC_MIPS_REG_0 && regid <= UC_MIPS_REG_31)
+        return &env->active_tc.gpr[regid - UC_MIPS_REG_0];
+    if (regid == UC_MIPS_REG_PC)
+        return &env->active_tc.PC;
+
+    return NULL;
+}
+
 int mips_reg_read(struct uc_struct *uc, unsigned int *regs, void **vals, int count)
 {
     CPUState *mycpu = uc->cpu;
@@ -150,6 +164,7 @@ DEFAULT_VISIBILITY
     uc->reg_read = mips_reg_read;
     uc->reg_write = mips_reg_write;
     uc->reg_reset = mips_reg_reset;
+    uc->reg_ptr = mips_reg_ptr;
     uc->release = mips_release;
     uc->set_pc = mips_set_pc;
     uc->mem_redirect = mips_mem_redirect;
@@ -0,0 +1,516 @@
+/*
+ *  Persistent translation block cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Translated host code is saved together with its TB metadata and the
+ * relocations recorded by the TCG backend: helper addresses, addresses
+ * inside the TB, exit_tb values and the jump to the epilogue.  An engine of
+ * the same architecture and mode, running the same build of the library,
+ * maps the file and installs a saved TB instead of translating it when the
+ * guest bytes still hash to the saved value.
+ *
+ * Only TBs translated while the engine has no hooks are saved, since hooks
+ * embed engine pointers in the generated code.  TBs spanning two guest
+ * pages, TBs that contain the uc_emu_start() end address and TBs loading
+ * host pointers through tcg_const_ptr() are never saved either.
+ *
+ * File layout: TBCacheHeader, nb_entries TBCacheEntry records, then for
+ * each entry its host code padded to 8 bytes followed by its TBCacheReloc
+ * records.  New TBs are kept in memory and the file is rewritten when the
+ * engine is closed.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "config.h"
+#include "qemu-common.h"
+#define NO_CPU_IO_DEFS
+#include "cpu.h"
+#include "tcg.h"
+#include "exec/ram_addr.h"
+#include "translate-all.h"
+
+#include "uc_priv.h"
+
+#define TB_CACHE_MAGIC      "UCTBC\r\n\032"
+#define TB_CACHE_VERSION    1
+
+#define FNV_OFFSET_BASIS    0xcbf29ce484222325ULL
+#define FNV_PRIME           0x100000001b3ULL
+
+typedef struct TBCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t arch;
+    uint32_t mode;
+    uint32_t nb_entries;
+    uint64_t build_id;
+} TBCacheHeader;
+
+typedef struct TBCacheEntry {
+    uint64_t pc;
+    uint64_t cs_base;
+    uint64_t code_hash;     /* hash of the guest bytes */
+    uint64_t data;          /* file offset of host code and relocations */
+    uint32_t flags;
+    uint32_t cflags;
+    uint32_t code_size;     /* host bytes */
+    uint16_t size;          /* guest bytes */
+    uint16_t nb_relocs;
+    uint16_t tb_next_offset[2];
+    uint16_t tb_jmp_offset[2];
+    uint32_t block_full;
+} TBCacheEntry;
+
+typedef struct TBCacheReloc {
+    uint32_t kind;          /* TCGCodeRelocKind */
+    uint32_t offset;        /* from the start of the TB */
+    int64_t value;          /* see tb_cache_store() */
+} TBCacheReloc;
+
+typedef struct TBCacheSlot {
+    TBCacheEntry e;
+    const uint8_t *data;            /* host code, then relocations */
+    struct TBCacheSlot *next_new;   /* TBs added by this engine */
+} TBCacheSlot;
+
+struct TBCache {
+    char *path;
+    uint64_t build_id;
+    void *map;                  /* the cache file, or NULL */
+    size_t map_size;
+    TBCacheSlot *map_slots;     /* one per entry of the file */
+    TBCacheSlot *new_slots;
+    GHashTable *index;          /* TBCacheSlot by pc, cs_base and flags */
+};
+
+static uint64_t tb_cache_fnv(const void *buf, size_t len, uint64_t h)
+{
+    const uint8_t *p = buf;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+/* Saved helper addresses are relative to tcg_exec_init(), so the file is
+   only valid for the build that wrote it.  The distances to a few other
+   functions change whenever the library is rebuilt.  */
+static uint64_t tb_cache_build_id(void)
+{
+    intptr_t anchor = (intptr_t)tcg_exec_init;
+    int64_t v[] = {
+        (intptr_t)tcg_gen_code - anchor,
+        (intptr_t)cpu_exec - anchor,
+        (intptr_t)tb_flush - anchor,
+        (intptr_t)helper_ret_ldub_mmu - anchor,
+        sizeof(CPUArchState),
+        TARGET_PAGE_BITS,
+    };
+
+    return tb_cache_fnv(v, sizeof(v), FNV_OFFSET_BASIS);
+}
+
+static guint tb_cache_slot_hash(gconstpointer p)
+{
+    const TBCacheSlot *slot = p;
+
+    return (guint)(slot->e.pc ^ (slot->e.pc >> 32) ^ slot->e.cs_base ^
+                   slot->e.flags);
+}
+
+static gboolean tb_cache_slot_equal(gconstpointer a, gconstpointer b)
+{
+    const TBCacheSlot *x = a, *y = b;
+
+    return x->e.pc == y->e.pc && x->e.cs_base == y->e.cs_base &&
+           x->e.flags == y->e.flags;
+}
+
+static size_t tb_cache_data_size(const TBCacheEntry *e)
+{
+    return ROUND_UP(e->code_size, 8) + e->nb_relocs * sizeof(TBCacheReloc);
+}
+
+/* Hooks are compiled into the TB with the engine pointer as an argument.  */
+static bool tb_cache_usable(struct uc_struct *uc)
+{
+    int i;
+
+    for (i = 0; i < UC_HOOK_MAX; i++) {
+        if (uc->hook[i].head) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* The translator stops at the uc_emu_start() end address, so a TB that
+   covers it differs from one translated with another end address.  */
+static bool tb_cache_stop_outside(struct uc_struct *uc, target_ulong pc,
+                                  int size)
+{
+    return uc->addr_end < pc || uc->addr_end > (uint64_t)pc + size;
+}
+
+/* A block wanted in the cold tier can start out as the superblock that a
+   previous run already built for it.  */
+static bool tb_cache_cflags_match(uint32_t saved, uint32_t wanted)
+{
+    return saved == wanted ||
+           ((wanted & CF_COLD) &&
+            saved == ((wanted & ~CF_COLD) | CF_SUPERBLOCK));
+}
+
+static uint64_t tb_cache_code_hash(struct uc_struct *uc,
+                                   tb_page_addr_t phys_pc, int size)
+{
+    return tb_cache_fnv(qemu_get_ram_ptr(uc, phys_pc), size,
+                        FNV_OFFSET_BASIS);
+}
+
+static void tb_cache_map(struct uc_struct *uc, struct TBCache *c)
+{
+    const TBCacheHeader *h;
+    const TBCacheEntry *entries;
+    struct stat st;
+    uint32_t i, n;
+    int fd;
+
+    fd = open(c->path, O_RDONLY | O_BINARY);
+    if (fd < 0) {
+        return;
+    }
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TBCacheHeader)) {
+        c->map = qemu_file_ram_alloc(fd, 0, st.st_size);
+        c->map_size = st.st_size;
+    }
+    close(fd);
+    if (!c->map) {
+        return;
+    }
+
+    h = c->map;
+    n = h->nb_entries;
+    if (memcmp(h->magic, TB_CACHE_MAGIC, sizeof(h->magic)) ||
+        h->version != TB_CACHE_VERSION || h->arch != uc->arch ||
+        h->mode != uc->mode || h->build_id != c->build_id ||
+        n > (c->map_size - sizeof(*h)) / sizeof(TBCacheEntry)) {
+        /* stale or foreign: it is rewritten on close */
+        return;
+    }
+
+    entries = (const TBCacheEntry *)(h + 1);
+    c->map_slots = g_new(TBCacheSlot, n);
+    for (i = 0; i < n; i++) {
+        TBCacheSlot *slot = &c->map_slots[i];
+
+        slot->e = entries[i];
+        if (slot->e.data > c->map_size ||
+            tb_cache_data_size(&slot->e) > c->map_size - slot->e.data ||
+            slot->e.code_size > TCG_MAX_OP_SIZE * OPC_BUF_SIZE) {
+            continue;
+        }
+        slot->data = (const uint8_t *)c->map + slot->e.data;
+        slot->next_new = NULL;
+        g_hash_table_insert(c->index, slot, slot);
+    }
+}
+
+void tb_cache_open(struct uc_struct *uc, const char *path)
+{
+    TCGContext *s = uc->tcg_ctx;
+    struct TBCache *c;
+
+    /* only backends that record relocations can produce movable code */
+    if (!TCG_TARGET_CODE_RELOC) {
+        return;
+    }
+
+    c = g_new0(struct TBCache, 1);
+    c->path = g_strdup(path);
+    c->build_id = tb_cache_build_id();
+    c->index = g_hash_table_new(tb_cache_slot_hash, tb_cache_slot_equal);
+    s->tb_cache = c;
+    s->code_gen_reloc = true;
+
+    tb_cache_map(uc, c);
+}
+
+/* Install a saved TB for @tb->pc into @tb->tc_ptr.  Returns the host code
+   size, or 0 if @tb must be translated.  */
+int tb_cache_load(struct uc_struct *uc, TranslationBlock *tb,
+                  tb_page_addr_t phys_pc)
+{
+    TCGContext *s = uc->tcg_ctx;
+    struct TBCache *c = s->tb_cache;
+    uintptr_t anchor = (uintptr_t)tcg_exec_init;
+    uint8_t *code = tb->tc_ptr;
+    const TBCacheReloc *r;
+    TBCacheSlot key, *slot;
+    int i;
+
+    if (phys_pc == -1 || !tb_cache_usable(uc)) {
+        return 0;
+    }
+
+    key.e.pc = tb->pc;
+    key.e.cs_base = tb->cs_base;
+    key.e.flags = tb->flags;
+    slot = g_hash_table_lookup(c->index, &key);
+    if (!slot || !tb_cache_cflags_match(slot->e.cflags, tb->cflags) ||
+        !tb_cache_stop_outside(uc, tb->pc, slot->e.size) ||
+        (tb->pc & ~TARGET_PAGE_MASK) + slot->e.size > TARGET_PAGE_SIZE ||
+        tb_cache_code_hash(uc, phys_pc, slot->e.size) != slot->e.code_hash) {
+        uc->tb_cache_misses++;
+        return 0;
+    }
+
+    memcpy(code, slot->data, slot->e.code_size);
+    r = (const TBCacheReloc *)(slot->data + ROUND_UP(slot->e.code_size, 8));
+    for (i = 0; i < slot->e.nb_relocs; i++, r++) {
+        uintptr_t addr;
+        int32_t disp;
+        size_t width = r->kind == TCG_RELOC_RET ? sizeof(disp) : sizeof(addr);
+
+        /* a damaged entry: translate over it */
+        if (r->offset + width > slot->e.code_size) {
+            uc->tb_cache_misses++;
+            return 0;
+        }
+        switch (r->kind) {
+        case TCG_RELOC_HELPER:
+            addr = anchor + r->value;
+            break;
+        case TCG_RELOC_CODE:
+            addr = (uintptr_t)code + r->value;
+            break;
+        case TCG_RELOC_TB:
+            addr = (uintptr_t)tb + r->value;
+            break;
+        case TCG_RELOC_RET:
+            disp = (int32_t)((uint8_t *)s->tb_ret_addr - (code + r->offset + 4));
+            memcpy(code + r->offset, &disp, sizeof(disp));
+            continue;
+        default:
+            uc->tb_cache_misses++;
+            return 0;
+        }
+        memcpy(code + r->offset, &addr, sizeof(addr));
+    }
+
+    tb->cflags = slot->e.cflags;
+    tb->size = slot->e.size;
+    tb->tb_next_offset[0] = slot->e.tb_next_offset[0];
+    tb->tb_next_offset[1] = slot->e.tb_next_offset[1];
+#ifdef USE_DIRECT_JUMP
+    tb->tb_jmp_offset[0] = slot->e.tb_jmp_offset[0];
+    tb->tb_jmp_offset[1] = slot->e.tb_jmp_offset[1];
+#endif
+    uc->block_full = slot->e.block_full;
+    flush_icache_range((uintptr_t)code, (uintptr_t)code + slot->e.code_size);
+
+    uc->tb_cache_hits++;
+    return slot->e.code_size;
+}
+
+/* Save @tb, just translated into @code_size bytes, if it can be moved.  */
+void tb_cache_store(struct uc_struct *uc, TranslationBlock *tb,
+                    tb_page_addr_t phys_pc, tb_page_addr_t phys_page2,
+                    int code_size)
+{
+    TCGContext *s = uc->tcg_ctx;
+    struct TBCache *c = s->tb_cache;
+    uintptr_t anchor = (uintptr_t)tcg_exec_init;
+    TBCacheReloc *r;
+    TBCacheSlot *slot;
+    uint8_t *data;
+    int i;
+
+    if (s->code_gen_host_ptr || s->nb_code_relocs > TCG_MAX_CODE_RELOCS ||
+        phys_pc == -1 || phys_page2 != -1 || tb->size == 0 ||
+        !tb_cache_stop_outside(uc, tb->pc, tb->size) ||
+        !tb_cache_usable(uc)) {
+        return;
+    }
+
+    slot = g_malloc(sizeof(*slot) + ROUND_UP(code_size, 8) +
+                    s->nb_code_relocs * sizeof(TBCacheReloc));
+    data = (uint8_t *)(slot + 1);
+    slot->e.pc = tb->pc;
+    slot->e.cs_base = tb->cs_base;
+    slot->e.flags = tb->flags;
+    slot->e.cflags = tb->cflags;
+    slot->e.code_hash = tb_cache_code_hash(uc, phys_pc, tb->size);
+    slot->e.code_size = code_size;
+    slot->e.size = tb->size;
+    slot->e.nb_relocs = s->nb_code_relocs;
+    slot->e.tb_next_offset[0] = tb->tb_next_offset[0];
+    slot->e.tb_next_offset[1] = tb->tb_next_offset[1];
+#ifdef USE_DIRECT_JUMP
+    slot->e.tb_jmp_offset[0] = tb->tb_jmp_offset[0];
+    slot->e.tb_jmp_offset[1] = tb->tb_jmp_offset[1];
+#else
+    slot->e.tb_jmp_offset[0] = slot->e.tb_jmp_offset[1] = 0xffff;
+#endif
+    slot->e.block_full = uc->block_full;
+    slot->e.data = 0;
+    slot->data = data;
+
+    memcpy(data, tb->tc_ptr, code_size);
+    memset(data + code_size, 0, ROUND_UP(code_size, 8) - code_size);
+    r = (TBCacheReloc *)(data + ROUND_UP(code_size, 8));
+    for (i = 0; i < s->nb_code_relocs; i++, r++) {
+        const TCGCodeReloc *cr = &s->code_relocs[i];
+
+        r->kind = cr->kind;
+        r->offset = cr->offset;
+        switch (cr->kind) {
+        case TCG_RELOC_HELPER:
+            r->value = (int64_t)(cr->value - anchor);
+            break;
+        case TCG_RELOC_CODE:
+            r->value = (int64_t)(cr->value - (uintptr_t)tb->tc_ptr);
+            break;
+        case TCG_RELOC_TB:
+            /* exit_tb values are the TB pointer plus an exit index */
+            r->value = (int64_t)(cr->value - (uintptr_t)tb);
+            if (r->value < 0 || r->value > 3) {
+                g_free(slot);
+                return;
+            }
+            break;
+        default:
+            r->value = 0;
+            break;
+        }
+    }
+
+    slot->next_new = c->new_slots;
+    c->new_slots = slot;
+    g_hash_table_insert(c->index, slot, slot);
+}
+
+static void tb_cache_collect(gpointer key, gpointer value, gpointer opaque)
+{
+    TBCacheSlot ***p = opaque;
+
+    *(*p)++ = value;
+}
+
+/* Write every live TB to a temporary file next to the cache.  */
+static char *tb_cache_write(struct uc_struct *uc, struct TBCache *c)
+{
+    TBCacheSlot **slots, **p;
+    TBCacheHeader h;
+    uint64_t offset;
+    uint32_t i, n = g_hash_table_size(c->index);
+    char *tmp = g_strdup_printf("%s.%d.tmp", c->path, (int)getpid());
+    FILE *f;
+    bool ok = true;
+
+    f = fopen(tmp, "wb");
+    if (!f) {
+        g_free(tmp);
+        return NULL;
+    }
+
+    slots = p = g_new(TBCacheSlot *, n);
+    g_hash_table_foreach(c->index, tb_cache_collect, &p);
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TB_CACHE_MAGIC, sizeof(h.magic));
+    h.version = TB_CACHE_VERSION;
+    h.arch = uc->arch;
+    h.mode = uc->mode;
+    h.nb_entries = n;
+    h.build_id = c->build_id;
+    ok &= fwrite(&h, sizeof(h), 1, f) == 1;
+
+    offset = sizeof(h) + (uint64_t)n * sizeof(TBCacheEntry);
+    for (i = 0; i < n && ok; i++) {
+        TBCacheEntry e = slots[i]->e;
+
+        e.data = offset;
+        offset += tb_cache_data_size(&e);
+        ok &= fwrite(&e, sizeof(e), 1, f) == 1;
+    }
+    for (i = 0; i < n && ok; i++) {
+        ok &= fwrite(slots[i]->data, tb_cache_data_size(&slots[i]->e), 1, f) == 1;
+    }
+
+    g_free(slots);
+    ok &= fclose(f) == 0;
+    if (!ok) {
+        remove(tmp);
+        g_free(tmp);
+        return NULL;
+    }
+    return tmp;
+}
+
+void tb_cache_close(struct uc_struct *uc)
+{
+    TCGContext *s = uc->tcg_ctx;
+    struct TBCache *c = s->tb_cache;
+    TBCacheSlot *slot, *next;
+    char *tmp = NULL;
+
+    if (!c) {
+        return;
+    }
+
+    if (c->new_slots) {
+        tmp = tb_cache_write(uc, c);
+    }
+
+    g_hash_table_destroy(c->index);
+    for (slot = c->new_slots; slot; slot = next) {
+        next = slot->next_new;
+        g_free(slot);
+    }
+    g_free(c->map_slots);
+    qemu_file_ram_free(c->map, c->map_size);
+
+    /* replace the file only once it is no longer mapped */
+    if (tmp) {
+#ifdef _WIN32
+        remove(c->path);
+#endif
+        if (rename(tmp, c->path)) {
+            remove(tmp);
+        }
+        g_free(tmp);
+    }
+
+    g_free(c->path);
+    g_free(c);
+    s->tb_cache = NULL;
+    s->code_gen_reloc = false;
+}
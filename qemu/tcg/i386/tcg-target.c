@@ -135,10 +135,9 @@ static bool have_cmov;
 #endif
 
 /* If bit_MOVBE is defined in cpuid.h (added in GCC version 4.6), we are
-   going to attempt to determine at runtime whether movbe is available.  */
-#if defined(CONFIG_CPUID_H) && defined(bit_MOVBE)
-static bool have_movbe;
-#else
+   going to attempt to determine at runtime whether movbe is available.
+   The result is kept in TCGContext::have_movbe.  */
+#if !defined(CONFIG_CPUID_H) || !defined(bit_MOVBE)
 # define have_movbe 0
 #endif
 
@@ -152,8 +151,6 @@ static bool have_bmi2;
 # define have_bmi2 0
 #endif
 
-static tcg_insn_unit *tb_ret_addr;
-
 static void patch_reloc(tcg_insn_unit *code_ptr, int type,
                         intptr_t value, intptr_t addend)
 {
@@ -692,9 +689,10 @@ static void tcg_out_movi(TCGContext *s, TCGType type,
         return;
     }
 
-    /* Try a 7 byte pc-relative lea before the 10 byte movq.  */
+    /* Try a 7 byte pc-relative lea before the 10 byte movq.  Relocatable
+       code must not depend on where it is placed.  */
     diff = arg - ((uintptr_t)s->code_ptr + 7);
-    if (diff == (int32_t)diff) {
+    if (diff == (int32_t)diff && !s->code_gen_reloc) {
         tcg_out_opc(s, OPC_LEA | P_REXW, ret, 0, 0);
         tcg_out8(s, (LOWREGMASK(ret) << 3) | 5);
         tcg_out32(s, diff);
@@ -705,6 +703,25 @@ static void tcg_out_movi(TCGContext *s, TCGType type,
     tcg_out64(s, arg);
 }
 
+/* Load a host address.  When generating code for the persistent TB cache,
+   use the full-width encoding and record it, so the TB has the same layout
+   wherever it is installed.  */
+static void tcg_out_movi_reloc(TCGContext *s, TCGReg ret, uintptr_t arg,
+                               int kind)
+{
+    if (!s->code_gen_reloc) {
+        tcg_out_movi(s, TCG_TYPE_PTR, ret, arg);
+        return;
+    }
+    tcg_out_opc(s, OPC_MOVL_Iv + P_REXW + LOWREGMASK(ret), 0, ret, 0);
+    tcg_code_reloc(s, kind, arg);
+    if (TCG_TARGET_REG_BITS == 64) {
+        tcg_out64(s, arg);
+    } else {
+        tcg_out32(s, arg);
+    }
+}
+
 static inline void tcg_out_pushi(TCGContext *s, tcg_target_long val)
 {
     if (val == (int8_t)val) {
@@ -1135,8 +1152,21 @@ static void tcg_out_branch(TCGContext *s, int call, tcg_insn_unit *dest)
 {
     intptr_t disp = tcg_pcrel_diff(s, dest) - 5;
 
+    /* Relocatable code reaches helpers through an absolute address, since
+       whether they are in rel32 range depends on where the TB lands.  */
+    if (s->code_gen_reloc && TCG_TARGET_REG_BITS == 64 &&
+        dest != s->tb_ret_addr && (dest < s->code_buf || dest > s->code_ptr)) {
+        tcg_out_movi_reloc(s, TCG_REG_R10, (uintptr_t)dest, TCG_RELOC_HELPER);
+        tcg_out_modrm(s, OPC_GRP5,
+                      call ? EXT5_CALLN_Ev : EXT5_JMPN_Ev, TCG_REG_R10);
+        return;
+    }
+
     if (disp == (int32_t)disp) {
         tcg_out_opc(s, call ? OPC_CALL_Jz : OPC_JMP_long, 0, 0, 0);
+        if (s->code_gen_reloc && dest == s->tb_ret_addr) {
+            tcg_code_reloc(s, TCG_RELOC_RET, (uintptr_t)dest);
+        }
         tcg_out32(s, disp);
     } else {
         tcg_out_movi(s, TCG_TYPE_PTR, TCG_REG_R10, (uintptr_t)dest);
@@ -1411,8 +1441,8 @@ static void tcg_out_qemu_ld_slow_path(TCGContext *s, TCGLabelQemuLdst *l)
         tcg_out_mov(s, TCG_TYPE_PTR, tcg_target_call_iarg_regs[0], TCG_AREG0);
         /* The second argument is already loaded with addrlo.  */
         tcg_out_movi(s, TCG_TYPE_I32, tcg_target_call_iarg_regs[2], oi);
-        tcg_out_movi(s, TCG_TYPE_PTR, tcg_target_call_iarg_regs[3],
-                     (uintptr_t)l->raddr);
+        tcg_out_movi_reloc(s, tcg_target_call_iarg_regs[3],
+                           (uintptr_t)l->raddr, TCG_RELOC_CODE);
     }
 
     tcg_out_call(s, qemu_ld_helpers[opc & (MO_BSWAP | MO_SIZE)]);
@@ -1510,10 +1540,12 @@ static void tcg_out_qemu_st_slow_path(TCGContext *s, TCGLabelQemuLdst *l)
 
         if (ARRAY_SIZE(tcg_target_call_iarg_regs) > 4) {
             retaddr = tcg_target_call_iarg_regs[4];
-            tcg_out_movi(s, TCG_TYPE_PTR, retaddr, (uintptr_t)l->raddr);
+            tcg_out_movi_reloc(s, retaddr, (uintptr_t)l->raddr,
+                               TCG_RELOC_CODE);
         } else {
             retaddr = TCG_REG_RAX;
-            tcg_out_movi(s, TCG_TYPE_PTR, retaddr, (uintptr_t)l->raddr);
+            tcg_out_movi_reloc(s, retaddr, (uintptr_t)l->raddr,
+                               TCG_RELOC_CODE);
             tcg_out_st(s, TCG_TYPE_PTR, retaddr, TCG_REG_ESP,
                        TCG_TARGET_CALL_STACK_OFFSET);
         }
@@ -1875,7 +1907,11 @@ static inline void tcg_out_op(TCGContext *s, TCGOpcode opc,
 
     switch(opc) {
     case INDEX_op_exit_tb:
-        tcg_out_movi(s, TCG_TYPE_PTR, TCG_REG_EAX, args[0]);
+        if (args[0] != 0) {
+            tcg_out_movi_reloc(s, TCG_REG_EAX, args[0], TCG_RELOC_TB);
+        } else {
+            tcg_out_movi(s, TCG_TYPE_PTR, TCG_REG_EAX, 0);
+        }
         tcg_out_jmp(s, s->tb_ret_addr);
         break;
     case INDEX_op_goto_tb:
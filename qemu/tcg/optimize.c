@@ -29,16 +29,13 @@
 #include <stdio.h>
 
 #include "qemu-common.h"
+#include "qemu/bitmap.h"
 #include "tcg-op.h"
 
 #define CASE_OP_32_64(x)                        \
         glue(glue(case INDEX_op_, x), _i32):    \
         glue(glue(case INDEX_op_, x), _i64)
 
-/* Reset TEMP's state to TCG_TEMP_UNDEF.  If TEMP only had one copy, remove
-   the copy flag from the left temp.  */
-static TCGTempSet temps_used;
-   
 static inline bool temp_is_const(TCGContext *s, TCGArg arg)
 {
     struct tcg_temp_info *temps = s->temps2;
@@ -50,6 +47,9 @@ static inline bool temp_is_copy(TCGContext *s, TCGArg arg)
     struct tcg_temp_info *temps = s->temps2;
     return temps[arg].next_copy != arg;
 }
+
+/* Reset TEMP's state to TCG_TEMP_UNDEF.  If TEMP only had one copy, remove
+   the copy flag from the left temp.  */
 static void reset_temp(TCGContext *s, TCGArg temp)
 {
     struct tcg_temp_info *temps = s->temps2;
@@ -61,21 +61,21 @@ static void reset_temp(TCGContext *s, TCGArg temp)
     temps[temp].mask = -1;
 }
 /* Reset all temporaries, given that there are NB_TEMPS of them.  */
-static void reset_all_temps(int nb_temps)
+static void reset_all_temps(TCGContext *s, int nb_temps)
 {
-    bitmap_zero(temps_used.l, nb_temps);
+    bitmap_zero(s->temps_used.l, nb_temps);
 }
 
 /* Initialize and activate a temporary.  */
 static void init_temp_info(TCGContext *s, TCGArg temp)
 {
     struct tcg_temp_info *temps = s->temps2;
-    if (!test_bit(temp, temps_used.l)) {
+    if (!test_bit(temp, s->temps_used.l)) {
         temps[temp].next_copy = temp;
         temps[temp].prev_copy = temp;
         temps[temp].is_const = false;
         temps[temp].mask = -1;
-        set_bit(temp, temps_used.l);
+        set_bit(temp, s->temps_used.l);
     }
 }
 
@@ -544,7 +544,6 @@ static TCGArg do_constant_folding_cond2(TCGContext *s, TCGArg *p1, TCGArg *p2, T
 
 static bool swap_commutative(TCGContext *s, TCGArg dest, TCGArg *p1, TCGArg *p2)
 {
-    struct tcg_temp_info *temps = s->temps2;
     TCGArg a1 = *p1, a2 = *p2;
     int sum = 0;
     sum += temp_is_const(s, a1);
@@ -562,7 +561,6 @@ static bool swap_commutative(TCGContext *s, TCGArg dest, TCGArg *p1, TCGArg *p2)
 
 static bool swap_commutative2(TCGContext *s, TCGArg *p1, TCGArg *p2)
 {
-    struct tcg_temp_info *temps = s->temps2;
     int sum = 0;
     sum += temp_is_const(s, p1[0]);
     sum += temp_is_const(s, p1[1]);
@@ -1242,7 +1240,7 @@ void tcg_optimize(TCGContext *s)
             tmp = do_constant_folding_cond2(s, &args[1], &args[3], args[5]);
             if (tmp != 2) {
             do_setcond_const:
-				tcg_opt_gen_movi(s, op, args, opc, args[0], tmp);
+                tcg_opt_gen_movi(s, op, args, args[0], tmp);
             } else if ((args[5] == TCG_COND_LT || args[5] == TCG_COND_GE)
                        && temp_is_const(s, args[3]) && temps[args[3]].val == 0
                        && temp_is_const(s, args[4]) && temps[args[4]].val == 0) {
@@ -1305,7 +1303,7 @@ void tcg_optimize(TCGContext *s)
             if (!(args[nb_oargs + nb_iargs + 1]
                   & (TCG_CALL_NO_READ_GLOBALS | TCG_CALL_NO_WRITE_GLOBALS))) {
                 for (i = 0; i < nb_globals; i++) {
-                    if (test_bit(i, temps_used.l)) {
+                    if (test_bit(i, s->temps_used.l)) {
                         reset_temp(s, i);
                     }
                 }
@@ -117,8 +117,6 @@ TCGOpDef tcg_op_defs[] = {
 };
 const size_t tcg_op_defs_max = ARRAY_SIZE(tcg_op_defs);
 
-static TCGRegSet tcg_target_available_regs[2];
-static TCGRegSet tcg_target_call_clobber_regs;
 
 #if TCG_TARGET_INSN_UNIT_SIZE == 1
 static QEMU_UNUSED_FUNC inline void tcg_out8(TCGContext *s, uint8_t v)
@@ -415,6 +413,9 @@ void tcg_func_start(TCGContext *s)
     s->gen_next_parm_idx = 0;
 
     s->be = tcg_malloc(s, sizeof(TCGBackendData));
+
+    s->code_gen_host_ptr = false;
+    s->nb_code_relocs = 0;
 }
 
 static inline void tcg_temp_alloc(TCGContext *s, int n)
@@ -2366,7 +2367,10 @@ static inline int tcg_gen_code_common(TCGContext *s,
 #endif
 
 #ifdef USE_TCG_OPTIMIZATIONS
-	tcg_optimize(s);
+    /* first-tier code is cheap to generate rather than fast to run */
+    if (!s->code_gen_cold) {
+        tcg_optimize(s);
+    }
 #endif
 
 #ifdef CONFIG_PROFILER
@@ -190,6 +190,29 @@ typedef struct TCGPool {
 
 #define TCG_MAX_TEMPS 512
 
+/* Backends that can record relocations for the persistent TB cache
+   (qemu/tb-cache.c) define this to 1.  */
+#ifndef TCG_TARGET_CODE_RELOC
+#define TCG_TARGET_CODE_RELOC 0
+#endif
+
+#define TCG_MAX_CODE_RELOCS 256
+
+/* Host addresses embedded in a TB that must be patched when the TB is
+   installed from the persistent TB cache.  */
+typedef enum TCGCodeRelocKind {
+    TCG_RELOC_HELPER,   /* absolute address of a function outside the buffer */
+    TCG_RELOC_CODE,     /* absolute address inside the TB */
+    TCG_RELOC_TB,       /* exit_tb value: TranslationBlock pointer + index */
+    TCG_RELOC_RET,      /* 32-bit pc-relative jump to tb_ret_addr */
+} TCGCodeRelocKind;
+
+typedef struct TCGCodeReloc {
+    uint32_t kind;
+    uint32_t offset;    /* from the start of the TB */
+    uintptr_t value;
+} TCGCodeReloc;
+
 /* when the size of the arguments of a called function is smaller than
    this value, they are statically allocated in the TB stack frame */
 #define TCG_STATIC_CALL_ARGS_SIZE 128
@@ -718,8 +741,29 @@ struct TCGContext {
     TCGv_i32 cpu_tmp2_i32, cpu_tmp3_i32;
     TCGv_i64 cpu_tmp1_i64;
 
+    /* qemu/tcg/<host>/tcg-target.c: epilogue of this context's prologue */
+    tcg_insn_unit *tb_ret_addr;
+
+    /* qemu/tb-cache.c: persistent TB cache of this engine, if any */
+    struct TBCache *tb_cache;
+    /* emit fixed-size encodings for host addresses and record them */
+    bool code_gen_reloc;
+    /* the current TB embeds a host pointer that cannot be relocated */
+    bool code_gen_host_ptr;
+    /* first-tier TB: generate code without running tcg_optimize() */
+    bool code_gen_cold;
+    /* CF_QUANTUM TB: gen_tb_start() counts its instructions */
+    bool code_gen_quantum;
+    /* UC_OPT_TB_COUNTS: gen_tb_start() increments this counter of the TB */
+    uint64_t *code_gen_counter;
+    int nb_code_relocs;
+    TCGCodeReloc code_relocs[TCG_MAX_CODE_RELOCS];
+
+    /* qemu/tcg/sparc/tcg-target.c: softmmu helper trampolines */
+    tcg_insn_unit *qemu_ld_trampoline[16];
+    tcg_insn_unit *qemu_st_trampoline[16];
+
     /* qemu/tcg/i386/tcg-target.c */
-    void *tb_ret_addr;
     int guest_base_flags;
     /* If bit_MOVBE is defined in cpuid.h (added in GCC version 4.6), we are
        going to attempt to determine at runtime whether movbe is available.  */
@@ -732,6 +776,7 @@ struct TCGContext {
 
     /* qemu/tcg/optimize.c */
     struct tcg_temp_info temps2[TCG_MAX_TEMPS];
+    TCGTempSet temps_used;
 
     /* qemu/target-m68k/translate.c */
     TCGv_i32 cpu_halted;
@@ -801,6 +846,8 @@ struct TCGContext {
     void *cpu_wim;
 
     int exitreq_label;  // gen_tb_start()
+    int quantum_label;  // gen_tb_start()
+    TCGArg *quantum_arg;    // instruction count, patched by gen_tb_end()
 };
 
 typedef struct TCGTargetOpDef {
@@ -829,7 +876,8 @@ void tcg_add_target_add_op_defs(TCGContext *s, const TCGTargetOpDef *tdefs);
 #define TCGV_NAT_TO_PTR(n) MAKE_TCGV_PTR(GET_TCGV_I32(n))
 #define TCGV_PTR_TO_NAT(n) MAKE_TCGV_I32(GET_TCGV_PTR(n))
 
-#define tcg_const_ptr(t, V) TCGV_NAT_TO_PTR(tcg_const_i32(t, (intptr_t)(V)))
+#define tcg_const_ptr(t, V) \
+    TCGV_NAT_TO_PTR(tcg_const_i32(tcg_host_ptr_used(t), (intptr_t)(V)))
 #define tcg_global_reg_new_ptr(U, R, N) \
     TCGV_NAT_TO_PTR(tcg_global_reg_new_i32(U, (R), (N)))
 #define tcg_global_mem_new_ptr(t, R, O, N) \
@@ -840,7 +888,8 @@ void tcg_add_target_add_op_defs(TCGContext *s, const TCGTargetOpDef *tdefs);
 #define TCGV_NAT_TO_PTR(n) MAKE_TCGV_PTR(GET_TCGV_I64(n))
 #define TCGV_PTR_TO_NAT(n) MAKE_TCGV_I64(GET_TCGV_PTR(n))
 
-#define tcg_const_ptr(t, V) TCGV_NAT_TO_PTR(tcg_const_i64(t, (intptr_t)(V)))
+#define tcg_const_ptr(t, V) \
+    TCGV_NAT_TO_PTR(tcg_const_i64(tcg_host_ptr_used(t), (intptr_t)(V)))
 #define tcg_global_reg_new_ptr(U, R, N) \
     TCGV_NAT_TO_PTR(tcg_global_reg_new_i64(U, (R), (N)))
 #define tcg_global_mem_new_ptr(t, R, O, N) \
@@ -949,6 +998,35 @@ static inline size_t tcg_current_code_size(TCGContext *s)
     return tcg_ptr_byte_diff(s->code_ptr, s->code_buf);
 }
 
+/**
+ * tcg_code_reloc
+ * @s: the tcg context
+ * @kind: a TCGCodeRelocKind
+ * @value: host address about to be emitted at the current code_ptr
+ *
+ * Record a relocation for the persistent TB cache.  A TB with more than
+ * TCG_MAX_CODE_RELOCS relocations is simply not cached.
+ */
+
+static inline void tcg_code_reloc(TCGContext *s, int kind, uintptr_t value)
+{
+    if (s->nb_code_relocs < TCG_MAX_CODE_RELOCS) {
+        TCGCodeReloc *r = &s->code_relocs[s->nb_code_relocs];
+        r->kind = kind;
+        r->offset = (uint32_t)tcg_current_code_size(s);
+        r->value = value;
+    }
+    s->nb_code_relocs++;
+}
+
+/* Host pointers loaded through tcg_const_ptr() cannot be relocated, so a TB
+   using one is never written to the persistent TB cache.  */
+static inline TCGContext *tcg_host_ptr_used(TCGContext *s)
+{
+    s->code_gen_host_ptr = true;
+    return s;
+}
+
 /* Combine the TCGMemOp and mmu_idx parameters into a single value.  */
 typedef uint32_t TCGMemOpIdx;
 
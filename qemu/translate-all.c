@@ -60,6 +60,8 @@
 #include "exec/cputlb.h"
 #include "translate-all.h"
 #include "qemu/timer.h"
+#include "qemu/perf-map.h"
+#include "qemu/probes.h"
 
 #include "uc_priv.h"
 
@@ -73,14 +75,12 @@
 #undef DEBUG_TB_CHECK
 #endif
 
-#define SMC_BITMAP_USE_THRESHOLD 10
-
 typedef struct PageDesc {
     /* list of TBs intersecting this ram page */
     TranslationBlock *first_tb;
-    /* in order to optimize self modifying code, we count the number
-       of lookups we do to a given page to use a bitmap */
-    unsigned int code_write_count;
+    /* bytes of the page covered by TBs, so that data writes to a page that
+       also holds code skip invalidation.  Built on the first write after
+       TBs are removed, and kept up to date as TBs are added.  */
     uint8_t *code_bitmap;
 #if defined(CONFIG_USER_ONLY)
     unsigned long flags;
@@ -117,9 +117,13 @@ typedef struct PageDesc {
 
 #define V_L1_SHIFT (L1_MAP_ADDR_SPACE_BITS - TARGET_PAGE_BITS - V_L1_BITS)
 
+#if defined(CONFIG_USER_ONLY)
+/* Only user-mode page protection needs these; softmmu keeps no
+   process-wide state here, so engines on other threads never race.  */
 static uintptr_t qemu_real_host_page_size;
 static uintptr_t qemu_host_page_size;
 static uintptr_t qemu_host_page_mask;
+#endif
 
 
 static void tb_link_page(struct uc_struct *uc, TranslationBlock *tb,
@@ -148,7 +152,16 @@ static void tb_clean_internal(struct uc_struct *uc, int i, void** lp)
 
 void tb_cleanup(struct uc_struct *uc)
 {
+    TCGContext *tcg_ctx = uc->tcg_ctx;
     int index = 0;
+
+    tb_cache_close(uc);
+    if (uc->perf_map) {
+        perf_map_close(uc->perf_map);
+    }
+    g_free(tcg_ctx->tb_ctx.tb_phys_hash);
+    tcg_ctx->tb_ctx.tb_phys_hash = NULL;
+
     /* Level 1.  Always allocated.  */
     void** lp = uc->l1_map + ((index >> V_L1_SHIFT) & (V_L1_SIZE - 1));
     /* Level 2..N-1.  */
@@ -176,6 +189,9 @@ static int cpu_gen_code(CPUArchState *env, TranslationBlock *tb, int *gen_code_s
     ti = profile_getclock();
 #endif
     tcg_func_start(s);
+    s->code_gen_cold = (tb->cflags & CF_COLD) != 0;
+    s->code_gen_quantum = (tb->cflags & CF_QUANTUM) != 0;
+    s->code_gen_counter = env->uc->tb_counts ? &tb->counter : NULL;
 
     gen_intermediate_code(env, tb);
 
@@ -224,21 +240,21 @@ static int cpu_gen_code(CPUArchState *env, TranslationBlock *tb, int *gen_code_s
 
 /* The cpu state corresponding to 'searched_pc' is restored.
  */
-static int cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
-                                     uintptr_t searched_pc)
+/* Retranslate @tb and return the index of the guest instruction whose host
+   code contains @searched_pc in the gen_opc_* arrays, or -1.  */
+static int tb_search_opc(CPUState *cpu, TranslationBlock *tb,
+                         uintptr_t searched_pc)
 {
     CPUArchState *env = cpu->env_ptr;
     TCGContext *s = cpu->uc->tcg_ctx;
     int j;
     uintptr_t tc_ptr;
-#ifdef CONFIG_PROFILER
-    int64_t ti;
-#endif
 
-#ifdef CONFIG_PROFILER
-    ti = profile_getclock();
-#endif
     tcg_func_start(s);
+    /* the retranslation must produce the same host code */
+    s->code_gen_cold = (tb->cflags & CF_COLD) != 0;
+    s->code_gen_quantum = (tb->cflags & CF_QUANTUM) != 0;
+    s->code_gen_counter = cpu->uc->tb_counts ? &tb->counter : NULL;
 
     gen_intermediate_code_pc(env, tb);
 
@@ -263,6 +279,25 @@ static int cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
     while (s->gen_opc_instr_start[j] == 0) {
         j--;
     }
+    return j;
+}
+
+static int cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
+                                     uintptr_t searched_pc)
+{
+    CPUArchState *env = cpu->env_ptr;
+    TCGContext *s = cpu->uc->tcg_ctx;
+    int j;
+#ifdef CONFIG_PROFILER
+    int64_t ti;
+#endif
+
+#ifdef CONFIG_PROFILER
+    ti = profile_getclock();
+#endif
+    j = tb_search_opc(cpu, tb, searched_pc);
+    if (j < 0)
+        return -1;
     cpu->icount_decr.u16.low -= s->gen_opc_icount[j];
 
     restore_state_to_opc(env, tb, j);
@@ -287,6 +322,52 @@ bool cpu_restore_state(CPUState *cpu, uintptr_t retaddr)
     return false;
 }
 
+/* Unicorn: move the execution counts of all TBs, including invalidated
+   ones still in tbs[], to the table of uc_tb_counts_read() */
+void tb_fold_counts(struct uc_struct *uc)
+{
+    TCGContext *tcg_ctx = uc->tcg_ctx;
+    TranslationBlock *tb;
+    int i;
+
+    for (i = 0; i < tcg_ctx->tb_ctx.nb_tbs; i++) {
+        tb = &tcg_ctx->tb_ctx.tbs[i];
+        if (tb->counter) {
+            uc_tb_count_add(uc, tb->pc, tb->size, tb->tc_size, tb->counter);
+            tb->counter = 0;
+        }
+    }
+}
+
+/* Unicorn: guest PC of a profiler sample, read from the CPU state.  Only
+   reads, as it runs in the signal handler that takes the sample.  */
+uint64_t tb_prof_env_pc(struct uc_struct *uc)
+{
+    CPUArchState *env = uc->cpu->env_ptr;
+    target_ulong pc, cs_base;
+    int flags;
+
+    cpu_get_tb_cpu_state(env, &pc, &cs_base, &flags);
+    return pc;
+}
+
+/* Unicorn: guest PC of the instruction running at @host_pc when a profiler
+   sample was taken, found the way cpu_restore_state() does but leaving the
+   CPU state alone.  False when @host_pc is not in a translated block.  */
+bool tb_prof_resolve(struct uc_struct *uc, uintptr_t host_pc, uint64_t *pc)
+{
+    TCGContext *s = uc->tcg_ctx;
+    TranslationBlock *tb = tb_find_pc(uc, host_pc);
+    int j;
+
+    if (!tb) {
+        return false;
+    }
+    j = tb_search_opc(uc->cpu, tb, host_pc);
+    *pc = j < 0 ? tb->pc : s->gen_opc_pc[j];
+    return true;
+}
+
 #ifdef _WIN32
 static inline QEMU_UNUSED_FUNC void map_exec(void *addr, long size)
 {
@@ -314,6 +395,7 @@ static inline QEMU_UNUSED_FUNC void map_exec(void *addr, long size)
 
 static void page_size_init(void)
 {
+#if defined(CONFIG_USER_ONLY)
     /* NOTE: we can always suppose that qemu_host_page_size >=
        TARGET_PAGE_SIZE */
     qemu_real_host_page_size = getpagesize();
@@ -324,6 +406,7 @@ static void page_size_init(void)
         qemu_host_page_size = TARGET_PAGE_SIZE;
     }
     qemu_host_page_mask = ~(qemu_host_page_size - 1);
+#endif
 }
 
 static void page_init(void)
@@ -477,8 +560,9 @@ static inline PageDesc *page_find(struct uc_struct *uc, tb_page_addr_t index)
 #endif
 
 /* Minimum size of the code gen buffer.  This number is randomly chosen,
-   but not so small that we can't have a fair number of TB's live.  */
-#define MIN_CODE_GEN_BUFFER_SIZE     (1024u * 1024)
+   but not so small that we can't have a fair number of TB's live, and
+   large enough to hold one maximal TB (TCG_MAX_OP_SIZE * OPC_BUF_SIZE).  */
+#define MIN_CODE_GEN_BUFFER_SIZE     (256u * 1024)
 
 /* Maximum size of the code gen buffer we'd like to use.  Unless otherwise
    indicated, this is constrained by the range of direct branches on the
@@ -730,6 +814,56 @@ static inline void code_gen_alloc(struct uc_struct *uc, size_t tb_size)
             g_malloc(tcg_ctx->code_gen_max_blocks * sizeof(TranslationBlock));
 }
 
+static void tb_phys_hash_alloc(TCGContext *tcg_ctx, unsigned int bits)
+{
+    tcg_ctx->tb_ctx.tb_phys_hash_bits = bits;
+    tcg_ctx->tb_ctx.tb_phys_hash = g_new0(TranslationBlock *, 1u << bits);
+}
+
+/* Double the physical TB hash once chains get long.  Starting small keeps
+   engines that translate little code from paying for a big table.  */
+static void tb_phys_hash_grow(TCGContext *tcg_ctx)
+{
+    TBContext *tb_ctx = &tcg_ctx->tb_ctx;
+    TranslationBlock **old = tb_ctx->tb_phys_hash;
+    unsigned int old_size = 1u << tb_ctx->tb_phys_hash_bits;
+    unsigned int i, h;
+
+    if (tb_ctx->tb_phys_hash_bits >= CODE_GEN_PHYS_HASH_MAX_BITS ||
+        tb_ctx->nb_tbs <= 2 * old_size) {
+        return;
+    }
+
+    tb_phys_hash_alloc(tcg_ctx, tb_ctx->tb_phys_hash_bits + 1);
+    for (i = 0; i < old_size; i++) {
+        TranslationBlock *tb, *next;
+
+        for (tb = old[i]; tb != NULL; tb = next) {
+            tb_page_addr_t phys_pc = tb->page_addr[0] +
+                                     (tb->pc & ~TARGET_PAGE_MASK);
+
+            next = tb->phys_hash_next;
+            h = tb_phys_hash_func(phys_pc, tb_ctx->tb_phys_hash_bits);
+            tb->phys_hash_next = tb_ctx->tb_phys_hash[h];
+            tb_ctx->tb_phys_hash[h] = tb;
+        }
+    }
+    g_free(old);
+}
+
+/* Host memory held by the translator of @uc: the context, generated code,
+   TB descriptors, the physical TB hash and the page descriptor map.  */
+size_t tcg_exec_memory(struct uc_struct *uc)
+{
+    TCGContext *tcg_ctx = uc->tcg_ctx;
+
+    return sizeof(TCGContext) +
+        ((char *)tcg_ctx->code_gen_ptr - (char *)tcg_ctx->code_gen_buffer) +
+        tcg_ctx->code_gen_max_blocks * sizeof(TranslationBlock) +
+        (sizeof(TranslationBlock *) << tcg_ctx->tb_ctx.tb_phys_hash_bits) +
+        uc->l1_map_size;
+}
+
 /* Must be called before using the QEMU cpus. 'tb_size' is the size
    (in bytes) allocated to the translation buffer. Zero means default
    size. */
@@ -740,6 +874,9 @@ void tcg_exec_init(struct uc_struct *uc, unsigned long tb_size)
     cpu_gen_init(uc);
     code_gen_alloc(uc, tb_size);
     tcg_ctx = uc->tcg_ctx;
+    tcg_ctx->tb_ctx.tb_phys_hash_init_bits =
+        uc->tb_hash_bits ? uc->tb_hash_bits : CODE_GEN_PHYS_HASH_BITS;
+    tb_phys_hash_alloc(tcg_ctx, tcg_ctx->tb_ctx.tb_phys_hash_init_bits);
     tcg_ctx->code_gen_ptr = tcg_ctx->code_gen_buffer;
     tcg_ctx->uc = uc;
     page_init();
@@ -748,6 +885,13 @@ void tcg_exec_init(struct uc_struct *uc, unsigned long tb_size)
        initialize the prologue now.  */
     tcg_prologue_init(tcg_ctx);
 #endif
+    /* counting TBs embed a host pointer and are never saved */
+    if (uc->tb_cache_file && !uc->tb_counts) {
+        tb_cache_open(uc, uc->tb_cache_file);
+    }
+    if (uc->perf_map) {
+        uc->perf_map = perf_map_open(uc->perf_map);
+    }
 }
 
 bool tcg_enabled(struct uc_struct *uc)
@@ -771,6 +915,8 @@ static TranslationBlock *tb_alloc(struct uc_struct *uc, target_ulong pc)
     tb = &tcg_ctx->tb_ctx.tbs[tcg_ctx->tb_ctx.nb_tbs++];
     tb->pc = pc;
     tb->cflags = 0;
+    tb->exec_count = 0;
+    tb->counter = 0;
     return tb;
 }
 
@@ -794,7 +940,6 @@ static inline void invalidate_page_bitmap(PageDesc *p)
         g_free(p->code_bitmap);
         p->code_bitmap = NULL;
     }
-    p->code_write_count = 0;
 }
 
 /* Set to NULL all the 'first_tb' fields in all PageDescs. */
@@ -841,6 +986,13 @@ void tb_flush(CPUArchState *env1)
     struct uc_struct* uc = cpu->uc;
     TCGContext *tcg_ctx = uc->tcg_ctx;
 
+    if (uc_prof_pending(uc)) {
+        uc_prof_drain(uc);
+    }
+    if (uc->tb_counts) {
+        tb_fold_counts(uc);
+    }
+
 #if defined(DEBUG_FLUSH)
     printf("qemu: flush code_size=%ld nb_tbs=%d avg_tb_size=%ld\n",
            (unsigned long)(tcg_ctx->code_gen_ptr - tcg_ctx->code_gen_buffer),
@@ -852,17 +1004,27 @@ void tb_flush(CPUArchState *env1)
         > tcg_ctx->code_gen_buffer_size) {
         cpu_abort(cpu, "Internal error: code buffer overflow\n");
     }
+    UC_PROBE2(tb_flush, tcg_ctx->tb_ctx.nb_tbs,
+              (size_t)((char *)tcg_ctx->code_gen_ptr - (char *)tcg_ctx->code_gen_buffer));
     tcg_ctx->tb_ctx.nb_tbs = 0;
 
     memset(cpu->tb_jmp_cache, 0, sizeof(cpu->tb_jmp_cache));
 
-    memset(tcg_ctx->tb_ctx.tb_phys_hash, 0, sizeof(tcg_ctx->tb_ctx.tb_phys_hash));
+    /* Drop back to the initial hash size: the TBs it grew for are gone.  */
+    if (tcg_ctx->tb_ctx.tb_phys_hash_bits != tcg_ctx->tb_ctx.tb_phys_hash_init_bits) {
+        g_free(tcg_ctx->tb_ctx.tb_phys_hash);
+        tb_phys_hash_alloc(tcg_ctx, tcg_ctx->tb_ctx.tb_phys_hash_init_bits);
+    } else {
+        memset(tcg_ctx->tb_ctx.tb_phys_hash, 0,
+               sizeof(TranslationBlock *) << tcg_ctx->tb_ctx.tb_phys_hash_bits);
+    }
     page_flush_tb(uc);
 
     tcg_ctx->code_gen_ptr = tcg_ctx->code_gen_buffer;
     /* XXX: flush processor icache at this point if cache flush is
        expensive */
     tcg_ctx->tb_ctx.tb_flush_count++;
+    env1->uc->stats.tb_flushes++;
 }
 
 #ifdef DEBUG_TB_CHECK
@@ -873,7 +1035,7 @@ static void tb_invalidate_check(target_ulong address)
     int i;
 
     address &= TARGET_PAGE_MASK;
-    for (i = 0; i < CODE_GEN_PHYS_HASH_SIZE; i++) {
+    for (i = 0; i < (1 << tcg_ctx->tb_ctx.tb_phys_hash_bits); i++) {
         for (tb = tb_ctx.tb_phys_hash[i]; tb != NULL; tb = tb->phys_hash_next) {
             if (!(address + TARGET_PAGE_SIZE <= tb->pc ||
                   address >= tb->pc + tb->size)) {
@@ -892,7 +1054,7 @@ static void tb_page_check(struct uc_struct *uc)
     int i, flags1, flags2;
     TCGContext *tcg_ctx = uc->tcg_ctx;
 
-    for (i = 0; i < CODE_GEN_PHYS_HASH_SIZE; i++) {
+    for (i = 0; i < (1 << tcg_ctx->tb_ctx.tb_phys_hash_bits); i++) {
         for (tb = tcg_ctx->tb_ctx.tb_phys_hash[i]; tb != NULL;
                 tb = tb->phys_hash_next) {
             flags1 = page_get_flags(tb->pc);
@@ -985,9 +1147,11 @@ void tb_phys_invalidate(struct uc_struct *uc,
     tb_page_addr_t phys_pc;
     TranslationBlock *tb1, *tb2;
 
+    UC_PROBE2(tb_invalidate, (uint64_t)tb->pc, tb->size);
+
     /* remove the TB from the hash list */
     phys_pc = tb->page_addr[0] + (tb->pc & ~TARGET_PAGE_MASK);
-    h = tb_phys_hash_func(phys_pc);
+    h = tb_phys_hash_func(phys_pc, tcg_ctx->tb_ctx.tb_phys_hash_bits);
     tb_hash_remove(&tcg_ctx->tb_ctx.tb_phys_hash[h], tb);
 
     /* remove the TB from the page list */
@@ -1059,9 +1223,30 @@ static inline void set_bits(uint8_t *tab, int start, int len)
     }
 }
 
+/* Mark the bytes of page @n of @tb in the code bitmap of that page.  */
+static void page_bitmap_add(PageDesc *p, TranslationBlock *tb, int n)
+{
+    int tb_start, tb_end;
+
+    /* NOTE: this is subtle as a TB may span two physical pages */
+    if (n == 0) {
+        /* NOTE: tb_end may be after the end of the page, but
+           it is not a problem */
+        tb_start = tb->pc & ~TARGET_PAGE_MASK;
+        tb_end = tb_start + tb->size;
+        if (tb_end > TARGET_PAGE_SIZE) {
+            tb_end = TARGET_PAGE_SIZE;
+        }
+    } else {
+        tb_start = 0;
+        tb_end = ((tb->pc + tb->size) & ~TARGET_PAGE_MASK);
+    }
+    set_bits(p->code_bitmap, tb_start, tb_end - tb_start);
+}
+
 static void build_page_bitmap(PageDesc *p)
 {
-    int n, tb_start, tb_end;
+    int n;
     TranslationBlock *tb;
 
     p->code_bitmap = g_malloc0(TARGET_PAGE_SIZE / 8);
@@ -1070,24 +1255,38 @@ static void build_page_bitmap(PageDesc *p)
     while (tb != NULL) {
         n = (uintptr_t)tb & 3;
         tb = (TranslationBlock *)((uintptr_t)tb & ~3);
-        /* NOTE: this is subtle as a TB may span two physical pages */
-        if (n == 0) {
-            /* NOTE: tb_end may be after the end of the page, but
-               it is not a problem */
-            tb_start = tb->pc & ~TARGET_PAGE_MASK;
-            tb_end = tb_start + tb->size;
-            if (tb_end > TARGET_PAGE_SIZE) {
-                tb_end = TARGET_PAGE_SIZE;
-            }
-        } else {
-            tb_start = 0;
-            tb_end = ((tb->pc + tb->size) & ~TARGET_PAGE_MASK);
-        }
-        set_bits(p->code_bitmap, tb_start, tb_end - tb_start);
+        page_bitmap_add(p, tb, n);
         tb = tb->page_next[n];
     }
 }
 
+/* Whether any of the @len bytes at offset @nr of the page hold code.  */
+static inline bool page_bitmap_test(PageDesc *p, unsigned int nr, int len)
+{
+    unsigned int end = nr + len;
+
+    for (; nr < end; nr++) {
+        if (p->code_bitmap[nr >> 3] & (1 << (nr & 7))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef TARGET_HAS_PRECISE_SMC
+/* Offset from the start of @tb of the code at ram address @addr, which is
+   on one of its pages.  */
+static int tb_code_offset(TranslationBlock *tb, tb_page_addr_t addr)
+{
+    int head = TARGET_PAGE_SIZE - (tb->pc & ~TARGET_PAGE_MASK);
+
+    if ((addr & TARGET_PAGE_MASK) == tb->page_addr[0]) {
+        return addr - tb->page_addr[0] - (tb->pc & ~TARGET_PAGE_MASK);
+    }
+    return head + (addr - tb->page_addr[1]);
+}
+#endif
+
 TranslationBlock *tb_gen_code(CPUState *cpu,
                               target_ulong pc, target_ulong cs_base,
                               int flags, int cflags)    // qq
@@ -1097,7 +1296,10 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
     TranslationBlock *tb;
     tb_page_addr_t phys_pc, phys_page2;
     int code_gen_size;
+    bool cached = false;
+    int64_t ti = get_clock();
 
+    UC_PROBE2(tb_translate_start, (uint64_t)pc, flags);
     phys_pc = get_page_addr_code(env, pc);
     tb = tb_alloc(env->uc, pc);
     if (!tb) {
@@ -1108,13 +1310,25 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
         /* Don't forget to invalidate previous TB info.  */
         tcg_ctx->tb_ctx.tb_invalidated_flag = 1;
     }
+    /* guest threads are preempted from any block they run */
+    if (env->uc->sched_quantum) {
+        cflags |= CF_QUANTUM;
+    }
     tb->tc_ptr = tcg_ctx->code_gen_ptr;
     tb->cs_base = cs_base;
     tb->flags = flags;
     tb->cflags = cflags;
-    cpu_gen_code(env, tb, &code_gen_size);  // qq
+    code_gen_size = 0;
+    if (tcg_ctx->tb_cache) {
+        code_gen_size = tb_cache_load(cpu->uc, tb, phys_pc);
+        cached = code_gen_size != 0;
+    }
+    if (!cached) {
+        cpu_gen_code(env, tb, &code_gen_size);  // qq
+    }
     tcg_ctx->code_gen_ptr = (void *)(((uintptr_t)tcg_ctx->code_gen_ptr +
             code_gen_size + CODE_GEN_ALIGN - 1) & ~(CODE_GEN_ALIGN - 1));
+    tb->tc_size = code_gen_size;
 
     phys_page2 = -1;
     /* check next page if needed */
@@ -1125,6 +1339,39 @@ TranslationBlock *tb_gen_code(CPUState *cpu,
         }
     }
     tb_link_page(cpu->uc, tb, phys_pc, phys_page2);
+    if (tcg_ctx->tb_cache && !cached) {
+        tb_cache_store(cpu->uc, tb, phys_pc, phys_page2, code_gen_size);
+    }
+    if (unlikely(cpu->uc->perf_map)) {
+        perf_map_add(cpu->uc->perf_map, TARGET_NAME, tb->tc_ptr,
+                     code_gen_size, tb->pc);
+    }
+    cpu->uc->stats.tb_translated++;
+    cpu->uc->stats.tb_code_bytes += code_gen_size;
+    ti = get_clock() - ti;
+    cpu->uc->stats.translate_ns += ti;
+    UC_PROBE4(tb_translate_done, (uint64_t)pc, tb->size, code_gen_size, ti);
+    return tb;
+}
+
+/* Unicorn: replace the CF_COLD @tb, which has now run tb_hot_threshold
+   times, by an optimized translation.  Unless block hooks need to see every
+   basic block, it is a superblock that continues through direct jumps.  */
+TranslationBlock *tb_gen_hot(CPUState *cpu, TranslationBlock *tb)
+{
+    struct uc_struct *uc = cpu->uc;
+    target_ulong pc = tb->pc, cs_base = tb->cs_base;
+    uint64_t flags = tb->flags;
+    int cflags = tb->cflags & ~CF_COLD;
+
+    if (!HOOK_EXISTS(uc, UC_HOOK_BLOCK)) {
+        cflags |= CF_SUPERBLOCK;
+    }
+    tb_phys_invalidate(uc, tb, -1);
+    tb = tb_gen_code(cpu, pc, cs_base, (int)flags, cflags);
+    cpu->tb_jmp_cache[tb_jmp_cache_hash_func(pc)] = tb;
+    uc->tb_hot_count++;
+
     return tb;
 }
 
@@ -1176,12 +1423,6 @@ void tb_invalidate_phys_page_range(struct uc_struct *uc, tb_page_addr_t start, t
     if (!p) {
         return;
     }
-    if (!p->code_bitmap &&
-        ++p->code_write_count >= SMC_BITMAP_USE_THRESHOLD &&
-        is_cpu_write_access) {
-        /* build code bitmap */
-        build_page_bitmap(p);
-    }
 #if defined(TARGET_HAS_PRECISE_SMC)
     if (cpu != NULL) {
         env = cpu->env_ptr;
@@ -1218,17 +1459,18 @@ void tb_invalidate_phys_page_range(struct uc_struct *uc, tb_page_addr_t start, t
             }
             if (current_tb == tb &&
                 (current_tb->cflags & CF_COUNT_MASK) != 1) {
-                /* If we are modifying the current TB, we must stop
-                its execution. We could be more precise by checking
-                that the modification is after the current PC, but it
-                would require a specialized function to partially
-                restore the CPU state */
-
-                current_tb_modified = 1;
+                /* If we are modifying the current TB, we must stop its
+                   execution, unless only code before the current
+                   instruction changes: a TB never branches backwards
+                   into itself, so that code will not run again.  */
                 // self-modifying code will restore state from TB
                 cpu_restore_state_from_tb(cpu, current_tb, cpu->mem_io_pc);
                 cpu_get_tb_cpu_state(env, &current_pc, &current_cs_base,
                                      &current_flags);
+                if (tb_code_offset(tb, end - 1) >=
+                        (int)(current_pc - tb->pc)) {
+                    current_tb_modified = 1;
+                }
             }
 #endif /* TARGET_HAS_PRECISE_SMC */
             /* we need to do that to handle the case where a signal
@@ -1355,7 +1597,9 @@ static inline void tb_alloc_page(struct uc_struct *uc, TranslationBlock *tb,
     page_already_protected = p->first_tb != NULL;
 #endif
     p->first_tb = (TranslationBlock *)((uintptr_t)tb | n);
-    invalidate_page_bitmap(p);
+    if (p->code_bitmap) {
+        page_bitmap_add(p, tb, n);
+    }
 
 #if defined(TARGET_HAS_SMC) || 1
 
@@ -1415,17 +1659,16 @@ void tb_invalidate_phys_page_fast(struct uc_struct* uc, tb_page_addr_t start, in
     if (!p) {
         return;
     }
-    if (p->code_bitmap) {
-        unsigned int nr;
-        unsigned long b;
-
-        nr = start & ~TARGET_PAGE_MASK;
-        b = p->code_bitmap[BIT_WORD(nr)] >> (nr & (BITS_PER_LONG - 1));
-        if (b & ((1 << len) - 1)) {
-            goto do_invalidate;
-        }
-    } else {
-    do_invalidate:
+    if (!p->first_tb) {
+        /* let the slow path drop the write protection of the page */
+        tb_invalidate_phys_page_range(uc, start, start + len, 1);
+        return;
+    }
+    /* data stored next to code leaves the TBs of the page alone */
+    if (!p->code_bitmap) {
+        build_page_bitmap(p);
+    }
+    if (page_bitmap_test(p, start & ~TARGET_PAGE_MASK, len)) {
         tb_invalidate_phys_page_range(uc, start, start + len, 1);
     }
 }
@@ -1443,7 +1686,8 @@ static void tb_link_page(struct uc_struct *uc,
        before we are done.  */
     mmap_lock();
     /* add in the physical hash table */
-    h = tb_phys_hash_func(phys_pc);
+    tb_phys_hash_grow(tcg_ctx);
+    h = tb_phys_hash_func(phys_pc, tcg_ctx->tb_ctx.tb_phys_hash_bits);
     ptb = &tcg_ctx->tb_ctx.tb_phys_hash[h];
     tb->phys_hash_next = *ptb;
     *ptb = tb;
@@ -25,4 +25,13 @@ void tb_check_watchpoint(CPUState *cpu);
 void tb_invalidate_phys_page_fast(struct uc_struct* uc, tb_page_addr_t start, int len);
 void tb_cleanup(struct uc_struct *uc);
 
+/* tb-cache.c */
+void tb_cache_open(struct uc_struct *uc, const char *path);
+int tb_cache_load(struct uc_struct *uc, TranslationBlock *tb,
+                  tb_page_addr_t phys_pc);
+void tb_cache_store(struct uc_struct *uc, TranslationBlock *tb,
+                    tb_page_addr_t phys_pc, tb_page_addr_t phys_page2,
+                    int code_size);
+void tb_cache_close(struct uc_struct *uc);
+
 #endif /* TRANSLATE_ALL_H */
@@ -22,6 +22,15 @@ static inline bool cpu_physical_mem_write(AddressSpace *as, hwaddr addr,
 void tb_cleanup(struct uc_struct *uc);
 void free_code_gen_buffer(struct uc_struct *uc);
 
+static void uc_tb_flush(struct uc_struct *uc)
+{
+    TCGContext *tcg_ctx = uc->tcg_ctx;
+
+    // nothing translated yet, e.g. hooks added before the first run
+    if (tcg_ctx->tb_ctx.nb_tbs)
+        tb_flush(uc->cpu->env_ptr);
+}
+
 /** Freeing common resources */
 static void release_common(void *t)
 {
@@ -72,11 +81,23 @@ static inline void uc_common_init(struct uc_struct* uc)
     uc->read_mem = cpu_physical_mem_read;
     uc->tcg_enabled = tcg_enabled;
     uc->tcg_exec_init = tcg_exec_init;
+    uc->tcg_exec_memory = tcg_exec_memory;
+    uc->translate_range = tb_translate_range;
+    uc->prof_env_pc = tb_prof_env_pc;
+    uc->prof_resolve = tb_prof_resolve;
+    uc->tb_fold_counts = tb_fold_counts;
+    uc->tb_flush = uc_tb_flush;
     uc->cpu_exec_init_all = cpu_exec_init_all;
     uc->vm_start = vm_start;
     uc->memory_map = memory_map;
     uc->memory_map_ptr = memory_map_ptr;
+    uc->memory_map_file = memory_map_file;
+    uc->memory_map_lazy = memory_map_lazy;
+    uc->memory_map_io = memory_map_io;
     uc->memory_unmap = memory_unmap;
+    uc->memory_batch_begin = memory_batch_begin;
+    uc->memory_batch_end = memory_batch_end;
+    uc->get_ram_ptr = memory_region_get_ram_ptr;
     uc->readonly_mem = memory_region_set_readonly;
 
     uc->target_page_size = TARGET_PAGE_SIZE;
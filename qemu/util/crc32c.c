@@ -27,6 +27,7 @@
 
 #include "qemu-common.h"
 #include "qemu/crc32c.h"
+#include "qemu/host-crypto.h"
 
 /*
  * This is the CRC-32C table
@@ -107,6 +108,10 @@ static const uint32_t crc32c_table[256] = {
 
 uint32_t crc32c(uint32_t crc, const uint8_t *data, unsigned int length)
 {
+    if (host_crypto_has(HOST_CRYPTO_CRC32C)) {
+        return host_crc32c_buf(crc, data, length) ^ 0xffffffff;
+    }
+
     while (length--) {
         crc = crc32c_table[(crc ^ *data++) & 0xFFL] ^ (crc >> 8);
     }
@@ -0,0 +1,211 @@
+/*
+ * Host CPU acceleration for guest crypto instructions
+ *
+ * The guest AES, carry-less multiply and CRC32C helpers are written in
+ * terms of byte tables (util/aes.c, util/crc32c.c).  When the host has
+ * AES-NI, PCLMULQDQ or SSE4.2 we can run each guest instruction as one
+ * host instruction instead.  Detection happens at runtime; the helpers
+ * fall back to the tables when a feature is missing.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/host-crypto.h"
+
+#ifdef CONFIG_HOST_CRYPTO
+
+#include <cpuid.h>
+#include <wmmintrin.h>  /* AES-NI, PCLMULQDQ */
+#include <smmintrin.h>  /* SSE4.1 */
+#include <nmmintrin.h>  /* SSE4.2 CRC32 */
+
+#ifndef bit_AES
+#define bit_AES     (1 << 25)
+#endif
+#ifndef bit_PCLMUL
+#define bit_PCLMUL  (1 << 1)
+#endif
+#ifndef bit_SSE4_2
+#define bit_SSE4_2  (1 << 20)
+#endif
+
+unsigned int host_crypto_flags;
+
+void host_crypto_probe(void)
+{
+    unsigned int a, b, c, d;
+    unsigned int flags = HOST_CRYPTO_PROBED;
+
+    if (__get_cpuid_max(0, 0) >= 1) {
+        __cpuid(1, a, b, c, d);
+        if (c & bit_AES) {
+            flags |= HOST_CRYPTO_AES;
+        }
+        if (c & bit_PCLMUL) {
+            flags |= HOST_CRYPTO_CLMUL;
+        }
+        if (c & bit_SSE4_2) {
+            flags |= HOST_CRYPTO_CRC32C;
+        }
+    }
+
+    /* Every caller computes the same value, so racing here is harmless. */
+    host_crypto_flags = flags;
+}
+
+#define AES_FN   __attribute__((target("aes,sse2")))
+#define CLMUL_FN __attribute__((target("pclmul,sse2")))
+#define CRC_FN   __attribute__((target("sse4.2")))
+
+AES_FN void host_aes_enc(void *d, const void *st, const void *rk)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    __m128i k = _mm_loadu_si128((const __m128i *)rk);
+    _mm_storeu_si128((__m128i *)d, _mm_aesenc_si128(v, k));
+}
+
+AES_FN void host_aes_dec(void *d, const void *st, const void *rk)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    __m128i k = _mm_loadu_si128((const __m128i *)rk);
+    _mm_storeu_si128((__m128i *)d, _mm_aesdec_si128(v, k));
+}
+
+AES_FN void host_aes_enclast(void *d, const void *st, const void *rk)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    __m128i k = _mm_loadu_si128((const __m128i *)rk);
+    _mm_storeu_si128((__m128i *)d, _mm_aesenclast_si128(v, k));
+}
+
+AES_FN void host_aes_declast(void *d, const void *st, const void *rk)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    __m128i k = _mm_loadu_si128((const __m128i *)rk);
+    _mm_storeu_si128((__m128i *)d, _mm_aesdeclast_si128(v, k));
+}
+
+AES_FN void host_aes_mc(void *d, const void *st)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    __m128i zero = _mm_setzero_si128();
+
+    /* AESDECLAST undoes ShiftRows+SubBytes, AESENC redoes them and then
+       applies MixColumns, leaving MixColumns alone.  */
+    v = _mm_aesdeclast_si128(v, zero);
+    _mm_storeu_si128((__m128i *)d, _mm_aesenc_si128(v, zero));
+}
+
+AES_FN void host_aes_imc(void *d, const void *st)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)st);
+    _mm_storeu_si128((__m128i *)d, _mm_aesimc_si128(v));
+}
+
+CLMUL_FN void host_clmul(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+    uint64_t r[2];
+    __m128i va = _mm_set_epi64x(0, (int64_t)a);
+    __m128i vb = _mm_set_epi64x(0, (int64_t)b);
+
+    _mm_storeu_si128((__m128i *)r, _mm_clmulepi64_si128(va, vb, 0x00));
+    *lo = r[0];
+    *hi = r[1];
+}
+
+CRC_FN uint32_t host_crc32c_le(uint32_t crc, uint64_t val, unsigned int bytes)
+{
+    switch (bytes) {
+    case 1:
+        return _mm_crc32_u8(crc, (uint8_t)val);
+    case 2:
+        return _mm_crc32_u16(crc, (uint16_t)val);
+    case 4:
+        return _mm_crc32_u32(crc, (uint32_t)val);
+    default:
+#ifdef __x86_64__
+        return (uint32_t)_mm_crc32_u64(crc, val);
+#else
+        crc = _mm_crc32_u32(crc, (uint32_t)val);
+        return _mm_crc32_u32(crc, (uint32_t)(val >> 32));
+#endif
+    }
+}
+
+CRC_FN uint32_t host_crc32c_buf(uint32_t crc, const uint8_t *data,
+                                unsigned int length)
+{
+#ifdef __x86_64__
+    while (length >= 8) {
+        uint64_t v;
+        memcpy(&v, data, 8);
+        crc = (uint32_t)_mm_crc32_u64(crc, v);
+        data += 8;
+        length -= 8;
+    }
+#endif
+    while (length >= 4) {
+        uint32_t v;
+        memcpy(&v, data, 4);
+        crc = _mm_crc32_u32(crc, v);
+        data += 4;
+        length -= 4;
+    }
+    while (length--) {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+
+#else /* !CONFIG_HOST_CRYPTO */
+
+/* Never reached: host_crypto_has() is constant false on these hosts.  */
+
+void host_aes_enc(void *d, const void *st, const void *rk)
+{
+    abort();
+}
+
+void host_aes_dec(void *d, const void *st, const void *rk)
+{
+    abort();
+}
+
+void host_aes_enclast(void *d, const void *st, const void *rk)
+{
+    abort();
+}
+
+void host_aes_declast(void *d, const void *st, const void *rk)
+{
+    abort();
+}
+
+void host_aes_mc(void *d, const void *st)
+{
+    abort();
+}
+
+void host_aes_imc(void *d, const void *st)
+{
+    abort();
+}
+
+void host_clmul(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi)
+{
+    abort();
+}
+
+uint32_t host_crc32c_le(uint32_t crc, uint64_t val, unsigned int bytes)
+{
+    abort();
+}
+
+uint32_t host_crc32c_buf(uint32_t crc, const uint8_t *data,
+                         unsigned int length)
+{
+    abort();
+}
+
+#endif /* CONFIG_HOST_CRYPTO */
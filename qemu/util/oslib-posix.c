@@ -139,3 +139,81 @@ void qemu_anon_ram_free(void *ptr, size_t size)
         munmap(ptr, size);
     }
 }
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+/* Reserve @size bytes of address space without committing memory, so
+   this does not depend on the host allowing overcommit.  Pages become
+   usable with qemu_anon_ram_commit(); free with qemu_anon_ram_free().  */
+void *qemu_anon_ram_reserve(size_t size)
+{
+    void *ptr = mmap(0, size, PROT_NONE,
+                     MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
+
+/* Commit the host pages covering [@ptr, @ptr + @size) of a reservation,
+   zero-filled and read/write.  */
+bool qemu_anon_ram_commit(void *ptr, size_t size)
+{
+    uintptr_t mask = getpagesize() - 1;
+    uintptr_t start = (uintptr_t)ptr & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + size + mask) & ~mask;
+
+    return mprotect((void *)start, end - start, PROT_READ | PROT_WRITE) == 0;
+}
+
+/* Map @size bytes of @fd from @offset copy-on-write.  Whatever lies past
+   the end of the file reads as zeroes instead of raising SIGBUS.  */
+void *qemu_file_ram_alloc(int fd, uint64_t offset, size_t size)
+{
+    struct stat st;
+    size_t file_size = 0;
+    void *ptr;
+
+    if (offset & (qemu_file_ram_align() - 1)) {
+        return NULL;
+    }
+    if (fstat(fd, &st) < 0) {
+        return NULL;
+    }
+    if ((uint64_t)st.st_size > offset) {
+        file_size = (size_t)MIN((uint64_t)size, st.st_size - offset);
+    }
+
+    if (file_size == size) {
+        ptr = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset);
+        return ptr == MAP_FAILED ? NULL : ptr;
+    }
+
+    ptr = mmap(0, size, PROT_READ | PROT_WRITE,
+               MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    if (file_size > 0 &&
+        mmap(ptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+             fd, offset) == MAP_FAILED) {
+        munmap(ptr, size);
+        return NULL;
+    }
+
+    return ptr;
+}
+
+void qemu_file_ram_free(void *ptr, size_t size)
+{
+    if (ptr) {
+        munmap(ptr, size);
+    }
+}
+
+/* Alignment qemu_file_ram_alloc() needs for the file offset: the host page
+   size, which is 16KB or 64KB on some arm64 and ppc64 hosts.  */
+size_t qemu_file_ram_align(void)
+{
+    return getpagesize();
+}
@@ -94,6 +94,64 @@ void qemu_anon_ram_free(void *ptr, size_t size)
     }
 }
 
+/* Reserve @size bytes of address space without committing memory.  Pages
+   become usable with qemu_anon_ram_commit(); free with
+   qemu_anon_ram_free().  */
+void *qemu_anon_ram_reserve(size_t size)
+{
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+/* Commit the host pages covering [@ptr, @ptr + @size) of a reservation,
+   zero-filled and read/write.  */
+bool qemu_anon_ram_commit(void *ptr, size_t size)
+{
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+/* Map @size bytes of @fd from @offset copy-on-write.  Unlike POSIX mmap,
+   the view must lie within the file and @offset must be a multiple of the
+   allocation granularity (64KB).  */
+void *qemu_file_ram_alloc(int fd, uint64_t offset, size_t size)
+{
+    HANDLE file = (HANDLE)_get_osfhandle(fd);
+    HANDLE mapping;
+    void *ptr;
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    mapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return NULL;
+    }
+
+    ptr = MapViewOfFile(mapping, FILE_MAP_COPY, (DWORD)(offset >> 32),
+                        (DWORD)offset, size);
+    /* the view keeps the mapping object alive */
+    CloseHandle(mapping);
+
+    return ptr;
+}
+
+void qemu_file_ram_free(void *ptr, size_t size)
+{
+    if (ptr) {
+        UnmapViewOfFile(ptr);
+    }
+}
+
+/* Alignment qemu_file_ram_alloc() needs for the file offset: the allocation
+   granularity, not the page size.  */
+size_t qemu_file_ram_align(void)
+{
+    SYSTEM_INFO system_info;
+
+    GetSystemInfo(&system_info);
+    return system_info.dwAllocationGranularity;
+}
+
 size_t getpagesize(void)
 {
     SYSTEM_INFO system_info;
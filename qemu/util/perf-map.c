@@ -0,0 +1,236 @@
+/*
+ * Symbols for translated code in Linux perf
+ *
+ * Translated blocks live in the anonymous code_gen_buffer, so profilers
+ * see their samples without a symbol.  perf looks up such addresses in
+ * /tmp/perf-<pid>.map, one "start size name" line per symbol.  The jitdump
+ * format additionally carries the host code and a timestamp for every
+ * block, so "perf inject --jit" can tell apart blocks that reused the same
+ * buffer after a flush and "perf annotate" can disassemble them.  It is
+ * found through a PROT_EXEC mapping of the dump file, which "perf record
+ * -k mono" sees as an mmap event.
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2 or later.
+ * See the COPYING file in the top-level directory.
+ */
+
+#include "qemu/perf-map.h"
+
+#ifdef __linux__
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define JITDUMP_MAGIC       0x4A695444  /* "JiTD" */
+#define JITDUMP_VERSION     1
+#define JIT_CODE_LOAD       0
+
+/* ELF e_machine of the host; qemu's include/elf.h hides the system one */
+#if defined(__x86_64__)
+#define JITDUMP_ELF_MACH    62      /* EM_X86_64 */
+#elif defined(__i386__)
+#define JITDUMP_ELF_MACH    3       /* EM_386 */
+#elif defined(__aarch64__)
+#define JITDUMP_ELF_MACH    183     /* EM_AARCH64 */
+#elif defined(__arm__)
+#define JITDUMP_ELF_MACH    40      /* EM_ARM */
+#elif defined(__mips__)
+#define JITDUMP_ELF_MACH    8       /* EM_MIPS */
+#elif defined(__powerpc64__)
+#define JITDUMP_ELF_MACH    21      /* EM_PPC64 */
+#elif defined(__s390x__)
+#define JITDUMP_ELF_MACH    22      /* EM_S390 */
+#else
+#define JITDUMP_ELF_MACH    0       /* EM_NONE */
+#endif
+
+struct jitdump_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+
+struct jitdump_code_load {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+    /* followed by the NUL-terminated name and the code */
+};
+
+static struct {
+    pthread_mutex_t lock;
+    unsigned int users[2];  /* engines using each output */
+    bool created[2];        /* each output was started by this process */
+    FILE *map;
+    FILE *dump;
+    void *marker;           /* the PROT_EXEC mapping perf looks for */
+    size_t marker_size;
+    uint64_t code_index;
+} perf_map = { PTHREAD_MUTEX_INITIALIZER };
+
+/* same clock as "perf record -k mono" */
+static uint64_t perf_map_timestamp(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* The first open in the process truncates what an earlier process with
+   the same pid left behind.  Later ones append: perf still needs the
+   entries of engines that were closed in the meantime.  */
+static FILE *jitdump_open(void)
+{
+    struct jitdump_header header;
+    const char *dir = getenv("JITDUMPDIR");
+    char path[PATH_MAX];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/jit-%d.dump", dir ? dir : "/tmp",
+             (int)getpid());
+    f = fopen(path, perf_map.created[1] ? "a+" : "w+");
+    if (!f) {
+        return NULL;
+    }
+
+    perf_map.marker_size = sysconf(_SC_PAGESIZE);
+    perf_map.marker = mmap(NULL, perf_map.marker_size, PROT_READ | PROT_EXEC,
+                           MAP_PRIVATE, fileno(f), 0);
+    if (perf_map.marker == MAP_FAILED) {
+        perf_map.marker = NULL;
+        fclose(f);
+        return NULL;
+    }
+    if (perf_map.created[1]) {
+        return f;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = JITDUMP_MAGIC;
+    header.version = JITDUMP_VERSION;
+    header.total_size = sizeof(header);
+    header.elf_mach = JITDUMP_ELF_MACH;
+    header.pid = getpid();
+    header.timestamp = perf_map_timestamp();
+    fwrite(&header, sizeof(header), 1, f);
+    fflush(f);
+    perf_map.created[1] = true;
+
+    return f;
+}
+
+unsigned int perf_map_open(unsigned int outputs)
+{
+    unsigned int opened = 0;
+    char path[64];
+
+    pthread_mutex_lock(&perf_map.lock);
+    if (outputs & PERF_MAP_SYMBOLS) {
+        if (!perf_map.map) {
+            snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+            perf_map.map = fopen(path, perf_map.created[0] ? "a" : "w");
+        }
+        if (perf_map.map) {
+            perf_map.created[0] = true;
+            perf_map.users[0]++;
+            opened |= PERF_MAP_SYMBOLS;
+        }
+    }
+    if (outputs & PERF_MAP_JITDUMP) {
+        if (!perf_map.dump) {
+            perf_map.dump = jitdump_open();
+        }
+        if (perf_map.dump) {
+            perf_map.users[1]++;
+            opened |= PERF_MAP_JITDUMP;
+        }
+    }
+    pthread_mutex_unlock(&perf_map.lock);
+
+    return opened;
+}
+
+void perf_map_close(unsigned int outputs)
+{
+    pthread_mutex_lock(&perf_map.lock);
+    if ((outputs & PERF_MAP_SYMBOLS) && --perf_map.users[0] == 0) {
+        fclose(perf_map.map);
+        perf_map.map = NULL;
+    }
+    if ((outputs & PERF_MAP_JITDUMP) && --perf_map.users[1] == 0) {
+        munmap(perf_map.marker, perf_map.marker_size);
+        perf_map.marker = NULL;
+        fclose(perf_map.dump);
+        perf_map.dump = NULL;
+    }
+    pthread_mutex_unlock(&perf_map.lock);
+}
+
+void perf_map_add(unsigned int outputs, const char *arch,
+                  const void *code, size_t size, uint64_t pc)
+{
+    struct jitdump_code_load rec;
+    char name[64];
+    int len;
+
+    len = snprintf(name, sizeof(name), "guest:%s:0x%" PRIx64, arch, pc);
+
+    pthread_mutex_lock(&perf_map.lock);
+    if (outputs & PERF_MAP_SYMBOLS) {
+        fprintf(perf_map.map, "%" PRIxPTR " %zx %s\n",
+                (uintptr_t)code, size, name);
+        fflush(perf_map.map);
+    }
+    if (outputs & PERF_MAP_JITDUMP) {
+        rec.id = JIT_CODE_LOAD;
+        rec.total_size = sizeof(rec) + len + 1 + size;
+        rec.timestamp = perf_map_timestamp();
+        rec.pid = getpid();
+        rec.tid = syscall(SYS_gettid);
+        rec.vma = (uintptr_t)code;
+        rec.code_addr = (uintptr_t)code;
+        rec.code_size = size;
+        rec.code_index = perf_map.code_index++;
+        fwrite(&rec, sizeof(rec), 1, perf_map.dump);
+        fwrite(name, len + 1, 1, perf_map.dump);
+        fwrite(code, size, 1, perf_map.dump);
+        fflush(perf_map.dump);
+    }
+    pthread_mutex_unlock(&perf_map.lock);
+}
+
+#else
+
+unsigned int perf_map_open(unsigned int outputs)
+{
+    return 0;
+}
+
+void perf_map_close(unsigned int outputs)
+{
+}
+
+void perf_map_add(unsigned int outputs, const char *arch,
+                  const void *code, size_t size, uint64_t pc)
+{
+}
+
+#endif
@@ -12,14 +12,28 @@
 #define tb_invalidate_phys_page_fast tb_invalidate_phys_page_fast_x86_64
 #define phys_mem_clean phys_mem_clean_x86_64
 #define tb_cleanup tb_cleanup_x86_64
+#define tb_cache_open tb_cache_open_x86_64
+#define tb_cache_load tb_cache_load_x86_64
+#define tb_cache_store tb_cache_store_x86_64
+#define tb_cache_close tb_cache_close_x86_64
 #define memory_map memory_map_x86_64
 #define memory_map_ptr memory_map_ptr_x86_64
+#define memory_map_file memory_map_file_x86_64
+#define memory_map_lazy memory_map_lazy_x86_64
+#define memory_map_io memory_map_io_x86_64
 #define memory_unmap memory_unmap_x86_64
+#define memory_batch_begin memory_batch_begin_x86_64
+#define memory_batch_end memory_batch_end_x86_64
 #define memory_free memory_free_x86_64
 #define free_code_gen_buffer free_code_gen_buffer_x86_64
 #define helper_raise_exception helper_raise_exception_x86_64
 #define tcg_enabled tcg_enabled_x86_64
 #define tcg_exec_init tcg_exec_init_x86_64
+#define tcg_exec_memory tcg_exec_memory_x86_64
+#define tb_translate_range tb_translate_range_x86_64
+#define tb_prof_env_pc tb_prof_env_pc_x86_64
+#define tb_prof_resolve tb_prof_resolve_x86_64
+#define tb_fold_counts tb_fold_counts_x86_64
 #define memory_register_types memory_register_types_x86_64
 #define cpu_exec_init_all cpu_exec_init_all_x86_64
 #define vm_start vm_start_x86_64
@@ -2042,6 +2056,7 @@
 #define memory_region_init_io memory_region_init_io_x86_64
 #define memory_region_init_ram memory_region_init_ram_x86_64
 #define memory_region_init_ram_ptr memory_region_init_ram_ptr_x86_64
+#define memory_region_init_ram_file memory_region_init_ram_file_x86_64
 #define memory_region_init_reservation memory_region_init_reservation_x86_64
 #define memory_region_is_iommu memory_region_is_iommu_x86_64
 #define memory_region_is_logging memory_region_is_logging_x86_64
@@ -2365,8 +2380,6 @@
 #define qdict_size qdict_size_x86_64
 #define qdict_type qdict_type_x86_64
 #define qemu_clock_get_us qemu_clock_get_us_x86_64
-#define qemu_clock_ptr qemu_clock_ptr_x86_64
-#define qemu_clocks qemu_clocks_x86_64
 #define qemu_get_cpu qemu_get_cpu_x86_64
 #define qemu_get_guest_memory_mapping qemu_get_guest_memory_mapping_x86_64
 #define qemu_get_guest_simple_memory_mapping qemu_get_guest_simple_memory_mapping_x86_64
@@ -2374,6 +2387,7 @@
 #define qemu_get_ram_block_host_ptr qemu_get_ram_block_host_ptr_x86_64
 #define qemu_get_ram_fd qemu_get_ram_fd_x86_64
 #define qemu_get_ram_ptr qemu_get_ram_ptr_x86_64
+#define qemu_ram_populate qemu_ram_populate_x86_64
 #define qemu_host_page_mask qemu_host_page_mask_x86_64
 #define qemu_host_page_size qemu_host_page_size_x86_64
 #define qemu_init_vcpu qemu_init_vcpu_x86_64
@@ -2389,6 +2403,7 @@
 #define qemu_ram_addr_from_host_nofail qemu_ram_addr_from_host_nofail_x86_64
 #define qemu_ram_alloc qemu_ram_alloc_x86_64
 #define qemu_ram_alloc_from_ptr qemu_ram_alloc_from_ptr_x86_64
+#define qemu_ram_alloc_from_file qemu_ram_alloc_from_file_x86_64
 #define qemu_ram_foreach_block qemu_ram_foreach_block_x86_64
 #define qemu_ram_free qemu_ram_free_x86_64
 #define qemu_ram_free_from_ptr qemu_ram_free_from_ptr_x86_64
@@ -2652,6 +2667,7 @@
 #define tb_flush_jmp_cache tb_flush_jmp_cache_x86_64
 #define tb_free tb_free_x86_64
 #define tb_gen_code tb_gen_code_x86_64
+#define tb_gen_hot tb_gen_hot_x86_64
 #define tb_hash_remove tb_hash_remove_x86_64
 #define tb_invalidate_phys_addr tb_invalidate_phys_addr_x86_64
 #define tb_invalidate_phys_page_range tb_invalidate_phys_page_range_x86_64
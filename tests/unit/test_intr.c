@@ -0,0 +1,65 @@
+/**
+ * Unicorn interrupt hook tests
+ *
+ * This tests interrupts handled inline by UC_HOOK_INTR callbacks.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static void hook_intr_count(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    int *calls = user_data;
+    uint32_t eax;
+
+    assert_int_equal(0x80, intno);
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    eax++;
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    if (++*calls == 0)
+        uc_assert_success(uc_emu_stop(uc));
+}
+
+static void test_intr_inline(void **state)
+{
+    // L: int 0x80; dec ecx; jnz L
+    const char code[] = "\xcd\x80\x49\x75\xfb";
+    uint32_t eax = 0, ecx = 100, eip;
+    int calls = 0;
+    uc_hook hh;
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_INTR, hook_intr_count, &calls, 1, 0));
+
+    // hooks see and change registers, and the loop goes on after each trap
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_ECX, &ecx));
+    assert_int_equal(100, calls);
+    assert_int_equal(100, eax);
+    assert_int_equal(0, ecx);
+
+    // a hook stopping emulation leaves EIP after the trap
+    calls = -1;
+    ecx = 100;
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EIP, &eip));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_ECX, &ecx));
+    assert_int_equal(0x1002, eip);
+    assert_int_equal(100, ecx);
+
+    uc_assert_success(uc_close(uc));
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_intr_inline),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
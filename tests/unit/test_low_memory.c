@@ -0,0 +1,76 @@
+/**
+ * Unicorn low memory tests
+ *
+ * This tests engines opened with UC_OPT_LOW_MEMORY.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static void test_low_memory(void **state)
+{
+    uc_engine *uc = *state, *small;
+    uc_open_opts opts = { 0, 0, UC_OPT_LOW_MEMORY };
+    size_t mem, small_mem;
+    // 2000 blocks of "inc eax; jmp $+2", enough to grow the TB hash
+    char code[2000 * 3];
+    uint32_t eax = 0;
+    int i;
+
+    for (i = 0; i < 2000; i++)
+        memcpy(code + i * 3, "\x40\xeb\x00", 3);
+
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &small));
+    uc_assert_success(uc_query(uc, UC_QUERY_MEMORY, &mem));
+    uc_assert_success(uc_query(small, UC_QUERY_MEMORY, &small_mem));
+    assert_true(small_mem < mem);
+
+    uc_assert_success(uc_mem_map(small, 0x1000, 0x2000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(small, 0x1000, code, sizeof(code)));
+    uc_assert_success(uc_reg_write(small, UC_X86_REG_EAX, &eax));
+    // the second run reuses the blocks found through the grown hash
+    for (i = 0; i < 2; i++) {
+        uc_assert_success(uc_emu_start(small, 0x1000, 0x1000 + sizeof(code), 0, 0));
+    }
+    uc_assert_success(uc_reg_read(small, UC_X86_REG_EAX, &eax));
+    assert_int_equal(4000, eax);
+    uc_assert_success(uc_query(small, UC_QUERY_MEMORY, &mem));
+    assert_true(mem > small_mem + 0x2000);
+    uc_assert_success(uc_close(small));
+
+    opts.tb_hash_bits = 30;
+    assert_int_equal(UC_ERR_ARG, uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &small));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_low_memory),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
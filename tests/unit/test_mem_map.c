@@ -0,0 +1,402 @@
+/**
+ * Unicorn memory API tests
+ *
+ * This tests memory read/write and map/unmap functionality.
+ * One is necessary for doing the other.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+
+/**
+ * A basic test showing mapping of memory, and reading/writing it
+ */
+static void test_basic(void **state)
+{
+    uc_engine *uc = *state;
+    const uint64_t mem_start = 0x1000;
+    const uint64_t mem_len   = 0x1000;
+    const uint64_t test_addr = mem_start + 0x100;
+
+    /* Map a region */
+    uc_assert_success(uc_mem_map(uc, mem_start, mem_len, UC_PROT_NONE));
+
+    /* Write some data to it */
+    uc_assert_success(uc_mem_write(uc, test_addr, "test", 4));
+
+    uint8_t buf[4];
+    memset(buf, 0xCC, sizeof(buf));
+
+    /* Read it back */
+    uc_assert_success(uc_mem_read(uc, test_addr, buf, sizeof(buf)));
+
+    /* And make sure it matches what we expect */
+    assert_memory_equal(buf, "test", 4);
+
+    /* Unmap the region */
+    //uc_assert_success(uc_mem_unmap(uc, mem_start, mem_len));
+}
+
+static void test_bad_read(void **state)
+{
+    uc_engine *uc = *state;
+
+    uint8_t readbuf[0x10];
+    memset(readbuf, 0xCC, sizeof(readbuf));
+
+    uint8_t checkbuf[0x10];
+    memset(checkbuf, 0xCC, sizeof(checkbuf));
+
+    /* Reads to unmapped addresses should fail */
+    /* TODO: Which error? */
+    uc_assert_fail(uc_mem_read(uc, 0x1000, readbuf, sizeof(readbuf)));
+
+    /* And our buffer should be unchanged */
+    assert_memory_equal(readbuf, checkbuf, sizeof(checkbuf));
+}
+
+static void test_bad_write(void **state)
+{
+    uc_engine *uc = *state;
+
+    uint8_t writebuf[0x10];
+    memset(writebuf, 0xCC, sizeof(writebuf));
+
+    /* Writes to unmapped addresses should fail */
+    /* TODO: Which error? */
+    uc_assert_fail(uc_mem_write(uc, 0x1000, writebuf, sizeof(writebuf)));
+}
+
+
+
+/**
+ * Verify that we can read/write across memory map region boundaries
+ */
+static void test_rw_across_boundaries(void **state)
+{
+    uc_engine *uc = *state;
+
+    /* Map in two adjacent regions */
+    uc_assert_success(uc_mem_map(uc, 0,      0x1000, 0));   /* 0x0000 - 0x1000 */
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, 0));   /* 0x1000 - 0x2000 */
+
+    const uint64_t addr = 0x1000 - 2;                       /* 2 bytes before end of block */
+
+    /* Write some data across the boundary */
+    uc_assert_success(uc_mem_write(uc, addr, "test", 4));
+
+    uint8_t buf[4];
+    memset(buf, 0xCC, sizeof(buf));
+
+    /* Read the data across the boundary */
+    uc_assert_success(uc_mem_read(uc, addr, buf, sizeof(buf)));
+
+    assert_memory_equal(buf, "test", 4);
+}
+
+/* Try to unmap memory that has not been mapped */
+static void test_bad_unmap(void **state)
+{
+    uc_engine *uc = *state;
+
+    /* TODO: Which error should this return? */
+    uc_assert_fail(uc_mem_unmap(uc, 0x0, 0x1000));
+}
+
+
+/* Try to map overlapped memory range */
+static void test_unmap_double_map(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_mem_map(uc, 0,      0x4000, 0));   /* 0x0000 - 0x4000 */
+    uc_assert_fail(uc_mem_map(uc, 0x0000, 0x1000, 0));   /* 0x1000 - 0x1000 */
+}
+
+static void test_overlap_unmap_double_map(void **state)
+{
+    uc_engine *uc = *state;
+    uc_mem_map(  uc, 0x1000, 0x2000, 0);
+    uc_mem_map(  uc, 0x1000, 0x1000, 0);
+    uc_mem_unmap(uc, 0x2000, 0x1000);
+}
+
+static void test_strange_map(void **state)
+{
+    uc_engine *uc = *state;
+    uc_mem_map(  uc, 0x0,0x3000,0); 
+    uc_mem_unmap(uc, 0x1000,0x1000); 
+    uc_mem_map(  uc, 0x3000,0x1000,0); 
+    uc_mem_map(  uc, 0x4000,0x1000,0); 
+    uc_mem_map(  uc, 0x1000,0x1000,0); 
+    uc_mem_map(  uc, 0x5000,0x1000,0); 
+    uc_mem_unmap(uc, 0x0,0x1000); 
+}
+
+static void test_query_page_size(void **state)
+{
+    uc_engine *uc = *state;
+
+    size_t page_size;
+    uc_assert_success(uc_query(uc, UC_QUERY_PAGE_SIZE, &page_size));
+    assert_int_equal(4096, page_size);
+}
+
+void mem_write(uc_engine* uc, uint64_t addr, uint64_t len){
+  uint8_t* buff = alloca(len);
+  memset(buff,0,len);
+  uc_mem_write(uc, addr, buff, len);
+
+}
+
+void mem_read(uc_engine* uc, uint64_t addr, uint64_t len){
+  uint8_t* buff = alloca(len);
+  uc_mem_read(uc, addr, buff, len);
+}
+
+void map(uc_engine* uc, uint64_t addr, uint64_t len){
+    uc_mem_map(uc, addr, len, UC_PROT_READ | UC_PROT_WRITE);
+}
+
+void unmap(uc_engine* uc, uint64_t addr, uint64_t len){
+    uc_mem_unmap(uc, addr, len);
+}
+
+//most likely same bug as in test_strange_map, but looked different in fuzzer (sefault instead of assertion fail)
+static void test_assertion_fail(void **state){
+  uc_engine *uc = *state;
+
+  map(uc,0x2000,0x4000); //5
+  unmap(uc,0x3000,0x2000); //11
+  map(uc,0x0,0x2000); //23
+  map(uc,0x3000,0x2000); //24
+  map(uc,0x9000,0x4000); //32
+  map(uc,0x8000,0x1000); //34
+  unmap(uc,0x1000,0x4000); //35
+}
+
+static void test_bad_offset(void **state){
+  uc_engine *uc = *state;
+  map(uc,0x9000,0x4000); //17
+  map(uc,0x4000,0x2000); //32
+  unmap(uc,0x5000,0x1000); //35
+  map(uc,0x0,0x1000); //42
+  map(uc,0x5000,0x4000); //51
+  map(uc,0x2000,0x1000); //53
+  map(uc,0x1000,0x1000); //55
+  unmap(uc,0x7000,0x3000); //58
+  unmap(uc,0x5000,0x1000); //59
+  unmap(uc,0x4000,0x2000); //70
+}
+
+
+struct mmio_log {
+    uint64_t read_offset;
+    uint64_t write_offset;
+    uint64_t write_value;
+    unsigned write_size;
+};
+
+static uint64_t mmio_read(uc_engine *uc, uint64_t offset, unsigned size, void *user_data)
+{
+    struct mmio_log *log = user_data;
+    log->read_offset = offset;
+    return 0x12345678;
+}
+
+static void mmio_write(uc_engine *uc, uint64_t offset, unsigned size, uint64_t value, void *user_data)
+{
+    struct mmio_log *log = user_data;
+    log->write_offset = offset;
+    log->write_size = size;
+    log->write_value = value;
+}
+
+static void test_mmio(void **state)
+{
+    uc_engine *uc = *state;
+    struct mmio_log log = { 0 };
+    // mov eax, [0x2004]; mov [0x2008], ecx
+    const char code[] = "\xa1\x04\x20\x00\x00\x89\x0d\x08\x20\x00\x00";
+    uint32_t eax = 0, ecx = 0xcafebabe;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mmio_map(uc, 0x2000, 0x2000, mmio_read, mmio_write, &log));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(0x12345678, eax);
+    assert_int_equal(4, log.read_offset);
+    assert_int_equal(8, log.write_offset);
+    assert_int_equal(4, log.write_size);
+    assert_int_equal(0xcafebabe, log.write_value);
+
+    // no callbacks, overlap, partial unmap and protect are refused
+    assert_int_equal(UC_ERR_ARG, uc_mmio_map(uc, 0x8000, 0x1000, NULL, NULL, NULL));
+    assert_int_equal(UC_ERR_MAP, uc_mmio_map(uc, 0x1000, 0x1000, mmio_read, NULL, NULL));
+    assert_int_equal(UC_ERR_ARG, uc_mem_protect(uc, 0x2000, 0x1000, UC_PROT_READ));
+    assert_int_equal(UC_ERR_ARG, uc_mem_unmap(uc, 0x3000, 0x1000));
+    uc_assert_success(uc_mem_unmap(uc, 0x2000, 0x2000));
+}
+
+static void test_map_batch(void **state)
+{
+    uc_engine *uc = *state;
+    uc_mem_region *regions;
+    uint32_t count;
+    size_t done;
+    uint8_t buf[4];
+    const uc_mem_op ops[] = {
+        { UC_MEM_OP_MAP, 0x1000, 0x3000, UC_PROT_ALL, NULL },
+        { UC_MEM_OP_MAP, 0x8000, 0x1000, UC_PROT_READ, NULL },
+        { UC_MEM_OP_PROTECT, 0x2000, 0x1000, UC_PROT_READ, NULL },
+        { UC_MEM_OP_UNMAP, 0x3000, 0x1000, 0, NULL },
+    };
+    const uc_mem_op bad[] = {
+        { UC_MEM_OP_MAP, 0x10000, 0x1000, UC_PROT_ALL, NULL },
+        { UC_MEM_OP_MAP, 0x10000, 0x1000, UC_PROT_ALL, NULL },
+    };
+
+    uc_assert_success(uc_mem_map_batch(uc, ops, 2, &done));
+    assert_int_equal(2, done);
+    uc_assert_success(uc_mem_write(uc, 0x2000, "test", 4));
+
+    // splitting inside a batch keeps the contents
+    uc_assert_success(uc_mem_map_batch(uc, ops + 2, 2, &done));
+    assert_int_equal(2, done);
+    uc_assert_success(uc_mem_read(uc, 0x2000, buf, 4));
+    assert_memory_equal(buf, "test", 4);
+
+    uc_assert_success(uc_mem_regions(uc, &regions, &count));
+    assert_int_equal(3, count);
+    uc_free(regions);
+
+    // stops at the first failure, earlier operations stay applied
+    assert_int_equal(UC_ERR_MAP, uc_mem_map_batch(uc, bad, 2, &done));
+    assert_int_equal(1, done);
+    uc_assert_success(uc_mem_write(uc, 0x10000, "test", 4));
+}
+
+static void test_map_file(void **state)
+{
+    uc_engine *uc = *state;
+    FILE *f = tmpfile();
+    uint8_t buf[4];
+
+    assert_non_null(f);
+    fwrite("file", 1, 4, f);
+    fflush(f);
+
+    uc_assert_success(uc_mem_map_file(uc, 0x1000, 0x2000, UC_PROT_READ, fileno(f), 0));
+    uc_assert_success(uc_mem_read(uc, 0x1000, buf, 4));
+    assert_memory_equal(buf, "file", 4);
+
+    // past the end of the file reads as zeroes
+    uc_assert_success(uc_mem_read(uc, 0x2000, buf, 4));
+    assert_memory_equal(buf, "\0\0\0\0", 4);
+
+    // writes stay private to the engine
+    uc_assert_success(uc_mem_write(uc, 0x1000, "copy", 4));
+    uc_assert_success(uc_mem_read(uc, 0x1000, buf, 4));
+    assert_memory_equal(buf, "copy", 4);
+    rewind(f);
+    assert_int_equal(4, fread(buf, 1, 4, f));
+    assert_memory_equal(buf, "file", 4);
+
+    assert_int_equal(UC_ERR_ARG, uc_mem_map_file(uc, 0x4000, 0x1000, UC_PROT_READ, fileno(f), 0x10));
+    uc_assert_success(uc_mem_unmap(uc, 0x1000, 0x2000));
+    fclose(f);
+}
+
+static void fill_page(uc_engine *uc, uint64_t address, void *page, size_t page_size, void *user_data)
+{
+    unsigned *calls = user_data;
+    (*calls)++;
+    // every page starts with its own address
+    memcpy(page, &address, 4);
+}
+
+static void test_mem_reserve(void **state)
+{
+    uc_engine *uc = *state;
+    unsigned calls = 0;
+    // mov eax, [0x40005000]
+    const char code[] = "\xa1\x00\x50\x00\x40";
+    uint32_t eax = 0, val;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_reserve(uc, 0x40000000, 0x40000000, UC_PROT_ALL, fill_page, &calls));
+    assert_int_equal(0, calls);
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+
+    // guest load fills the page without leaving the emulation loop
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(0x40005000, eax);
+    assert_int_equal(1, calls);
+
+    // the provider runs once per page, also for uc_mem_read/uc_mem_write
+    uc_assert_success(uc_mem_read(uc, 0x40005000, &val, 4));
+    assert_int_equal(0x40005000, val);
+    uc_assert_success(uc_mem_write(uc, 0x40009004, "test", 4));
+    uc_assert_success(uc_mem_read(uc, 0x40009000, &val, 4));
+    assert_int_equal(0x40009000, val);
+    assert_int_equal(2, calls);
+
+    assert_int_equal(UC_ERR_ARG, uc_mem_reserve(uc, 0x90000000, 0x1000, UC_PROT_ALL, NULL, NULL));
+    assert_int_equal(UC_ERR_ARG, uc_mem_protect(uc, 0x40000000, 0x1000, UC_PROT_READ));
+    assert_int_equal(UC_ERR_ARG, uc_mem_unmap(uc, 0x40001000, 0x1000));
+    uc_assert_success(uc_mem_protect(uc, 0x40000000, 0x40000000, UC_PROT_READ));
+    uc_assert_success(uc_mem_unmap(uc, 0x40000000, 0x40000000));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_basic),
+        //test(test_bad_read),
+        //test(test_bad_write),
+        test(test_bad_offset),
+        test(test_assertion_fail),
+        test(test_bad_unmap),
+        test(test_rw_across_boundaries),
+        test(test_unmap_double_map),
+        test(test_overlap_unmap_double_map),
+        test(test_strange_map),
+        test(test_query_page_size),
+        test(test_mmio),
+        test(test_map_batch),
+        test(test_map_file),
+        test(test_mem_reserve),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
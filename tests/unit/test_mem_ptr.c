@@ -0,0 +1,80 @@
+/**
+ * Unicorn memory pointer tests
+ *
+ * This tests direct access to guest memory through uc_mem_ptr().
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static uint64_t mmio_read(uc_engine *uc, uint64_t offset, unsigned size, void *user_data)
+{
+    return 0;
+}
+
+static void mmio_write(uc_engine *uc, uint64_t offset, unsigned size, uint64_t value, void *user_data)
+{
+}
+
+static void test_mem_ptr(void **state)
+{
+    uc_engine *uc = *state;
+    uint8_t host[0x1000] = { 0 };
+    uint8_t buf[4];
+    uint8_t *p;
+    void *vp;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x2000, UC_PROT_READ));
+    uc_assert_success(uc_mem_map_ptr(uc, 0x4000, 0x1000, UC_PROT_ALL, host));
+    uc_assert_success(uc_mmio_map(uc, 0x8000, 0x1000, mmio_read, mmio_write, NULL));
+
+    // both directions see the same bytes, whatever the permissions
+    uc_assert_success(uc_mem_write(uc, 0x1ffe, "test", 4));
+    uc_assert_success(uc_mem_ptr(uc, 0x1ffe, 4, &vp));
+    p = vp;
+    assert_memory_equal(p, "test", 4);
+    memcpy(p, "view", 4);
+    uc_assert_success(uc_mem_read(uc, 0x1ffe, buf, 4));
+    assert_memory_equal(buf, "view", 4);
+
+    uc_assert_success(uc_mem_ptr(uc, 0x4010, 0x10, &vp));
+    assert_ptr_equal(host + 0x10, vp);
+
+    // one host block only: no region crossing, no MMIO
+    assert_int_equal(UC_ERR_ARG, uc_mem_ptr(uc, 0x2ffe, 0x2000, &vp));
+    assert_int_equal(UC_ERR_ARG, uc_mem_ptr(uc, 0x8000, 4, &vp));
+    assert_int_equal(UC_ERR_READ_UNMAPPED, uc_mem_ptr(uc, 0x6000, 4, &vp));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_mem_ptr),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
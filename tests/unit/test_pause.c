@@ -0,0 +1,94 @@
+/**
+ * Unicorn pause/resume tests
+ *
+ * This tests pausing emulation from a callback and resuming it.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+struct pause_state {
+    int calls;
+    bool paused;
+};
+
+static void hook_intr_pause(uc_engine *uc, uint32_t intno, void *user_data)
+{
+    struct pause_state *p = user_data;
+
+    if (++p->calls % 10 == 0) {
+        uc_assert_success(uc_emu_pause(uc));
+        p->paused = true;
+    }
+}
+
+static void test_pause_resume(void **state)
+{
+    uc_engine *uc = *state;
+    // L: int 0x80; inc eax; dec ecx; jnz L
+    const char code[] = "\xcd\x80\x40\x49\x75\xfa";
+    struct pause_state p = { 0, false };
+    uint32_t eax = 0, ecx = 100;
+    int resumes = 0;
+    uc_hook hh;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_INTR, hook_intr_pause, &p, 1, 0));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+
+    // nothing to pause or resume outside of emulation
+    uc_assert_err(UC_ERR_ARG, uc_emu_pause(uc));
+    uc_assert_err(UC_ERR_ARG, uc_emu_resume(uc));
+
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    while (p.paused) {
+        p.paused = false;
+        uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+        assert_int_equal(p.calls - 1, eax);
+        resumes++;
+        uc_assert_success(uc_emu_resume(uc));
+    }
+
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_ECX, &ecx));
+    assert_int_equal(10, resumes);
+    assert_int_equal(100, p.calls);
+    assert_int_equal(100, eax);
+    assert_int_equal(0, ecx);
+    uc_assert_err(UC_ERR_ARG, uc_emu_resume(uc));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_pause_resume),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,106 @@
+/**
+ * Unicorn perf map tests
+ *
+ * This tests the symbols UC_OPT_PERF_MAP and UC_OPT_JITDUMP write for
+ * translated blocks.
+ */
+#include "unicorn_test.h"
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+
+// run "inc eax" at @address in an engine of its own
+static void run_named(uint64_t address)
+{
+    uc_open_opts opts = { 0, 0, UC_OPT_PERF_MAP | UC_OPT_JITDUMP };
+    uc_engine *uc;
+
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc));
+    uc_assert_success(uc_mem_map(uc, address, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, address, "\x40", 1));
+    uc_assert_success(uc_emu_start(uc, address, address + 1, 0, 0));
+    uc_assert_success(uc_close(uc));
+}
+
+static void test_perf_map(void **state)
+{
+    char path[64], line[128], name[64];
+    uintptr_t start;
+    size_t size;
+    int found = 0;
+    FILE *f;
+
+    // the second engine opens the map again after the first closed it
+    run_named(0x1000);
+    run_named(0x2000);
+
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", (int)getpid());
+    f = fopen(path, "r");
+    assert_non_null(f);
+    while (fgets(line, sizeof(line), f)) {
+        assert_int_equal(3, sscanf(line, "%" SCNxPTR " %zx %63s", &start, &size, name));
+        assert_true(size > 0);
+        if (!strcmp(name, "guest:x86_64:0x1000"))
+            found |= 1;
+        if (!strcmp(name, "guest:x86_64:0x2000"))
+            found |= 2;
+    }
+    fclose(f);
+    assert_int_equal(3, found);
+}
+
+static void test_jitdump(void **state)
+{
+    char path[PATH_MAX], *dir = getenv("JITDUMPDIR");
+    uint32_t header[4], rec[2];
+    char name[64];
+    long offset;
+    int found = 0;
+    FILE *f;
+
+    run_named(0x1000);
+    run_named(0x2000);
+
+    snprintf(path, sizeof(path), "%s/jit-%d.dump", dir ? dir : "/tmp", (int)getpid());
+    f = fopen(path, "rb");
+    assert_non_null(f);
+    // magic, version, total_size, elf_mach
+    assert_int_equal(1, fread(header, sizeof(header), 1, f));
+    assert_int_equal(0x4A695444, header[0]);
+
+    // only JIT_CODE_LOAD records follow: the header was written once
+    for (offset = header[2]; fseek(f, offset, SEEK_SET) == 0 &&
+            fread(rec, sizeof(rec), 1, f) == 1; offset += rec[1]) {
+        assert_int_equal(0, rec[0]);
+        // the name follows the 56-byte record
+        assert_int_equal(0, fseek(f, offset + 56, SEEK_SET));
+        assert_non_null(fgets(name, sizeof(name), f));
+        if (!strcmp(name, "guest:x86_64:0x1000"))
+            found |= 1;
+        if (!strcmp(name, "guest:x86_64:0x2000"))
+            found |= 2;
+    }
+    fclose(f);
+    assert_int_equal(3, found);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_perf_map),
+        cmocka_unit_test(test_jitdump),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
+
+#else
+
+// both outputs are only written on Linux
+int main(void) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Unicorn profiler tests
+ *
+ * This tests sampling guest addresses with uc_profile_start().
+ */
+#include "unicorn_test.h"
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static void test_profile(void **state)
+{
+    uc_engine *uc = *state;
+    // L: dec ecx; jnz L
+    const char code[] = "\x49\x75\xfd";
+    uint32_t ecx = 200000000;
+    uc_profile_entry *entries;
+    size_t count;
+
+    uc_assert_err(UC_ERR_ARG, uc_profile_start(uc, 0));
+    uc_assert_success(uc_profile_start(uc, 100));
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_profile_stop(uc));
+
+    // nearly all samples land in the loop, on one of its two instructions
+    uc_assert_success(uc_profile_read(uc, &entries, &count));
+    assert_true(count > 0);
+    assert_true(entries[0].address == 0x1000 || entries[0].address == 0x1001);
+    assert_true(entries[0].samples > 0);
+    uc_free(entries);
+}
+
+static volatile sig_atomic_t host_signals;
+
+static void host_sigprof(int sig)
+{
+    host_signals++;
+}
+
+static void test_profile_host_handler(void **state)
+{
+    uc_engine *uc = *state;
+    struct sigaction sa, old;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = host_sigprof;
+    sigemptyset(&sa.sa_mask);
+    assert_int_equal(0, sigaction(SIGPROF, &sa, &old));
+    host_signals = 0;
+
+    // signals the engine did not send still reach the host's handler
+    uc_assert_success(uc_profile_start(uc, 100));
+    raise(SIGPROF);
+    assert_int_equal(1, host_signals);
+
+    // and it is back in place once profiling stops
+    uc_assert_success(uc_profile_stop(uc));
+    assert_int_equal(0, sigaction(SIGPROF, &old, &sa));
+    assert_ptr_equal(host_sigprof, sa.sa_handler);
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_profile),
+        test(test_profile_host_handler),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
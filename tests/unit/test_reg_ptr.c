@@ -0,0 +1,93 @@
+/**
+ * Unicorn register pointer tests
+ *
+ * This tests direct access to register storage through uc_reg_ptr().
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static void hook_code_reg_ptr(uc_engine *uc, uint64_t addr, uint32_t size, void *user_data)
+{
+    uint32_t **regs = user_data;
+    uint32_t eip, eax;
+
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EIP, &eip));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(addr, eip);
+    assert_int_equal(eip, *regs[1]);
+    assert_int_equal(eax, *regs[0]);
+    // double EAX before each instruction
+    *regs[0] *= 2;
+}
+
+static void test_reg_ptr(void **state)
+{
+    uc_engine *uc = *state;
+    // inc eax; inc eax
+    const char code[] = "\x40\x40";
+    uint32_t *regs[2], eax = 1;
+    size_t size;
+    void *p;
+    uc_hook hh;
+
+    uc_assert_success(uc_reg_ptr(uc, UC_X86_REG_EAX, &p, &size));
+    assert_int_equal(4, size);
+    regs[0] = p;
+    uc_assert_success(uc_reg_ptr(uc, UC_X86_REG_EIP, &p, &size));
+    regs[1] = p;
+
+    // special registers and other modes go through uc_reg_read()
+    uc_assert_err(UC_ERR_ARG, uc_reg_ptr(uc, UC_X86_REG_EFLAGS, &p, &size));
+    uc_assert_err(UC_ERR_ARG, uc_reg_ptr(uc, UC_X86_REG_RAX, &p, &size));
+    uc_assert_err(UC_ERR_ARG, uc_reg_ptr(uc, UC_X86_REG_XMM0, &p, &size));
+
+    *regs[0] = 5;
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(5, eax);
+    eax = 1;
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(1, *regs[0]);
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_CODE, hook_code_reg_ptr, regs, 1, 0));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+
+    // ((1 * 2 + 1) * 2) + 1
+    assert_int_equal(7, *regs[0]);
+    assert_int_equal(0x1002, *regs[1]);
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_reg_ptr),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,104 @@
+/**
+ * Unicorn guest thread scheduler tests
+ *
+ * This tests running several guest threads interleaved on one engine.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+struct sched_state {
+    uint32_t last;
+    int switches;
+};
+
+static void hook_block_sched(uc_engine *uc, uint64_t addr, uint32_t size, void *user_data)
+{
+    struct sched_state *s = user_data;
+    uint32_t id;
+
+    uc_assert_success(uc_thread_current(uc, &id));
+    if (id != s->last) {
+        s->switches++;
+        s->last = id;
+    }
+}
+
+static void test_sched(void **state)
+{
+    uc_engine *uc = *state;
+    // L: inc eax; dec ecx; jnz L; mov [ebx], eax
+    const char code[] = "\x40\x49\x75\xfc\x89\x03";
+    struct sched_state s = { 0, 0 };
+    uint32_t eax = 0, ecx, ebx, eip = 0x1000, id, result[2];
+    uc_context *context;
+    uc_hook hh;
+    int i;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x2000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_context_alloc(uc, &context));
+
+    // two threads running the same code with their own registers
+    for (i = 0; i < 2; i++) {
+        ecx = 1000 / (i + 1);
+        ebx = 0x2000 + i * 4;
+        uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+        uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+        uc_assert_success(uc_reg_write(uc, UC_X86_REG_EBX, &ebx));
+        uc_assert_success(uc_reg_write(uc, UC_X86_REG_EIP, &eip));
+        uc_assert_success(uc_context_save(uc, context));
+        uc_assert_success(uc_thread_add(uc, context, &id));
+        assert_int_equal(i, id);
+    }
+    uc_free(context);
+
+    uc_assert_err(UC_ERR_ARG, uc_thread_current(uc, &id));
+    uc_assert_err(UC_ERR_ARG, uc_sched_start(uc, 0x1000 + sizeof(code) - 1, 0, 0));
+
+    uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_BLOCK, hook_block_sched, &s, 1, 0));
+    uc_assert_success(uc_sched_start(uc, 0x1000 + sizeof(code) - 1, 30, 0));
+
+    uc_assert_success(uc_mem_read(uc, 0x2000, result, sizeof(result)));
+    assert_int_equal(1000, result[0]);
+    assert_int_equal(500, result[1]);
+    // 30 instructions are 10 iterations: both threads ran interleaved
+    assert_true(s.switches > 50);
+
+    // all threads have finished
+    uc_assert_err(UC_ERR_ARG, uc_thread_remove(uc, 0));
+    uc_assert_err(UC_ERR_ARG, uc_sched_start(uc, 0x1000 + sizeof(code) - 1, 30, 0));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_sched),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,51 @@
+/**
+ * Unicorn self-modifying code tests
+ *
+ * This tests that stores into translated code are seen when it runs again.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t run_smc(const char *code, size_t len, uint32_t ecx)
+{
+    uint32_t eax = 0;
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, len));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + len, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_close(uc));
+
+    return eax;
+}
+
+static void test_smc(void **state)
+{
+    // mov byte ptr [0x1008], 7; mov eax, 1
+    const char ahead[] = "\xc6\x05\x08\x10\x00\x00\x07\xb8\x01\x00\x00\x00";
+    // L: mov eax, 1; mov byte ptr [0x1001], 5; dec ecx; jnz L
+    const char behind[] = "\xb8\x01\x00\x00\x00\xc6\x05\x01\x10\x00\x00\x05\x49\x75\xf1";
+    // L: mov [0x1800], ecx; add eax, [0x1800]; dec ecx; jnz L
+    const char data[] = "\x89\x0d\x00\x18\x00\x00\x03\x05\x00\x18\x00\x00\x49\x75\xf1";
+
+    // a store into the rest of the running block is seen
+    assert_int_equal(7, run_smc(ahead, sizeof(ahead) - 1, 0));
+
+    // a store into code that already ran is seen on the next pass
+    assert_int_equal(1, run_smc(behind, sizeof(behind) - 1, 1));
+    assert_int_equal(5, run_smc(behind, sizeof(behind) - 1, 2));
+
+    // data next to code on the same page
+    assert_int_equal(1000 * 1001 / 2, run_smc(data, sizeof(data) - 1, 1000));
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_smc),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
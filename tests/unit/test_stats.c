@@ -0,0 +1,78 @@
+/**
+ * Unicorn statistics tests
+ *
+ * This tests the engine counters read by uc_stats_read().
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static void hook_code_count(uc_engine *uc, uint64_t addr, uint32_t size, void *user_data)
+{
+    (*(uint64_t *)user_data)++;
+}
+
+static void test_stats(void **state)
+{
+    uc_engine *uc = *state;
+    // L: dec ecx; jnz L
+    const char code[] = "\x49\x75\xfd";
+    uint32_t ecx = 10;
+    uint64_t insns = 0;
+    uc_stats stats;
+    uc_hook hh;
+
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_CODE, hook_code_count, &insns, 1, 0));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    // deleting a hook drops the translated code
+    uc_assert_success(uc_hook_del(uc, hh));
+
+    uc_assert_success(uc_stats_read(uc, &stats, sizeof(stats)));
+    assert_int_equal(20, insns);
+    assert_int_equal(insns, stats.hook_calls[2]);   // UC_HOOK_CODE
+    assert_true(stats.tb_translated > 0);
+    assert_true(stats.tb_code_bytes > 0);
+    assert_true(stats.tb_lookups >= stats.tb_lookup_misses);
+    assert_true(stats.tb_flushes > 0);
+
+    uc_assert_success(uc_stats_reset(uc));
+    uc_assert_success(uc_stats_read(uc, &stats, sizeof(stats)));
+    assert_int_equal(0, stats.tb_translated);
+    assert_int_equal(0, stats.hook_calls[2]);
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_stats),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,67 @@
+/**
+ * Unicorn translation cache tests
+ *
+ * This tests saving translated blocks to a file and installing them
+ * in later engines.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static void run_blocks(const uc_open_opts *opts, const char *code, size_t len,
+        size_t *hits, size_t *misses)
+{
+    uc_engine *uc;
+    uint32_t eax = 0;
+
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, opts, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, len));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + len, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(len / 3, eax);
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_HITS, hits));
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_MISSES, misses));
+    uc_assert_success(uc_close(uc));
+}
+
+static void test_tb_cache(void **state)
+{
+    const char *path = "test_tb_cache.tbcache";
+    uc_open_opts opts = { 0, 0, 0, path };
+    // 100 blocks of "inc eax; jmp $+2"
+    char code[100 * 3];
+    size_t hits, misses;
+    int i;
+
+    for (i = 0; i < 100; i++)
+        memcpy(code + i * 3, "\x40\xeb\x00", 3);
+    remove(path);
+
+    run_blocks(&opts, code, sizeof(code), &hits, &misses);
+    assert_int_equal(0, hits);
+
+#if defined(__x86_64__) || defined(_M_X64)
+    // a new engine installs the saved blocks instead of translating them,
+    // except the last one, which ends at the uc_emu_start() end address
+    run_blocks(&opts, code, sizeof(code), &hits, &misses);
+    assert_int_equal(99, hits);
+    assert_int_equal(1, misses);
+
+    // changed guest code is translated again: "inc eax; nop; nop" merges
+    // the first two blocks
+    memcpy(code, "\x40\x90\x90", 3);
+    run_blocks(&opts, code, sizeof(code), &hits, &misses);
+    assert_int_equal(97, hits);
+    assert_int_equal(2, misses);
+#endif
+    remove(path);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_tb_cache),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
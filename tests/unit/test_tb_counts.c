@@ -0,0 +1,79 @@
+/**
+ * Unicorn block count tests
+ *
+ * This tests the per-block execution counts of UC_OPT_TB_COUNTS.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Called before every test to set up a new instance */
+static int setup(void **state)
+{
+    uc_engine *uc;
+
+    uc_assert_success(uc_open(UC_ARCH_X86, UC_MODE_32, &uc));
+
+    *state = uc;
+    return 0;
+}
+
+/* Called after every test to clean up */
+static int teardown(void **state)
+{
+    uc_engine *uc = *state;
+
+    uc_assert_success(uc_close(uc));
+
+    *state = NULL;
+    return 0;
+}
+
+/******************************************************************************/
+
+static void test_tb_counts(void **state)
+{
+    uc_engine *uc;
+    uc_open_opts opts = { 0, 0, UC_OPT_TB_COUNTS, NULL, 0 };
+    // L: dec ecx; jnz L
+    const char code[] = "\x49\x75\xfd";
+    uint32_t ecx = 10;
+    uc_tb_count *counts;
+    size_t count;
+
+    uc_assert_err(UC_ERR_ARG, uc_tb_counts_read(*state, &counts, &count));
+
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+
+    // counts add up over runs
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+
+    uc_assert_success(uc_tb_counts_read(uc, &counts, &count));
+    assert_int_equal(1, count);
+    assert_int_equal(0x1000, counts[0].address);
+    assert_int_equal(3, counts[0].size);
+    assert_int_equal(20, counts[0].count);
+    assert_true(counts[0].host_size > 0);
+    uc_free(counts);
+
+    uc_assert_success(uc_tb_counts_reset(uc));
+    uc_assert_success(uc_tb_counts_read(uc, &counts, &count));
+    assert_int_equal(0, count);
+    uc_free(counts);
+
+    uc_assert_success(uc_close(uc));
+}
+
+int main(void) {
+#define test(x)     cmocka_unit_test_setup_teardown(x, setup, teardown)
+    const struct CMUnitTest tests[] = {
+        test(test_tb_counts),
+    };
+#undef test
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,74 @@
+/**
+ * Unicorn tiered translation tests
+ *
+ * This tests retranslating hot loops as superblocks.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static void hook_block_count(uc_engine *uc, uint64_t address, uint32_t size, void *user_data)
+{
+    (*(int *)user_data)++;
+}
+
+// run the loop with or without tiers; return the block hook calls or -1
+static int run_loop(uint32_t hot_threshold, bool block_hook, uint32_t *eax, size_t *hot)
+{
+    // L: add eax, ecx; jmp M; M: xor eax, 0x55; dec ecx; jnz L
+    const char code[] = "\x01\xc8\xeb\x00\x83\xf0\x55\x49\x75\xf6";
+    uc_open_opts opts = { 0, 0, 0, NULL, hot_threshold };
+    uint32_t ecx = 1000;
+    int blocks = -1;
+    uc_hook hh;
+    uc_engine *uc;
+
+    *eax = 0;
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code) - 1));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, eax));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_ECX, &ecx));
+    if (block_hook) {
+        blocks = 0;
+        uc_assert_success(uc_hook_add(uc, &hh, UC_HOOK_BLOCK, hook_block_count, &blocks, 1, 0));
+    }
+    uc_assert_success(uc_emu_start(uc, 0x1000, 0x1000 + sizeof(code) - 1, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, eax));
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_HOT, hot));
+    uc_assert_success(uc_close(uc));
+
+    return blocks;
+}
+
+static void test_tiered(void **state)
+{
+    uint32_t expected = 0, eax;
+    size_t hot;
+    int i;
+
+    for (i = 1000; i > 0; i--)
+        expected = (expected + i) ^ 0x55;
+
+    run_loop(0, false, &eax, &hot);
+    assert_int_equal(expected, eax);
+    assert_int_equal(0, hot);
+
+    // the loop turns hot and is retranslated as one superblock
+    run_loop(8, false, &eax, &hot);
+    assert_int_equal(expected, eax);
+    assert_int_equal(1, hot);
+
+    // block hooks still see both basic blocks of every iteration
+    assert_int_equal(2000, run_loop(0, true, &eax, &hot));
+    assert_int_equal(2000, run_loop(8, true, &eax, &hot));
+    assert_int_equal(expected, eax);
+    assert_int_equal(2, hot);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_tiered),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
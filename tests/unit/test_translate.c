@@ -0,0 +1,78 @@
+/**
+ * Unicorn translation API tests
+ *
+ * This tests translating code ahead of emulation.
+ */
+#include "unicorn_test.h"
+#include <stdio.h>
+#include <string.h>
+
+static void test_translate_range(void **state)
+{
+    // the TB cache counts a miss for every block translated
+    const char *path = "test_translate.tbcache";
+    uc_open_opts opts = { 0, 0, 0, path };
+    uint64_t entries[] = { 0x1000, 0x1000 + 50 * 3 };
+    uint64_t end = 0x1000 + 100 * 3;
+    // 100 blocks of "inc eax; jmp $+2"
+    char code[100 * 3];
+    size_t misses, before;
+    uint32_t eax = 0;
+    uc_engine *uc;
+    int i;
+
+    for (i = 0; i < 100; i++)
+        memcpy(code + i * 3, "\x40\xeb\x00", 3);
+    remove(path);
+
+    uc_assert_success(uc_open_with(UC_ARCH_X86, UC_MODE_32, &opts, &uc));
+    uc_assert_success(uc_mem_map(uc, 0x1000, 0x1000, UC_PROT_ALL));
+    uc_assert_success(uc_mem_write(uc, 0x1000, code, sizeof(code)));
+
+    uc_assert_err(UC_ERR_ARG, uc_translate_range(uc, 0x1000, 0x1000, end));
+    uc_assert_err(UC_ERR_FETCH_UNMAPPED, uc_translate_range(uc, 0x3000, 0x3010, end));
+    uc_assert_success(uc_translate(uc, entries, 2, end));
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_MISSES, &before));
+    uc_assert_success(uc_translate_range(uc, 0x1000, end, end));
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_MISSES, &misses));
+#if defined(__x86_64__) || defined(_M_X64)
+    assert_int_equal(2, before);
+    // the two entry blocks are already translated
+    assert_int_equal(100, misses);
+#endif
+
+    // nothing left to translate on first execution
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_emu_start(uc, 0x1000, end, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(100, eax);
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_MISSES, &before));
+    assert_int_equal(misses, before);
+
+    // nor on the next run
+    eax = 0;
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_emu_start(uc, 0x1000, end, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(100, eax);
+    uc_assert_success(uc_query(uc, UC_QUERY_TB_CACHE_MISSES, &before));
+    assert_int_equal(misses, before);
+
+    // code written in between is translated again: dec eax
+    eax = 0;
+    uc_assert_success(uc_mem_write(uc, 0x1000, "\x48", 1));
+    uc_assert_success(uc_reg_write(uc, UC_X86_REG_EAX, &eax));
+    uc_assert_success(uc_emu_start(uc, 0x1000, end, 0, 0));
+    uc_assert_success(uc_reg_read(uc, UC_X86_REG_EAX, &eax));
+    assert_int_equal(98, eax);
+
+    uc_assert_success(uc_close(uc));
+    remove(path);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_translate_range),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
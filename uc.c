@@ -1,6 +1,10 @@
 /* Unicorn Emulator Engine */
 /* By Nguyen Anh Quynh <aquynh@gmail.com>, 2015 */
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE     // REG_RIP & co. for the profiler
+#endif
+
 #if defined(UNICORN_HAS_OSXKERNEL)
 #include <libkern/libkern.h>
 #else
@@ -12,6 +16,14 @@
 #include <time.h>   // nanosleep
 
 #include <string.h>
+#ifndef _WIN32
+#include <signal.h>
+#ifdef __APPLE__
+#include <sys/ucontext.h>   // <ucontext.h> requires _XOPEN_SOURCE there
+#else
+#include <ucontext.h>
+#endif
+#endif
 
 #include "uc_priv.h"
 
@@ -24,6 +36,8 @@
 
 #include "qemu/include/hw/boards.h"
 #include "qemu/include/qemu/queue.h"
+#include "qemu/include/qemu/perf-map.h"
+#include "qemu/include/qemu/probes.h"
 
 static void free_table(gpointer key, gpointer value, gpointer data)
 {
@@ -138,9 +152,26 @@ bool uc_arch_supported(uc_arch arch)
 
 UNICORN_EXPORT
 uc_err uc_open(uc_arch arch, uc_mode mode, uc_engine **result)
+{
+    return uc_open_with(arch, mode, NULL, result);
+}
+
+
+// translator sizes of the UC_OPT_LOW_MEMORY profile
+#define LOW_MEMORY_TB_CACHE_SIZE (1024 * 1024)
+#define LOW_MEMORY_TB_HASH_BITS 8
+
+UNICORN_EXPORT
+uc_err uc_open_with(uc_arch arch, uc_mode mode, const uc_open_opts *opts,
+        uc_engine **result)
 {
     struct uc_struct *uc;
 
+    if (opts && opts->tb_hash_bits &&
+            (opts->tb_hash_bits < 6 || opts->tb_hash_bits > 20)) {
+        return UC_ERR_ARG;
+    }
+
     if (arch < UC_ARCH_MAX) {
         uc = calloc(1, sizeof(*uc));
         if (!uc) {
@@ -152,6 +183,25 @@ uc_err uc_open(uc_arch arch, uc_mode mode, uc_engine **result)
         uc->arch = arch;
         uc->mode = mode;
 
+        if (opts) {
+            if (opts->flags & UC_OPT_LOW_MEMORY) {
+                uc->tb_cache_size = LOW_MEMORY_TB_CACHE_SIZE;
+                uc->tb_hash_bits = LOW_MEMORY_TB_HASH_BITS;
+            }
+            if (opts->tb_cache_size)
+                uc->tb_cache_size = opts->tb_cache_size;
+            if (opts->tb_hash_bits)
+                uc->tb_hash_bits = opts->tb_hash_bits;
+            if (opts->tb_cache_file)
+                uc->tb_cache_file = g_strdup(opts->tb_cache_file);
+            uc->tb_hot_threshold = opts->hot_threshold;
+            if (opts->flags & UC_OPT_PERF_MAP)
+                uc->perf_map |= PERF_MAP_SYMBOLS;
+            if (opts->flags & UC_OPT_JITDUMP)
+                uc->perf_map |= PERF_MAP_JITDUMP;
+            uc->tb_counts = (opts->flags & UC_OPT_TB_COUNTS) != 0;
+        }
+
         // uc->ram_list = { .blocks = QTAILQ_HEAD_INITIALIZER(ram_list.blocks) };
         uc->ram_list.blocks.tqh_first = NULL;
         uc->ram_list.blocks.tqh_last = &(uc->ram_list.blocks.tqh_first);
@@ -319,6 +369,12 @@ uc_err uc_close(uc_engine *uc)
 
     // Other auxilaries.
     free(uc->l1_map);
+    g_free(uc->tb_cache_file);
+    uc_profile_stop(uc);
+    g_free(uc->prof_ring);
+    g_free(uc->prof_table);
+    if (uc->tb_count_table)
+        g_hash_table_destroy(uc->tb_count_table);
 
     if (uc->bounce.buffer) {
         free(uc->bounce.buffer);
@@ -348,6 +404,11 @@ uc_err uc_close(uc_engine *uc)
 
     free(uc->mapped_blocks);
 
+    for (i = 0; i < uc->thread_count; i++) {
+        free(uc->threads[i]);
+    }
+    free(uc->threads);
+
     // finally, free uc itself.
     memset(uc, 0, sizeof(*uc));
     free(uc);
@@ -392,6 +453,23 @@ uc_err uc_reg_write(uc_engine *uc, int regid, const void *value)
     return uc_reg_write_batch(uc, &regid, (void *const *)&value, 1);
 }
 
+UNICORN_EXPORT
+uc_err uc_reg_ptr(uc_engine *uc, int regid, void **ptr, size_t *size)
+{
+    void *p;
+
+    if (!uc->reg_ptr)
+        return UC_ERR_ARG;
+
+    p = uc->reg_ptr(uc, (unsigned int)regid, size);
+    if (!p)
+        return UC_ERR_ARG;
+
+    *ptr = p;
+
+    return UC_ERR_OK;
+}
+
 // check if a memory area is mapped
 // this is complicated because an area can overlap adjacent blocks
 static bool check_mem_area(uc_engine *uc, uint64_t address, size_t size)
@@ -411,6 +489,27 @@ static bool check_mem_area(uc_engine *uc, uint64_t address, size_t size)
     return (count == size);
 }
 
+// MMIO regions have no backing store to copy, and copying a uc_mem_reserve()
+// region would fill every page, so neither can be split: fail if
+// [address, address+size) covers only part of one.
+// With @whole_ok false, any MMIO region in the range is refused.
+static bool check_mmio_area(uc_engine *uc, uint64_t address, size_t size, bool whole_ok)
+{
+    size_t count = 0, len;
+
+    while(count < size) {
+        MemoryRegion *mr = memory_mapping(uc, address);
+        len = (size_t)MIN(size - count, mr->end - address);
+        if (!mr->ram || mr->page_provider) {
+            if ((!whole_ok && !mr->ram) || address != mr->addr || len != mr->end - mr->addr)
+                return false;
+        }
+        count += len;
+        address += len;
+    }
+
+    return true;
+}
 
 UNICORN_EXPORT
 uc_err uc_mem_read(uc_engine *uc, uint64_t address, void *_bytes, size_t size)
@@ -488,6 +587,28 @@ uc_err uc_mem_write(uc_engine *uc, uint64_t address, const void *_bytes, size_t
         return UC_ERR_WRITE_UNMAPPED;
 }
 
+UNICORN_EXPORT
+uc_err uc_mem_ptr(uc_engine *uc, uint64_t address, size_t size, void **ptr)
+{
+    MemoryRegion *mr;
+
+    if (uc->mem_redirect) {
+        address = uc->mem_redirect(address);
+    }
+
+    mr = memory_mapping(uc, address);
+    if (mr == NULL)
+        return UC_ERR_READ_UNMAPPED;
+
+    if (!mr->ram || mr->page_provider || size > mr->end - address)
+        return UC_ERR_ARG;
+
+    *ptr = (uint8_t *)uc->get_ram_ptr(mr) + (address - mr->addr);
+    uc->host_writes = true;
+
+    return UC_ERR_OK;
+}
+
 #define TIMEOUT_STEP 2    // microseconds
 static void *_timeout_fn(void *arg)
 {
@@ -513,10 +634,220 @@ static void *_timeout_fn(void *arg)
 static void enable_emu_timer(uc_engine *uc, uint64_t timeout)
 {
     uc->timeout = timeout;
+    uc->timeout_start = get_clock();
     qemu_thread_create(uc, &uc->timer, "timeout", _timeout_fn,
             uc, QEMU_THREAD_JOINABLE);
 }
 
+// histogram slot of guest @address for the profiler
+static uc_profile_entry *prof_entry(struct uc_struct *uc, uint64_t address)
+{
+    uc_profile_entry *e;
+    size_t i, mask;
+
+    if (uc->prof_table_used * 2 >= uc->prof_table_size) {
+        // grow, rehashing the addresses seen so far
+        uc_profile_entry *old = uc->prof_table;
+        size_t size = uc->prof_table_size;
+
+        uc->prof_table_size = size ? size * 2 : 256;
+        uc->prof_table = g_new0(uc_profile_entry, uc->prof_table_size);
+        uc->prof_table_used = 0;
+        for (i = 0; i < size; i++) {
+            if (old[i].samples || old[i].helper_samples)
+                *prof_entry(uc, old[i].address) = old[i];
+        }
+        g_free(old);
+    }
+
+    mask = uc->prof_table_size - 1;
+    for (i = (address * 0x9e3779b97f4a7c15ULL) >> 40; ; i++) {
+        e = &uc->prof_table[i & mask];
+        if (!e->samples && !e->helper_samples) {
+            e->address = address;
+            uc->prof_table_used++;
+            return e;
+        }
+        if (e->address == address)
+            return e;
+    }
+}
+
+void uc_prof_drain(struct uc_struct *uc)
+{
+    unsigned head = uc->prof_head;
+    struct uc_prof_sample *s;
+    uint64_t pc;
+
+    while (uc->prof_tail != head) {
+        s = &uc->prof_ring[uc->prof_tail % UC_PROF_RING];
+        if (s->host_pc && uc->prof_resolve(uc, s->host_pc, &pc))
+            prof_entry(uc, pc)->samples++;
+        else
+            prof_entry(uc, s->env_pc)->helper_samples++;
+        uc->prof_tail++;
+    }
+}
+
+#ifndef _WIN32
+// the engine emulating on this thread, for the sampling signal
+static __thread struct uc_struct *prof_uc;
+
+// engines profiling, and the SIGPROF action they replaced while any does
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned prof_users;
+static struct sigaction prof_old;
+
+static uintptr_t prof_host_pc(void *ctx)
+{
+    ucontext_t *uctx = ctx;
+
+#if defined(__linux__) && defined(__x86_64__)
+    return uctx->uc_mcontext.gregs[REG_RIP];
+#elif defined(__linux__) && defined(__i386__)
+    return uctx->uc_mcontext.gregs[REG_EIP];
+#elif defined(__linux__) && defined(__aarch64__)
+    return uctx->uc_mcontext.pc;
+#elif defined(__linux__) && defined(__arm__)
+    return uctx->uc_mcontext.arm_pc;
+#elif defined(__APPLE__) && defined(__x86_64__)
+    return uctx->uc_mcontext->__ss.__rip;
+#elif defined(__APPLE__) && defined(__aarch64__)
+    return uctx->uc_mcontext->__ss.__pc;
+#else
+    return 0;   // samples only see the CPU state
+#endif
+}
+
+// pass a SIGPROF we did not send to the handler installed before ours; the
+// default action (terminating the process) is not taken
+static void prof_chain(int sig, siginfo_t *info, void *ctx)
+{
+    if (prof_old.sa_flags & SA_SIGINFO)
+        prof_old.sa_sigaction(sig, info, ctx);
+    else if (prof_old.sa_handler != SIG_DFL && prof_old.sa_handler != SIG_IGN)
+        prof_old.sa_handler(sig);
+}
+
+// SIGPROF handler: only records the sample, cpu_exec() resolves it later
+static void prof_signal(int sig, siginfo_t *info, void *ctx)
+{
+    struct uc_struct *uc = prof_uc;
+    struct uc_prof_sample *s;
+    unsigned head;
+
+    if (!uc || !atomic_xchg(&uc->prof_sent, 0)) {
+        prof_chain(sig, info, ctx);
+        return;
+    }
+
+    head = uc->prof_head;
+    if (head - uc->prof_tail >= UC_PROF_RING)
+        return;     // full: the CPU has not left translated code since
+
+    s = &uc->prof_ring[head % UC_PROF_RING];
+    s->host_pc = prof_host_pc(ctx);
+    s->env_pc = uc->prof_env_pc(uc);
+    barrier();
+    uc->prof_head = head + 1;
+}
+
+// the first engine to profile installs the handler, the last one to stop
+// puts the host's back
+static void prof_install(void)
+{
+    struct sigaction sa;
+
+    pthread_mutex_lock(&prof_lock);
+    if (prof_users++ == 0) {
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_sigaction = prof_signal;
+        sa.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, &prof_old);
+    }
+    pthread_mutex_unlock(&prof_lock);
+}
+
+static void prof_uninstall(void)
+{
+    pthread_mutex_lock(&prof_lock);
+    if (--prof_users == 0)
+        sigaction(SIGPROF, &prof_old, NULL);
+    pthread_mutex_unlock(&prof_lock);
+}
+
+static void *_prof_fn(void *arg)
+{
+    struct uc_struct *uc = arg;
+
+    for (;;) {
+        usleep(uc->prof_interval);
+        if (uc->prof_done)
+            break;
+        uc->prof_sent = 1;
+        pthread_kill(uc->prof_target.thread, SIGPROF);
+        // have cpu_exec() resolve the sample before the block can go away
+        if (uc->current_cpu)
+            uc->current_cpu->tcg_exit_req = 1;
+    }
+
+    return NULL;
+}
+
+static void prof_begin(uc_engine *uc)
+{
+    uc->prof_done = false;
+    uc->prof_target.thread = pthread_self();
+    prof_uc = uc;
+    qemu_thread_create(uc, &uc->prof_thread, "profiler", _prof_fn,
+            uc, QEMU_THREAD_JOINABLE);
+}
+
+static void prof_end(uc_engine *uc)
+{
+    uc->prof_done = true;
+    qemu_thread_join(&uc->prof_thread);
+    prof_uc = NULL;
+    uc_prof_drain(uc);
+}
+#endif
+
+static guint tb_count_hash(gconstpointer key)
+{
+    uint64_t pc = *(const uint64_t *)key;
+
+    return (guint)(pc ^ (pc >> 32));
+}
+
+static gboolean tb_count_equal(gconstpointer a, gconstpointer b)
+{
+    return *(const uint64_t *)a == *(const uint64_t *)b;
+}
+
+void uc_tb_count_add(struct uc_struct *uc, uint64_t pc, uint32_t size,
+        uint32_t host_size, uint64_t count)
+{
+    uc_tb_count *c;
+
+    if (!uc->tb_count_table) {
+        // keyed by the address field of the value
+        uc->tb_count_table = g_hash_table_new_full(tb_count_hash,
+                tb_count_equal, NULL, g_free);
+    }
+
+    c = g_hash_table_lookup(uc->tb_count_table, &pc);
+    if (!c) {
+        c = g_new0(uc_tb_count, 1);
+        c->address = pc;
+        g_hash_table_insert(uc->tb_count_table, &c->address, c);
+    }
+    // the latest translation of the address
+    c->size = size;
+    c->host_size = host_size;
+    c->count += count;
+}
+
 static void hook_count_cb(struct uc_struct *uc, uint64_t address, uint32_t size, void *user_data)
 {
     // count this instruction. ah ah ah.
@@ -526,9 +857,83 @@ static void hook_count_cb(struct uc_struct *uc, uint64_t address, uint32_t size,
         uc_emu_stop(uc);
 }
 
+// drop translated code when what it was translated for changes; while
+// the CPU runs, once it stops
+static void flush_code(uc_engine *uc)
+{
+    if (uc->current_cpu)
+        uc->tb_stale = true;
+    else
+        uc->tb_flush(uc);
+}
+
+// blocks embed the stop address they were translated for
+static void code_for(uc_engine *uc, uint64_t until)
+{
+    if (until != uc->tb_addr_end) {
+        uc->tb_flush(uc);
+        uc->tb_addr_end = until;
+    }
+}
+
+// run the CPU until emulation stops or is paused, @timeout in nanoseconds
+static uc_err emu_run(uc_engine *uc, uint64_t timeout)
+{
+    uc->invalid_error = UC_ERR_OK;
+    uc->block_full = false;
+    uc->emulation_done = false;
+    uc->pause_request = false;
+    uc->paused = false;
+
+    if (timeout)
+        enable_emu_timer(uc, timeout);
+
+#ifndef _WIN32
+    if (uc->prof_interval)
+        prof_begin(uc);
+#endif
+
+    if (uc->vm_start(uc)) {
+#ifndef _WIN32
+        if (uc->prof_interval)
+            prof_end(uc);
+#endif
+        return UC_ERR_RESOURCE;
+    }
+
+    // emulation is done
+    uc->emulation_done = true;
+
+    if (timeout) {
+        // wait for the timer to finish
+        qemu_thread_join(&uc->timer);
+    }
+
+#ifndef _WIN32
+    if (uc->prof_interval)
+        prof_end(uc);
+#endif
+
+    // an error ends the emulation for good
+    if (uc->pause_request && !uc->invalid_error) {
+        uc->paused = true;
+        if (timeout) {
+            int64_t left = timeout - (get_clock() - uc->timeout_start);
+            uc->timeout = left > 0 ? left : 1;
+        } else {
+            uc->timeout = 0;
+        }
+    }
+
+    return uc->invalid_error;
+}
+
 UNICORN_EXPORT
 uc_err uc_emu_start(uc_engine* uc, uint64_t begin, uint64_t until, uint64_t timeout, size_t count)
 {
+    // a paused emulation is abandoned
+    uc->paused = false;
+
     // reset the counter
     uc->emu_counter = 0;
     uc->invalid_error = UC_ERR_OK;
@@ -614,24 +1019,13 @@ uc_err uc_emu_start(uc_engine* uc, uint64_t begin, uint64_t until, uint64_t time
         }
     }
 
+    // the host may have rewritten code behind uc_mem_write()'s back
+    if (uc->host_writes)
+        uc->tb_flush(uc);
+    code_for(uc, until);
     uc->addr_end = until;
 
-    if (timeout)
-        enable_emu_timer(uc, timeout * 1000);   // microseconds -> nanoseconds
-
-    if (uc->vm_start(uc)) {
-        return UC_ERR_RESOURCE;
-    }
-
-    // emulation is done
-    uc->emulation_done = true;
-
-    if (timeout) {
-        // wait for the timer to finish
-        qemu_thread_join(&uc->timer);
-    }
-
-    return uc->invalid_error;
+    return emu_run(uc, timeout * 1000);     // microseconds -> nanoseconds
 }
 
 
@@ -651,6 +1045,76 @@ uc_err uc_emu_stop(uc_engine *uc)
     return UC_ERR_OK;
 }
 
+UNICORN_EXPORT
+uc_err uc_emu_pause(uc_engine *uc)
+{
+    // only from a hook, while the CPU runs, and not under the scheduler
+    if (uc->emulation_done || !uc->current_cpu || uc->sched_quantum)
+        return UC_ERR_ARG;
+
+    uc->pause_request = true;
+
+    return uc_emu_stop(uc);
+}
+
+UNICORN_EXPORT
+uc_err uc_emu_resume(uc_engine *uc)
+{
+    if (!uc->paused || uc->current_cpu)
+        return UC_ERR_ARG;
+
+    uc->stop_request = false;
+    // uc_translate_range() may have translated for another stop address
+    code_for(uc, uc->addr_end);
+
+    return emu_run(uc, uc->timeout);
+}
+
+static uc_err translate_range(uc_engine *uc, uint64_t begin, uint64_t end, uint64_t until)
+{
+    uint64_t addr_end = uc->addr_end;
+    uc_err err;
+
+    if (!check_mem_area(uc, begin, (size_t)(end - begin)))
+        return UC_ERR_FETCH_UNMAPPED;
+
+    code_for(uc, until);
+    uc->addr_end = until;
+    err = uc->translate_range(uc, begin, end);
+    uc->addr_end = addr_end;
+
+    return err;
+}
+
+UNICORN_EXPORT
+uc_err uc_translate_range(uc_engine *uc, uint64_t begin, uint64_t end, uint64_t until)
+{
+    // not from inside a callback: translation reuses the CPU's jump buffer
+    if (uc->current_cpu || begin >= end)
+        return UC_ERR_ARG;
+
+    return translate_range(uc, begin, end, until);
+}
+
+UNICORN_EXPORT
+uc_err uc_translate(uc_engine *uc, const uint64_t *entries, size_t count, uint64_t until)
+{
+    size_t i;
+    uc_err err;
+
+    if (uc->current_cpu || (count && entries == NULL))
+        return UC_ERR_ARG;
+
+    for (i = 0; i < count; i++) {
+        // the single block starting at each entry point
+        err = translate_range(uc, entries[i], entries[i] + 1, until);
+        if (err)
+            return err;
+    }
+
+    return UC_ERR_OK;
+}
+
 // find if a memory range overlaps with existing mapped regions
 static bool memory_overlap(struct uc_struct *uc, uint64_t begin, size_t size)
 {
@@ -694,6 +1158,7 @@ static uc_err mem_map(uc_engine *uc, uint64_t address, size_t size, uint32_t per
 
     uc->mapped_blocks[uc->mapped_block_count] = block;
     uc->mapped_block_count++;
+    UC_PROBE3(mem_map, address, size, perms);
 
     return UC_ERR_OK;
 }
@@ -760,25 +1225,110 @@ uc_err uc_mem_map_ptr(uc_engine *uc, uint64_t address, size_t size, uint32_t per
     if (res)
         return res;
 
-    return mem_map(uc, address, size, UC_PROT_ALL, uc->memory_map_ptr(uc, address, size, perms, ptr));
+    res = mem_map(uc, address, size, UC_PROT_ALL, uc->memory_map_ptr(uc, address, size, perms, ptr));
+    if (res == UC_ERR_OK)
+        uc->host_writes = true;
+
+    return res;
+}
+
+UNICORN_EXPORT
+uc_err uc_mem_map_file(uc_engine *uc, uint64_t address, size_t size, uint32_t perms, int fd, uint64_t offset)
+{
+    uc_err res;
+
+    if (fd < 0)
+        return UC_ERR_ARG;
+
+    // file offset must be aligned to uc->target_page_size, and to what the
+    // host can map a file at (its page size, 64KB on Windows)
+    if ((offset & uc->target_page_align) != 0 ||
+            (offset & (qemu_file_ram_align() - 1)) != 0)
+        return UC_ERR_ARG;
+
+    if (uc->mem_redirect) {
+        address = uc->mem_redirect(address);
+    }
+
+    res = mem_map_check(uc, address, size, perms);
+    if (res)
+        return res;
+
+    return mem_map(uc, address, size, perms, uc->memory_map_file(uc, address, size, perms, fd, offset));
+}
+
+UNICORN_EXPORT
+uc_err uc_mem_reserve(uc_engine *uc, uint64_t address, size_t size, uint32_t perms,
+        uc_cb_page_provider_t provider, void *user_data)
+{
+    uc_err res;
+
+    if (provider == NULL)
+        return UC_ERR_ARG;
+
+    if (uc->mem_redirect) {
+        address = uc->mem_redirect(address);
+    }
+
+    res = mem_map_check(uc, address, size, perms);
+    if (res)
+        return res;
+
+    return mem_map(uc, address, size, perms, uc->memory_map_lazy(uc, address, size, perms, provider, user_data));
+}
+
+UNICORN_EXPORT
+uc_err uc_mmio_map(uc_engine *uc, uint64_t address, size_t size,
+        uc_cb_mmio_read_t read_cb, uc_cb_mmio_write_t write_cb, void *user_data)
+{
+    uc_err res;
+    uint32_t perms = 0;
+
+    if (read_cb == NULL && write_cb == NULL)
+        return UC_ERR_ARG;
+
+    if (uc->mem_redirect) {
+        address = uc->mem_redirect(address);
+    }
+
+    if (read_cb)
+        perms |= UC_PROT_READ;
+    if (write_cb)
+        perms |= UC_PROT_WRITE;
+
+    res = mem_map_check(uc, address, size, perms);
+    if (res)
+        return res;
+
+    return mem_map(uc, address, size, perms,
+            uc->memory_map_io(uc, address, size, read_cb, write_cb, user_data));
 }
 
 // Create a backup copy of the indicated MemoryRegion.
 // Generally used in prepartion for splitting a MemoryRegion.
+// This reads the RAM block directly rather than through the address space,
+// which may not be rebuilt yet inside uc_mem_map_batch().
 static uint8_t *copy_region(struct uc_struct *uc, MemoryRegion *mr)
 {
-    uint8_t *block = (uint8_t *)g_malloc0((size_t)int128_get64(mr->size));
-    if (block != NULL) {
-        uc_err err = uc_mem_read(uc, mr->addr, block, (size_t)int128_get64(mr->size));
-        if (err != UC_ERR_OK) {
-            free(block);
-            block = NULL;
-        }
-    }
+    size_t size = (size_t)int128_get64(mr->size);
+    uint8_t *block = (uint8_t *)g_malloc0(size);
+    if (block != NULL)
+        memcpy(block, uc->get_ram_ptr(mr), size);
 
     return block;
 }
 
+// Map [address, address+size) with @perms and fill it from @data.
+static bool remap_region(struct uc_struct *uc, uint64_t address, size_t size,
+        uint32_t perms, const uint8_t *data)
+{
+    if (uc_mem_map(uc, address, size, perms) != UC_ERR_OK)
+        return false;
+
+    memcpy(uc->get_ram_ptr(memory_mapping(uc, address)), data, size);
+    return true;
+}
+
 /*
    Split the given MemoryRegion at the indicated address for the indicated size
    this may result in the create of up to 3 spanning sections. If the delete
@@ -853,23 +1403,17 @@ static bool split_region(struct uc_struct *uc, MemoryRegion *mr, uint64_t addres
     // allocation just failed so no guarantee that we can recover the original
     // allocation at this point
     if (l_size > 0) {
-        if (uc_mem_map(uc, begin, l_size, perms) != UC_ERR_OK)
-            goto error;
-        if (uc_mem_write(uc, begin, backup, l_size) != UC_ERR_OK)
+        if (!remap_region(uc, begin, l_size, perms, backup))
             goto error;
     }
 
     if (m_size > 0 && !do_delete) {
-        if (uc_mem_map(uc, address, m_size, perms) != UC_ERR_OK)
-            goto error;
-        if (uc_mem_write(uc, address, backup + l_size, m_size) != UC_ERR_OK)
+        if (!remap_region(uc, address, m_size, perms, backup + l_size))
             goto error;
     }
 
     if (r_size > 0) {
-        if (uc_mem_map(uc, chunk_end, r_size, perms) != UC_ERR_OK)
-            goto error;
-        if (uc_mem_write(uc, chunk_end, backup + l_size + m_size, r_size) != UC_ERR_OK)
+        if (!remap_region(uc, chunk_end, r_size, perms, backup + l_size + m_size))
             goto error;
     }
 
@@ -913,6 +1457,10 @@ uc_err uc_mem_protect(struct uc_struct *uc, uint64_t address, size_t size, uint3
     if (!check_mem_area(uc, address, size))
         return UC_ERR_NOMEM;
 
+    // MMIO permissions follow its callbacks
+    if (!check_mmio_area(uc, address, size, false))
+        return UC_ERR_ARG;
+
     // Now we know entire region is mapped, so change permissions
     // We may need to split regions if this area spans adjacent regions
     addr = address;
@@ -936,6 +1484,7 @@ uc_err uc_mem_protect(struct uc_struct *uc, uint64_t address, size_t size, uint3
 
     // if EXEC permission is removed, then quit TB and continue at the same place
     if (remove_exec) {
+        flush_code(uc);
         uc->quit_request = true;
         uc_emu_stop(uc);
     }
@@ -970,6 +1519,9 @@ uc_err uc_mem_unmap(struct uc_struct *uc, uint64_t address, size_t size)
     if (!check_mem_area(uc, address, size))
         return UC_ERR_NOMEM;
 
+    if (!check_mmio_area(uc, address, size, true))
+        return UC_ERR_ARG;
+
     // Now we know entire region is mapped, so do the unmap
     // We may need to split regions if this area spans adjacent regions
     addr = address;
@@ -988,10 +1540,56 @@ uc_err uc_mem_unmap(struct uc_struct *uc, uint64_t address, size_t size)
         count += len;
         addr += len;
     }
+    UC_PROBE2(mem_unmap, address, size);
+
+    flush_code(uc);
 
     return UC_ERR_OK;
 }
 
+UNICORN_EXPORT
+uc_err uc_mem_map_batch(uc_engine *uc, const uc_mem_op *ops, size_t count, size_t *done)
+{
+    uc_err err = UC_ERR_OK;
+    size_t i;
+
+    // every map/unmap below only edits the region tree; the address space
+    // is rebuilt and the TLB flushed once when the batch ends
+    uc->memory_batch_begin(uc);
+
+    for (i = 0; i < count; i++) {
+        const uc_mem_op *op = &ops[i];
+
+        switch(op->type) {
+            case UC_MEM_OP_MAP:
+                err = uc_mem_map(uc, op->address, op->size, op->perms);
+                break;
+            case UC_MEM_OP_MAP_PTR:
+                err = uc_mem_map_ptr(uc, op->address, op->size, op->perms, op->ptr);
+                break;
+            case UC_MEM_OP_UNMAP:
+                err = uc_mem_unmap(uc, op->address, op->size);
+                break;
+            case UC_MEM_OP_PROTECT:
+                err = uc_mem_protect(uc, op->address, op->size, op->perms);
+                break;
+            default:
+                err = UC_ERR_ARG;
+                break;
+        }
+
+        if (err != UC_ERR_OK)
+            break;
+    }
+
+    uc->memory_batch_end(uc);
+
+    if (done)
+        *done = i;
+
+    return err;
+}
+
 // find the memory region of this address
 MemoryRegion *memory_mapping(struct uc_struct* uc, uint64_t address)
 {
@@ -1042,6 +1640,9 @@ uc_err uc_hook_add(uc_engine *uc, uc_hook *hh, int type, void *callback,
     hook->refs = 0;
     *hh = (uc_hook)hook;
 
+    // translated code checks for hooks
+    flush_code(uc);
+
     // UC_HOOK_INSN has an extra argument for instruction ID
     if (type & UC_HOOK_INSN) {
         va_list valist;
@@ -1117,6 +1718,7 @@ uc_err uc_hook_del(uc_engine *uc, uc_hook hh)
     // which is less efficient
     // an optimization would be to align the hook pointer
     // and store the type mask in the hook pointer.
+    flush_code(uc);
     for (i = 0; i < UC_HOOK_MAX; i++) {
         if (list_remove(&uc->hook[i], (void *)hook)) {
             if (--hook->refs == 0) {
@@ -1144,12 +1746,40 @@ void helper_uc_tracecode(int32_t size, uc_hook_type type, void *handle, int64_t
     while (cur != NULL && !uc->stop_request) {
         hook = (struct hook *)cur->data;
         if (HOOK_BOUND_CHECK(hook, (uint64_t)address)) {
+            uc->stats.hook_calls[type]++;
             ((uc_cb_hookcode_t)hook->callback)(uc, address, size, hook->user_data);
         }
         cur = cur->next;
     }
 }
 
+// TCG helper: run the interrupt hooks for a trap dispatched in place.
+// Return 0 when no hook handled the trap, else 1. The block ends after
+// the call either way, so a stop or a moved PC takes effect there.
+uint32_t helper_uc_intr(void *handle, uint32_t intno);
+uint32_t helper_uc_intr(void *handle, uint32_t intno)
+{
+    struct uc_struct *uc = handle;
+    struct hook *hook;
+    bool caught = false;
+    HOOK_FOREACH_VAR_DECLARE;
+
+    HOOK_FOREACH(uc, hook, UC_HOOK_INTR) {
+        HOOK_COUNT(uc, UC_HOOK_INTR);
+        ((uc_cb_hookintr_t)hook->callback)(uc, intno, hook->user_data);
+        caught = true;
+    }
+
+    if (!caught) {
+        // same as an unhandled interrupt in cpu_exec()
+        uc->invalid_error = UC_ERR_EXCEPTION;
+        uc_emu_stop(uc);
+        return 0;
+    }
+
+    return 1;
+}
+
 UNICORN_EXPORT
 uint32_t uc_mem_regions(uc_engine *uc, uc_mem_region **regions, uint32_t *count)
 {
@@ -1190,6 +1820,26 @@ uc_err uc_query(uc_engine *uc, uc_query_type type, size_t *result)
         return UC_ERR_OK;
     }
 
+    if (type == UC_QUERY_TB_CACHE_HITS) {
+        *result = (size_t)uc->tb_cache_hits;
+        return UC_ERR_OK;
+    }
+
+    if (type == UC_QUERY_TB_CACHE_MISSES) {
+        *result = (size_t)uc->tb_cache_misses;
+        return UC_ERR_OK;
+    }
+
+    if (type == UC_QUERY_TB_HOT) {
+        *result = (size_t)uc->tb_hot_count;
+        return UC_ERR_OK;
+    }
+
+    if (type == UC_QUERY_MEMORY) {
+        *result = sizeof(*uc) + uc->tcg_exec_memory(uc) + uc->ram_list.used;
+        return UC_ERR_OK;
+    }
+
     switch(uc->arch) {
 #ifdef UNICORN_HAS_ARM
         case UC_ARCH_ARM:
@@ -1202,6 +1852,173 @@ uc_err uc_query(uc_engine *uc, uc_query_type type, size_t *result)
     return UC_ERR_OK;
 }
 
+UNICORN_EXPORT
+uc_err uc_stats_read(uc_engine *uc, uc_stats *stats, size_t size)
+{
+    size_t n = MIN(size, sizeof(uc->stats));
+
+    // callers built against another header pass their own struct size
+    memcpy(stats, &uc->stats, n);
+    memset((char *)stats + n, 0, size - n);
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_stats_reset(uc_engine *uc)
+{
+    memset(&uc->stats, 0, sizeof(uc->stats));
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_profile_start(uc_engine *uc, uint32_t interval_us)
+{
+#ifndef _WIN32
+    if (!interval_us || uc->current_cpu)
+        return UC_ERR_ARG;
+
+    if (!uc->prof_interval)
+        prof_install();
+
+    if (!uc->prof_ring)
+        uc->prof_ring = g_new(struct uc_prof_sample, UC_PROF_RING);
+    uc->prof_head = uc->prof_tail = 0;
+    g_free(uc->prof_table);
+    uc->prof_table = NULL;
+    uc->prof_table_size = uc->prof_table_used = 0;
+    uc->prof_interval = interval_us;
+
+    return UC_ERR_OK;
+#else
+    return UC_ERR_ARG;
+#endif
+}
+
+UNICORN_EXPORT
+uc_err uc_profile_stop(uc_engine *uc)
+{
+    if (uc->current_cpu)
+        return UC_ERR_ARG;
+
+#ifndef _WIN32
+    if (uc->prof_interval)
+        prof_uninstall();
+#endif
+    uc->prof_interval = 0;
+    return UC_ERR_OK;
+}
+
+static int prof_cmp(const void *a, const void *b)
+{
+    const uc_profile_entry *x = a, *y = b;
+    uint64_t nx = x->samples + x->helper_samples;
+    uint64_t ny = y->samples + y->helper_samples;
+
+    if (nx != ny)
+        return nx < ny ? 1 : -1;
+    return x->address < y->address ? -1 : x->address > y->address;
+}
+
+UNICORN_EXPORT
+uc_err uc_profile_read(uc_engine *uc, uc_profile_entry **entries, size_t *count)
+{
+    uc_profile_entry *r;
+    size_t i, n = 0;
+
+    // samples of a paused emulation, whose blocks still exist
+    uc_prof_drain(uc);
+
+    r = g_new(uc_profile_entry, uc->prof_table_used ? uc->prof_table_used : 1);
+    for (i = 0; i < uc->prof_table_size; i++) {
+        if (uc->prof_table[i].samples || uc->prof_table[i].helper_samples)
+            r[n++] = uc->prof_table[i];
+    }
+    qsort(r, n, sizeof(*r), prof_cmp);
+
+    *entries = r;
+    *count = n;
+
+    return UC_ERR_OK;
+}
+
+static void tb_count_copy(gpointer key, gpointer value, gpointer data)
+{
+    uc_tb_count **p = data;
+
+    *(*p)++ = *(uc_tb_count *)value;
+}
+
+static int tb_count_cmp(const void *a, const void *b)
+{
+    const uc_tb_count *x = a, *y = b;
+
+    if (x->count != y->count)
+        return x->count < y->count ? 1 : -1;
+    return x->address < y->address ? -1 : x->address > y->address;
+}
+
+UNICORN_EXPORT
+uc_err uc_tb_counts_read(uc_engine *uc, uc_tb_count **counts, size_t *count)
+{
+    uc_tb_count *r, *p;
+    size_t n;
+
+    if (!uc->tb_counts)
+        return UC_ERR_ARG;
+
+    // blocks still in the cache, from a paused emulation or a hook
+    uc->tb_fold_counts(uc);
+
+    n = uc->tb_count_table ? g_hash_table_size(uc->tb_count_table) : 0;
+    r = p = g_new(uc_tb_count, n ? n : 1);
+    if (n)
+        g_hash_table_foreach(uc->tb_count_table, tb_count_copy, &p);
+    qsort(r, n, sizeof(*r), tb_count_cmp);
+
+    *counts = r;
+    *count = n;
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_tb_counts_reset(uc_engine *uc)
+{
+    if (!uc->tb_counts)
+        return UC_ERR_ARG;
+
+    uc->tb_fold_counts(uc);
+    if (uc->tb_count_table)
+        g_hash_table_remove_all(uc->tb_count_table);
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_profile_dump(uc_engine *uc, const char *path)
+{
+    uc_profile_entry *entries;
+    size_t i, count;
+    FILE *f;
+
+    f = fopen(path, "w");
+    if (!f)
+        return UC_ERR_ARG;
+
+    uc_profile_read(uc, &entries, &count);
+    for (i = 0; i < count; i++) {
+        if (entries[i].samples)
+            fprintf(f, "0x%" PRIx64 " %" PRIu64 "\n",
+                    entries[i].address, entries[i].samples);
+        if (entries[i].helper_samples)
+            fprintf(f, "0x%" PRIx64 ";[helper] %" PRIu64 "\n",
+                    entries[i].address, entries[i].helper_samples);
+    }
+    g_free(entries);
+
+    return fclose(f) ? UC_ERR_ARG : UC_ERR_OK;
+}
+
 static size_t cpu_context_size(uc_arch arch, uc_mode mode)
 {
     // each of these constants is defined by offsetof(CPUXYZState, tlb_table)
@@ -1280,3 +2097,188 @@ uc_err uc_context_restore(uc_engine *uc, uc_context *context)
     memcpy(uc->cpu->env_ptr, _context->data, _context->size);
     return UC_ERR_OK;
 }
+
+// copy the CPU state a guest thread owns from @src to @dst
+static void thread_regs_copy(uc_engine *uc, void *dst, const void *src, size_t size)
+{
+    const struct uc_span *r = uc->thread_regs;
+
+    if (!r) {
+        memcpy(dst, src, size);
+        return;
+    }
+
+    for (; r->size; r++) {
+        memcpy((char *)dst + r->offset, (const char *)src + r->offset, r->size);
+    }
+}
+
+// next thread after the current one that has not finished, round robin
+static bool thread_next(uc_engine *uc, uint32_t *id)
+{
+    uint32_t i, n;
+
+    for (i = 1; i <= uc->thread_count; i++) {
+        n = (uc->thread_current + i) % uc->thread_count;
+        if (uc->threads[n]) {
+            *id = n;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool uc_sched_switch(struct uc_struct *uc)
+{
+    struct uc_context *cur = uc->threads[uc->thread_current];
+    struct uc_context *next;
+    uint32_t id;
+
+    if (uc->sched_exit_request) {
+        uc->sched_exit_request = false;
+        free(cur);
+        uc->threads[uc->thread_current] = cur = NULL;
+    }
+
+    if (!thread_next(uc, &id))
+        return false;
+
+    // a single runnable thread simply gets a new time slice
+    if (id == uc->thread_current)
+        return true;
+
+    next = uc->threads[id];
+    if (cur)
+        thread_regs_copy(uc, cur->data, uc->cpu->env_ptr, cur->size);
+    thread_regs_copy(uc, uc->cpu->env_ptr, next->data, next->size);
+    uc->thread_current = id;
+
+    return true;
+}
+
+UNICORN_EXPORT
+uc_err uc_thread_add(uc_engine *uc, const uc_context *context, uint32_t *id)
+{
+    const struct uc_context *_context = context;
+    struct uc_context *copy;
+
+    if (_context->size != cpu_context_size(uc->arch, uc->mode))
+        return UC_ERR_ARG;
+
+    // grow in powers of two
+    if ((uc->thread_count & (uc->thread_count - 1)) == 0) {
+        struct uc_context **threads = realloc(uc->threads,
+                sizeof(*threads) * (uc->thread_count ? uc->thread_count * 2 : 1));
+        if (!threads)
+            return UC_ERR_NOMEM;
+        uc->threads = threads;
+    }
+
+    copy = malloc(sizeof(*copy) + _context->size);
+    if (!copy)
+        return UC_ERR_NOMEM;
+    memcpy(copy, _context, sizeof(*copy) + _context->size);
+
+    uc->threads[uc->thread_count] = copy;
+    *id = uc->thread_count++;
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_thread_remove(uc_engine *uc, uint32_t id)
+{
+    if (id >= uc->thread_count || !uc->threads[id])
+        return UC_ERR_ARG;
+
+    if (uc->sched_quantum && id == uc->thread_current) {
+        // the running thread goes at the next block boundary
+        uc->sched_exit_request = true;
+        uc->cpu->quantum = 0;
+    } else {
+        free(uc->threads[id]);
+        uc->threads[id] = NULL;
+    }
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_thread_current(uc_engine *uc, uint32_t *id)
+{
+    if (!uc->sched_quantum)
+        return UC_ERR_ARG;
+
+    *id = uc->thread_current;
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_thread_yield(uc_engine *uc)
+{
+    if (!uc->sched_quantum)
+        return UC_ERR_ARG;
+
+    uc->cpu->quantum = 0;
+
+    return UC_ERR_OK;
+}
+
+UNICORN_EXPORT
+uc_err uc_sched_start(uc_engine *uc, uint64_t until, uint32_t quantum, uint64_t timeout)
+{
+    struct uc_context *first;
+    uc_err err;
+
+    if (uc->current_cpu || quantum == 0 || quantum > INT32_MAX || !uc->thread_count)
+        return UC_ERR_ARG;
+
+    // a stopped scheduler goes on with the thread it stopped in
+    if (uc->thread_current >= uc->thread_count || !uc->threads[uc->thread_current]) {
+        if (!thread_next(uc, &uc->thread_current))
+            return UC_ERR_ARG;
+    }
+
+    // blocks translated so far do not count instructions
+    uc->paused = false;
+    uc->tb_flush(uc);
+    uc->tb_addr_end = until;
+
+    // the first thread brings the system state the others share
+    first = uc->threads[uc->thread_current];
+    memcpy(uc->cpu->env_ptr, first->data, first->size);
+
+    uc->emu_counter = 0;
+    uc->emu_count = 0;
+    if (uc->count_hook != 0) {
+        uc_hook_del(uc, uc->count_hook);
+        uc->count_hook = 0;
+    }
+
+    uc->stop_request = false;
+    uc->sched_exit_request = false;
+    uc->sched_quantum = quantum;
+    uc->cpu->quantum = quantum;
+    uc->addr_end = until;
+
+    err = emu_run(uc, timeout * 1000);     // microseconds -> nanoseconds
+
+    // a stopped thread continues from here next time
+    if (uc->threads[uc->thread_current]) {
+        first = uc->threads[uc->thread_current];
+        if (uc->sched_exit_request) {
+            free(first);
+            uc->threads[uc->thread_current] = NULL;
+        } else {
+            memcpy(first->data, uc->cpu->env_ptr, first->size);
+        }
+    }
+    uc->sched_exit_request = false;
+    uc->sched_quantum = 0;
+    // ... and the ones translated here do
+    uc->tb_flush(uc);
+
+    return err;
+}